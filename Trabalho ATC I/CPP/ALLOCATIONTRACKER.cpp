@@ -0,0 +1,49 @@
+#include "allocation_tracker.h"
+
+#ifdef PACMAN_ALLOC_CHECK
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Por thread e sem atmicos: o new s paga um incremento
+    thread_local uint64_t threadAllocations = 0;
+
+    void* allocate(std::size_t size) {
+        threadAllocations++;
+        return std::malloc(size ? size : 1);
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t align) {
+        threadAllocations++;
+        // aligned_alloc exige um tamanho mltiplo do alinhamento
+        const std::size_t alignment = static_cast<std::size_t>(align);
+        const std::size_t rounded = size ? (size + alignment - 1) / alignment * alignment : alignment;
+        return std::aligned_alloc(alignment, rounded);
+    }
+
+    void* orThrow(void* memory) {
+        if (!memory) throw std::bad_alloc();
+        return memory;
+    }
+}
+
+uint64_t AllocationTracker::getThreadAllocations() {
+    return threadAllocations;
+}
+
+void* operator new(std::size_t size) { return orThrow(allocate(size)); }
+void* operator new[](std::size_t size) { return orThrow(allocate(size)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return orThrow(allocateAligned(size, align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return orThrow(allocateAligned(size, align)); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+#endif
@@ -0,0 +1,159 @@
+// Teste da verificao de alocaes do GameLoop (s com -DPACMAN_ALLOC_CHECK).
+// Corre o loop de verdade, com ticks rpidos e o ecr curses num terminal
+// falso (/dev/null), duas vezes:
+//  - em regime (PLAYING com vidas infinitas) o loop no pode lanar;
+//  - com um tick que aloca a meio da partida o loop tem de lanar e a
+//    mensagem tem de indicar o tick.
+//
+// Uso: pacman_alloc_test [--ticks N]
+#ifndef PACMAN_ALLOC_CHECK
+#error "pacman_alloc_test tem de ser compilado com -DPACMAN_ALLOC_CHECK"
+#endif
+
+#include "game.h"
+#include "game_loop.h"
+#include "game_snapshot.h"
+#include "input_thread.h"
+#include "pacman_ui.h"
+#include "allocation_tracker.h"
+#include <curses.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    const int KEYS[] = { KEY_UP, KEY_RIGHT, KEY_DOWN, KEY_LEFT };
+
+    // Primeiro tick: comea a partida com vidas infinitas (vem do MENU, pode
+    // alocar). Depois, uma tecla de 10 em 10 ticks, at parar o loop.
+    class SteadyDriver : public TickDriver {
+    public:
+        SteadyDriver(Game& game, GameLoop& loop, int ticks, int allocateAt)
+            : game(game), loop(loop), ticks(ticks), allocateAt(allocateAt), count(0) {}
+
+        void handleInput(int input) override { game.handleInput(input); }
+
+        void tick() override {
+            count++;
+            if (count == 1) {
+                game.startGame();
+                GameSnapshot endless;
+                game.saveSnapshot(endless);
+                endless.lives = INT16_MAX;
+                game.restoreSnapshot(endless);
+            }
+            else if (count % 10 == 0) {
+                game.handleInput(KEYS[(count / 10) % 4]);
+            }
+            game.updateGameState();
+
+            // Um tick "com bug": o vetor cresce do zero, tem de alocar
+            if (count == allocateAt) {
+                leaked.push_back(count);
+            }
+            if (count >= ticks) loop.stop();
+        }
+
+        int getCount() const { return count; }
+
+    private:
+        Game& game;
+        GameLoop& loop;
+        int ticks;
+        int allocateAt;   // 0 = nunca
+        int count;
+        std::vector<int> leaked;
+    };
+
+    // Corre o loop e devolve a mensagem da exceo ("" se no lanou)
+    std::string runLoop(int ticks, int allocateAt, int& ticksRun) {
+        Game game(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT);
+        game.setSeed(1);
+        // O ecr  criado no primeiro render, ainda no MENU (como no jogo)
+        game.render();
+
+        GameLoopConfig config;
+        config.ticksPerSecond = 1000;
+        config.maxFramesPerSecond = 200;
+        GameLoop loop(game, config);
+        // Fila vazia em vez do getch(): o teste no l o teclado
+        InputThread input;
+        loop.setInputThread(&input);
+        SteadyDriver driver(game, loop, ticks, allocateAt);
+        loop.setDriver(&driver);
+
+        std::string error;
+        try {
+            loop.run();
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        ticksRun = driver.getCount();
+        if (game.getState() != GameState::PLAYING) {
+            throw std::runtime_error("A partida saiu de PLAYING: o teste no verificou o regime");
+        }
+        return error;
+    }
+}
+
+int main(int argc, char** argv) {
+    int ticks = 300;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::atoi(argv[++i]);
+        }
+        else {
+            std::fprintf(stderr, "Opo desconhecida: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (ticks < 20) ticks = 20;
+
+    // Terminal falso: o CursesBackend desenha para /dev/null
+    std::FILE* devNull = std::fopen("/dev/null", "w");
+    SCREEN* terminal = devNull ? newterm("vt100", devNull, stdin) : nullptr;
+    if (!terminal) {
+        std::fprintf(stderr, "Erro: no foi possvel criar o terminal falso\n");
+        return 2;
+    }
+
+    int failures = 0;
+    try {
+        int ticksRun = 0;
+        const std::string steady = runLoop(ticks, 0, ticksRun);
+        if (!steady.empty()) {
+            std::fprintf(stderr, "FALHOU regime: %s\n", steady.c_str());
+            failures++;
+        }
+        else {
+            std::printf("ok regime: %d ticks em PLAYING sem alocaes\n", ticksRun);
+        }
+
+        const int allocateAt = ticks / 2;
+        const std::string caught = runLoop(ticks, allocateAt, ticksRun);
+        const std::string expected = "tick em PLAYING";
+        if (caught.find(expected) == std::string::npos || ticksRun != allocateAt) {
+            std::fprintf(stderr, "FALHOU tick que aloca: esperado \"%s\" no tick %d, obtido \"%s\" no tick %d\n",
+                expected.c_str(), allocateAt, caught.c_str(), ticksRun);
+            failures++;
+        }
+        else {
+            std::printf("ok tick que aloca: %s\n", caught.c_str());
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        failures++;
+    }
+
+    endwin();
+    delscreen(terminal);
+    std::fclose(devNull);
+    return failures == 0 ? 0 : 1;
+}
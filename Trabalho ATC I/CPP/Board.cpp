@@ -1,10 +1,14 @@
 #include "board.h"
+#include "state_hash.h"
+#include "frame_renderer.h"
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
 
-Board::Board(int w, int h)
-    : width(31), height(28), totalPellets(0), remainingPellets(0), fruitActive(false) {
+Board::Board(int /*w*/, int /*h*/)
+    : width(31), height(28), mazeId(0), hash(0), totalPellets(0), remainingPellets(0), fruitActive(false), dirtyCount(-1) {
     squares.resize(height, std::vector<Square>(width));
+    exits.resize(static_cast<size_t>(width) * height, 0);
     ghostSpawns.resize(4); // 4 fantasmas padro
     initializeBoard();
 }
@@ -18,18 +22,23 @@ void Board::initializeBoard() {
     generateMaze();
     configureTunnels();
     updatePelletCount();
+    rehash();
+    rebuildExits();
 
     if (!testTunnels()) {
         throw std::runtime_error("Tunnel system failed to initialize correctly");
     }
 }
 
+void Board::resetBoard() {
+    initializeBoard();
+}
+
 void Board::setSquare(int x, int y, SquareType type) {
     validatePosition(x, y);
-    squares[y][x].type = type;
+    changeType(x, y, type);
     if (type == SquareType::POWER_PELLET) {
         squares[y][x].points = 50;
-        squares[y][x].powerDuration = 15;
     }
     else if (type == SquareType::PELLET) {
         squares[y][x].points = 10;
@@ -40,7 +49,7 @@ void Board::removePellet(int x, int y) {
     validatePosition(x, y);
     if (squares[y][x].type == SquareType::PELLET ||
         squares[y][x].type == SquareType::POWER_PELLET) {
-        squares[y][x].type = SquareType::EMPTY;
+        changeType(x, y, SquareType::EMPTY);
         remainingPellets--;
     }
 }
@@ -88,6 +97,14 @@ bool Board::isCompleted() const {
     return remainingPellets == 0;
 }
 
+uint8_t Board::exitFor(int dx, int dy) {
+    if (dx == 0 && dy == -1) return EXIT_UP;
+    if (dx == 0 && dy == 1) return EXIT_DOWN;
+    if (dx == -1 && dy == 0) return EXIT_LEFT;
+    if (dx == 1 && dy == 0) return EXIT_RIGHT;
+    return 0;
+}
+
 void Board::setTunnel(int x1, int y1, int x2, int y2) {
     validatePosition(x1, y1);
     validatePosition(x2, y2);
@@ -137,6 +154,173 @@ void Board::getSpawnPoint(int& x, int& y, bool isGhost, int ghostIndex) const {
     }
 }
 
+void Board::savePellets(uint8_t* pelletPlane, uint8_t* powerPlane, int planeBytes) const {
+    if (width * height > planeBytes * 8) {
+        throw std::length_error("Board too large for snapshot planes");
+    }
+    std::fill(pelletPlane, pelletPlane + planeBytes, 0);
+    std::fill(powerPlane, powerPlane + planeBytes, 0);
+
+    int index = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++, index++) {
+            const uint8_t bit = static_cast<uint8_t>(1u << (index & 7));
+            if (squares[y][x].type == SquareType::PELLET) {
+                pelletPlane[index >> 3] |= bit;
+            }
+            else if (squares[y][x].type == SquareType::POWER_PELLET) {
+                powerPlane[index >> 3] |= bit;
+            }
+        }
+    }
+}
+
+void Board::draw(FrameRenderer& screen) const {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            drawCell(screen, x, y);
+        }
+    }
+}
+
+void Board::drawCell(FrameRenderer& screen, int x, int y) const {
+    if (!isPositionInBounds(x, y)) return;
+    switch (squares[y][x].type) {
+    case SquareType::WALL:
+        screen.put(x, y, '#', 7);
+        break;
+    case SquareType::PELLET:
+        screen.put(x, y, '.');
+        break;
+    case SquareType::POWER_PELLET:
+        screen.put(x, y, 'O', 0, STYLE_BOLD);
+        break;
+    default:
+        screen.put(x, y, ' ');
+    }
+}
+
+void Board::updatePellets(uint8_t* pelletPlane, uint8_t* powerPlane, int planeBytes) const {
+    if (dirtyCount < 0) {
+        savePellets(pelletPlane, powerPlane, planeBytes);
+        return;
+    }
+    for (int i = 0; i < dirtyCount; i++) {
+        const int index = dirtyCells[i];
+        const SquareType type = squares[index / width][index % width].type;
+        const uint8_t bit = static_cast<uint8_t>(1u << (index & 7));
+        pelletPlane[index >> 3] = static_cast<uint8_t>(
+            (pelletPlane[index >> 3] & ~bit) | (type == SquareType::PELLET ? bit : 0));
+        powerPlane[index >> 3] = static_cast<uint8_t>(
+            (powerPlane[index >> 3] & ~bit) | (type == SquareType::POWER_PELLET ? bit : 0));
+    }
+}
+
+void Board::restorePellets(const uint8_t* pelletPlane, const uint8_t* powerPlane, int planeBytes) {
+    if (width * height > planeBytes * 8) {
+        throw std::length_error("Board too large for snapshot planes");
+    }
+
+    // S casas de pellet ou vazias mudam; paredes, tneis e spawns ficam
+    int index = 0;
+    remainingPellets = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++, index++) {
+            Square& square = squares[y][x];
+            if (square.type != SquareType::PELLET &&
+                square.type != SquareType::POWER_PELLET &&
+                square.type != SquareType::EMPTY) {
+                continue;
+            }
+
+            const uint8_t bit = static_cast<uint8_t>(1u << (index & 7));
+            if (pelletPlane[index >> 3] & bit) {
+                changeType(x, y, SquareType::PELLET);
+                square.points = 10;
+                remainingPellets++;
+            }
+            else if (powerPlane[index >> 3] & bit) {
+                changeType(x, y, SquareType::POWER_PELLET);
+                square.points = 50;
+                remainingPellets++;
+            }
+            else {
+                changeType(x, y, SquareType::EMPTY);
+            }
+        }
+    }
+}
+
+void Board::changeType(int x, int y, SquareType type) {
+    SquareType& current = squares[y][x].type;
+    if (current != type) {
+        hash ^= StateHash::tile(x, y, static_cast<int>(current)) ^
+            StateHash::tile(x, y, static_cast<int>(type));
+        const bool wallChanged = current == SquareType::WALL || type == SquareType::WALL;
+        current = type;
+        markDirty(x, y);
+        if (wallChanged) {
+            updateExits(x, y);
+        }
+    }
+}
+
+void Board::updateExits(int x, int y) {
+    // Uma parede nova ou removida muda as sadas da casa e dos vizinhos
+    static const int NEIGHBOURS[5][2] = { { 0, 0 }, { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } };
+    for (const auto& offset : NEIGHBOURS) {
+        const int cx = x + offset[0];
+        const int cy = y + offset[1];
+        if (isPositionInBounds(cx, cy)) {
+            exits[cy * width + cx] = computeExits(cx, cy);
+        }
+    }
+}
+
+void Board::rebuildExits() {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            exits[y * width + x] = computeExits(x, y);
+        }
+    }
+}
+
+uint8_t Board::computeExits(int x, int y) const {
+    uint8_t mask = 0;
+    if (isPositionInBounds(x, y - 1) && squares[y - 1][x].type != SquareType::WALL) mask |= EXIT_UP;
+    if (isPositionInBounds(x, y + 1) && squares[y + 1][x].type != SquareType::WALL) mask |= EXIT_DOWN;
+    if (isPositionInBounds(x - 1, y) && squares[y][x - 1].type != SquareType::WALL) mask |= EXIT_LEFT;
+    if (isPositionInBounds(x + 1, y) && squares[y][x + 1].type != SquareType::WALL) mask |= EXIT_RIGHT;
+    return mask;
+}
+
+void Board::markDirty(int x, int y) {
+    if (dirtyCount < 0) return;   // J est tudo marcado
+
+    // Insero ordenada: a lista  curta (um pellet por tick, em regra)
+    const uint16_t index = static_cast<uint16_t>(y * width + x);
+    int pos = dirtyCount;
+    while (pos > 0 && dirtyCells[pos - 1] > index) pos--;
+    if (pos > 0 && dirtyCells[pos - 1] == index) return;
+    if (dirtyCount == MAX_DIRTY_CELLS) {
+        dirtyCount = -1;
+        return;
+    }
+    for (int i = dirtyCount; i > pos; i--) dirtyCells[i] = dirtyCells[i - 1];
+    dirtyCells[pos] = index;
+    dirtyCount++;
+}
+
+void Board::rehash() {
+    hash = 0;
+    dirtyCount = -1;   // O tabuleiro foi refeito sem changeType()
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            hash ^= StateHash::tile(x, y, static_cast<int>(squares[y][x].type));
+        }
+    }
+}
+
 void Board::validatePosition(int x, int y) const {
     if (!isPositionInBounds(x, y)) {
         throw std::out_of_range("Position out of bounds");
@@ -174,7 +358,9 @@ void Board::clearBoard() {
 
 void Board::generateMaze() {
     // Define o layout do mapa 28x31
-    const std::string mazeLayout[] = {
+    // Literais, no std::string: resetBoard() corre a meio de uma partida
+    // (vida perdida) e no deve alocar
+    static const char* const mazeLayout[] = {
         "#############################",
         "#            #            #",
         "#.####.#####.#.#####.####.#",
@@ -207,10 +393,12 @@ void Board::generateMaze() {
         "#############################"
     };
 
-    // Preenche o tabuleiro baseado no layout
+    // Preenche o tabuleiro baseado no layout (linhas mais curtas que o
+    // tabuleiro acabam em casas vazias)
     for (int y = 0; y < height; y++) {
+        const int rowLength = static_cast<int>(std::strlen(mazeLayout[y]));
         for (int x = 0; x < width; x++) {
-            switch (mazeLayout[y][x]) {
+            switch (x < rowLength ? mazeLayout[y][x] : ' ') {
             case '#':
                 squares[y][x].type = SquareType::WALL;
                 break;
@@ -221,8 +409,7 @@ void Board::generateMaze() {
             case 'o':
                 squares[y][x].type = SquareType::POWER_PELLET;
                 squares[y][x].points = 50;
-                squares[y][x].powerDuration = 15;
-                break;
+                        break;
             case 'P':
                 setPacmanSpawn(x, y);
                 squares[y][x].type = SquareType::PELLET;
@@ -4,6 +4,8 @@
 #include <ctime>
 #include <vector>
 #include <string>
+#include <chrono>
+#include <thread>
 
 // Constantes de Tela
 static const int SCREEN_WIDTH = 80;
@@ -221,6 +223,7 @@ int main() {
     noecho();             // No mostra teclas pressionadas
     keypad(stdscr, TRUE); // Permite teclas especiais
     curs_set(0);          // Esconde cursor
+    nodelay(stdscr, TRUE);// getch() no bloqueia: o ritmo  dado pelo relgio
     srand(time(NULL));    // Seed para nmeros aleatrios
 
     // Inicializa pares de cores
@@ -242,27 +245,59 @@ int main() {
     Ghost aggressiveGhost(20, 10, &aggressiveStrategy, 'A', 4);
     Ghost randomGhost(60, 10, &randomStrategy, 'R', 5);
 
-    // Loop principal do jogo
-    int ch;
-    while ((ch = getch()) != 'q') {
-        clear();  // Limpa a tela
+    // Loop principal do jogo: passo fixo de 100 ms com acumulador
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration tickStep = std::chrono::milliseconds(100);
+    Clock::time_point previous = Clock::now();
+    Clock::duration accumulator = Clock::duration::zero();
+    int pendingInput = ERR;
+    bool dirty = true;
+    bool quit = false;
+
+    while (!quit) {
+        Clock::time_point now = Clock::now();
+        accumulator += now - previous;
+        previous = now;
+
+        // L todas as teclas disponveis sem bloquear; guarda a ltima
+        int ch;
+        while ((ch = getch()) != ERR) {
+            if (ch == 'q') quit = true;
+            pendingInput = ch;
+        }
 
-        // Move Pac-Man
-        pacman.moveByInput(ch);
+        // No mximo 5 ticks de recuperao por frame
+        int ticks = 0;
+        while (accumulator >= tickStep && ticks < 5) {
+            // Move Pac-Man
+            pacman.moveByInput(pendingInput);
+            pendingInput = ERR;
 
-        // Move fantasmas
-        aggressiveGhost.chase(pacman, board);
-        randomGhost.chase(pacman, board);
+            // Move fantasmas
+            aggressiveGhost.chase(pacman, board);
+            randomGhost.chase(pacman, board);
 
-        // Desenha elementos
-        board.draw();
-        board.drawGameInfo(pacman.score, pacman.lives);
-        pacman.draw();
-        aggressiveGhost.draw();
-        randomGhost.draw();
+            accumulator -= tickStep;
+            ticks++;
+            dirty = true;
+        }
+        if (accumulator >= tickStep) {
+            accumulator %= tickStep;
+        }
+
+        // Desenha elementos s quando houve tick
+        if (dirty) {
+            erase();
+            board.draw();
+            board.drawGameInfo(pacman.score, pacman.lives);
+            pacman.draw();
+            aggressiveGhost.draw();
+            randomGhost.draw();
+            refresh();  // Atualiza a tela
+            dirty = false;
+        }
 
-        refresh();  // Atualiza a tela
-        napms(100);  // Pequeno delay
+        std::this_thread::sleep_until(now + (tickStep - accumulator));
     }
 
     // Limpa PDCurses
@@ -0,0 +1,106 @@
+#include "entity_world.h"
+#include "board.h"
+#include "frame_renderer.h"
+#include <stdexcept>
+
+EntityWorld::EntityWorld() : count(0), freeCount(CAPACITY) {
+    // O slot 0 sai primeiro: entidades criadas por ordem ficam nos slots 0, 1, ...
+    for (int slot = 0; slot < CAPACITY; slot++) {
+        generations[slot] = 0;
+        denseOf[slot] = NO_ENTITY;
+        freeSlots[slot] = static_cast<uint16_t>(CAPACITY - 1 - slot);
+    }
+}
+
+EntityHandle EntityWorld::create(uint8_t components) {
+    if (freeCount == 0) {
+        throw std::runtime_error("Mundo de entidades cheio");
+    }
+    const uint16_t slot = freeSlots[--freeCount];
+    const int index = count++;
+    denseOf[slot] = static_cast<uint16_t>(index);
+    slotOf[index] = slot;
+
+    masks[index] = components;
+    positions[index] = Position();
+    velocities[index] = Velocity();
+    renderables[index] = Renderable();
+    colliders[index] = Collider();
+    controllers[index] = AIController();
+    timers[index] = Timer();
+    return EntityHandle(slot, generations[slot]);
+}
+
+bool EntityWorld::destroy(EntityHandle entity) {
+    const int index = indexOf(entity);
+    if (index < 0) return false;
+
+    // A ltima entidade passa para o buraco, em todos os arrays
+    const int last = count - 1;
+    if (index != last) {
+        masks[index] = masks[last];
+        positions[index] = positions[last];
+        velocities[index] = velocities[last];
+        renderables[index] = renderables[last];
+        colliders[index] = colliders[last];
+        controllers[index] = controllers[last];
+        timers[index] = timers[last];
+        slotOf[index] = slotOf[last];
+        denseOf[slotOf[index]] = static_cast<uint16_t>(index);
+    }
+    count--;
+    denseOf[entity.slot] = NO_ENTITY;
+    generations[entity.slot]++;
+    freeSlots[freeCount++] = entity.slot;
+    return true;
+}
+
+bool EntityWorld::step(EntityHandle entity, const Board& board) {
+    const int index = require(entity);
+    Position& position = positions[index];
+    const Velocity& velocity = velocities[index];
+    if (velocity.dx == 0 && velocity.dy == 0) return false;
+
+    if (!board.canMove(position.x, position.y, velocity.dx, velocity.dy)) return false;
+    position.x = static_cast<int16_t>(position.x + velocity.dx);
+    position.y = static_cast<int16_t>(position.y + velocity.dy);
+    return true;
+}
+
+int EntityWorld::findAt(int x, int y, uint8_t layers, EntityHandle* out, int capacity) const {
+    const uint8_t required = COMPONENT_POSITION | COMPONENT_COLLIDER;
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        if ((masks[i] & required) != required || (colliders[i].layer & layers) == 0) continue;
+        if (positions[i].x != x || positions[i].y != y) continue;
+        if (found < capacity) out[found] = handleAt(i);
+        found++;
+    }
+    return found;
+}
+
+int EntityWorld::render(FrameRenderer& screen, Position* drawn) const {
+    const uint8_t required = COMPONENT_POSITION | COMPONENT_RENDERABLE;
+    int drawnCount = 0;
+    for (int i = 0; i < count; i++) {
+        if ((masks[i] & required) != required) continue;
+        const Renderable& renderable = renderables[i];
+        screen.put(positions[i].x, positions[i].y, renderable.glyph, renderable.color, renderable.style);
+        drawn[drawnCount++] = positions[i];
+    }
+    return drawnCount;
+}
+
+int EntityWorld::indexOf(EntityHandle entity) const {
+    if (entity.slot >= CAPACITY || generations[entity.slot] != entity.generation) return -1;
+    const uint16_t index = denseOf[entity.slot];
+    return index == NO_ENTITY ? -1 : index;
+}
+
+int EntityWorld::require(EntityHandle entity) const {
+    const int index = indexOf(entity);
+    if (index < 0) {
+        throw std::runtime_error("Entidade inexistente");
+    }
+    return index;
+}
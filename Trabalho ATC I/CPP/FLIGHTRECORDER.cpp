@@ -0,0 +1,198 @@
+#include "flight_recorder.h"
+#include "game.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // O gravador que os handlers de sinal despejam
+    FlightRecorder* volatile crashRecorder = nullptr;
+
+    const int CRASH_SIGNALS[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+
+    bool writeAll(int fd, const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            const ssize_t written = write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    // strncpy sem depender de nada que no seja seguro num sinal
+    void copyText(char* out, size_t size, const char* text) {
+        size_t i = 0;
+        for (; text && text[i] && i + 1 < size; i++) out[i] = text[i];
+        for (; i < size; i++) out[i] = '\0';
+    }
+}
+
+FlightRecorder::FlightRecorder(const std::string& basePath, int ticksPerSecond, int seconds)
+    : basePath(basePath), next(0), count(0), ticksPerSecond(0), seed(0), budgetMicros(0),
+    lastBudgetDumpTick(0), hasBudgetDump(false), dumps(0), handlersInstalled(false) {
+    if (ticksPerSecond <= 0 || seconds <= 0) {
+        throw std::runtime_error("Gravador de voo: ritmo e durao tm de ser positivos");
+    }
+    this->ticksPerSecond = static_cast<uint32_t>(ticksPerSecond);
+    ring.resize(static_cast<size_t>(ticksPerSecond) * seconds);
+    std::memset(ring.data(), 0, ring.size() * sizeof(FlightRecord));
+    std::memset(&pending, 0, sizeof(pending));
+    std::snprintf(crashPath, sizeof(crashPath), "%s-crash.pmfr", basePath.c_str());
+}
+
+FlightRecorder::~FlightRecorder() {
+    if (handlersInstalled) {
+        for (int signalNumber : CRASH_SIGNALS) {
+            signal(signalNumber, SIG_DFL);
+        }
+        crashRecorder = nullptr;
+    }
+}
+
+void FlightRecorder::recordInput(int key) {
+    if (pending.inputCount < FlightRecord::MAX_INPUTS) {
+        pending.inputs[pending.inputCount] = static_cast<int16_t>(key);
+    }
+    if (pending.inputCount < UINT8_MAX) pending.inputCount++;
+}
+
+void FlightRecorder::recordTick(const Game& game, uint32_t tickMicros) {
+    FlightRecord& record = ring[next];
+    record = pending;
+    std::memset(&pending, 0, sizeof(pending));
+
+    record.stateHash = game.getStateHash();
+    record.tick = game.getTickCount();
+    record.tickMicros = tickMicros;
+    record.score = game.getScore();
+    record.gameState = static_cast<uint8_t>(game.getState());
+    record.lives = static_cast<uint8_t>(game.getLives());
+    record.level = static_cast<uint8_t>(game.getLevel());
+    record.events = game.getTickEvents().getTypeMask();
+
+    const Pacman& pacman = game.getPacman();
+    record.pacmanX = static_cast<int16_t>(pacman.getX());
+    record.pacmanY = static_cast<int16_t>(pacman.getY());
+    record.pacmanDirectionX = static_cast<int8_t>(pacman.getDirectionX());
+    record.pacmanDirectionY = static_cast<int8_t>(pacman.getDirectionY());
+
+    const auto& ghosts = game.getGhosts();
+    for (int i = 0; i < FlightRecord::MAX_GHOSTS; i++) {
+        if (i < ghosts.size()) {
+            record.ghostX[i] = static_cast<int16_t>(ghosts[i].getX());
+            record.ghostY[i] = static_cast<int16_t>(ghosts[i].getY());
+            record.ghostState[i] = static_cast<uint8_t>(ghosts[i].getState());
+        }
+    }
+    seed = game.getSeed();
+
+    next = (next + 1) % ring.size();
+    if (count < ring.size()) count++;
+
+    if (budgetMicros > 0 && tickMicros > budgetMicros &&
+        (!hasBudgetDump || record.tick - lastBudgetDumpTick >= ring.size())) {
+        char detail[64];
+        std::snprintf(detail, sizeof(detail), "tick de %u us (oramento %u us)", tickMicros, budgetMicros);
+        dump("budget", detail);
+        lastBudgetDumpTick = record.tick;
+        hasBudgetDump = true;
+    }
+}
+
+bool FlightRecorder::writeDump(int fd, const char* reason, const char* detail) const {
+    FlightDumpHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic[0] = 'P'; header.magic[1] = 'M'; header.magic[2] = 'F'; header.magic[3] = 'R';
+    header.version = FlightDumpHeader::VERSION;
+    header.recordSize = sizeof(FlightRecord);
+    header.recordCount = static_cast<uint32_t>(count);
+    header.ticksPerSecond = ticksPerSecond;
+    header.seed = seed;
+    copyText(header.reason, sizeof(header.reason), reason);
+    copyText(header.detail, sizeof(header.detail), detail);
+
+    // Do mais antigo ao mais recente: o anel em duas partes
+    const size_t oldest = count < ring.size() ? 0 : next;
+    const size_t firstPart = count < ring.size() ? count : ring.size() - oldest;
+    return writeAll(fd, &header, sizeof(header)) &&
+        writeAll(fd, ring.data() + oldest, firstPart * sizeof(FlightRecord)) &&
+        writeAll(fd, ring.data(), (count - firstPart) * sizeof(FlightRecord));
+}
+
+std::string FlightRecorder::dump(const char* reason, const char* detail) {
+    const uint32_t lastTick = count > 0 ? ring[(next + ring.size() - 1) % ring.size()].tick : 0;
+    const std::string path = basePath + "-" + std::to_string(lastTick) + "-" + reason + ".pmfr";
+
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return std::string();
+    const bool written = writeDump(fd, reason, detail);
+    close(fd);
+    if (!written) return std::string();
+
+    dumps++;
+    lastDumpPath = path;
+    return path;
+}
+
+void FlightRecorder::onCrashSignal(int signalNumber) {
+    FlightRecorder* recorder = crashRecorder;
+    if (recorder) {
+        crashRecorder = nullptr;   // Um segundo sinal durante o despejo no repete
+        const int fd = open(recorder->crashPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd >= 0) {
+            char detail[16] = "sinal ";
+            detail[6] = static_cast<char>('0' + signalNumber / 10);
+            detail[7] = static_cast<char>('0' + signalNumber % 10);
+            recorder->writeDump(fd, "crash", detail);
+            close(fd);
+        }
+    }
+    // SA_RESETHAND reps a ao por omisso: o processo termina como terminaria
+    raise(signalNumber);
+}
+
+void FlightRecorder::installCrashHandlers() {
+    crashRecorder = this;
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onCrashSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND | SA_NODEFER;
+    for (int signalNumber : CRASH_SIGNALS) {
+        sigaction(signalNumber, &action, nullptr);
+    }
+    handlersInstalled = true;
+}
+
+void FlightRecorder::readDump(const std::string& path, FlightDumpHeader& header,
+    std::vector<FlightRecord>& records) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("No foi possvel abrir " + path);
+    }
+    const bool headerRead = std::fread(&header, sizeof(header), 1, file) == 1;
+    if (!headerRead || std::memcmp(header.magic, "PMFR", 4) != 0 ||
+        header.version != FlightDumpHeader::VERSION || header.recordSize != sizeof(FlightRecord)) {
+        std::fclose(file);
+        throw std::runtime_error("No  um despejo do gravador de voo: " + path);
+    }
+    header.reason[sizeof(header.reason) - 1] = '\0';
+    header.detail[sizeof(header.detail) - 1] = '\0';
+
+    records.resize(header.recordCount);
+    const size_t read = records.empty() ? 0 :
+        std::fread(records.data(), sizeof(FlightRecord), records.size(), file);
+    std::fclose(file);
+    if (read != records.size()) {
+        throw std::runtime_error("Despejo truncado: " + path);
+    }
+}
@@ -0,0 +1,620 @@
+#include "frame_renderer.h"
+#include "trace.h"
+#include "metrics.h"
+#include <curses.h>
+#include <cstdarg>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+    const ScreenCell BLANK_CELL = { ' ', 0, STYLE_NONE, 0 };
+
+    // Tamanho da sequncia UTF-8 que comea em text, ou 1 se no for UTF-8
+    // vlido (texto latin1: cada byte  um carcter)
+    int charLength(const unsigned char* text) {
+        int length;
+        if (text[0] < 0x80) return 1;
+        else if ((text[0] & 0xE0) == 0xC0) length = 2;
+        else if ((text[0] & 0xF0) == 0xE0) length = 3;
+        else if ((text[0] & 0xF8) == 0xF0) length = 4;
+        else return 1;
+        for (int i = 1; i < length; i++) {
+            if ((text[i] & 0xC0) != 0x80) return 1;
+        }
+        return length;
+    }
+
+    chtype lineChar(uint32_t glyph) {
+        switch (static_cast<LineGlyph>(glyph)) {
+        case LineGlyph::VERTICAL:    return ACS_VLINE;
+        case LineGlyph::HORIZONTAL:  return ACS_HLINE;
+        case LineGlyph::UPPER_LEFT:  return ACS_ULCORNER;
+        case LineGlyph::UPPER_RIGHT: return ACS_URCORNER;
+        case LineGlyph::LOWER_LEFT:  return ACS_LLCORNER;
+        default:                     return ACS_LRCORNER;
+        }
+    }
+
+    // Mesmos caracteres em DEC Special Graphics (o que o ACS usa por baixo)
+    char decLineChar(uint32_t glyph) {
+        switch (static_cast<LineGlyph>(glyph)) {
+        case LineGlyph::VERTICAL:    return 'x';
+        case LineGlyph::HORIZONTAL:  return 'q';
+        case LineGlyph::UPPER_LEFT:  return 'l';
+        case LineGlyph::UPPER_RIGHT: return 'k';
+        case LineGlyph::LOWER_LEFT:  return 'm';
+        default:                     return 'j';
+        }
+    }
+
+    // Cor de frente SGR de cada par de PacmanUI::initializeColors (fundo preto)
+    const int PAIR_FOREGROUND[] = { 39, 33, 31, 35, 36, 32, 37, 34 };
+    const int PAIR_COUNT = sizeof(PAIR_FOREGROUND) / sizeof(PAIR_FOREGROUND[0]);
+
+    const uint8_t SGR_STYLES = STYLE_BOLD | STYLE_REVERSE;
+
+    // Sequncia "ESC [ n letra" num buffer pequeno; devolve o tamanho
+    int writeSequence(char* out, int value, char letter) {
+        int length = 0;
+        out[length++] = '\x1b';
+        out[length++] = '[';
+        if (value != 1) {
+            length += std::sprintf(out + length, "%d", value);
+        }
+        out[length++] = letter;
+        return length;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// CursesBackend
+
+void CursesBackend::drawRun(int x, int y, const ScreenCell* cells, int count) {
+    attr_t attributes = COLOR_PAIR(cells[0].color);
+    if (cells[0].style & STYLE_BOLD) attributes |= A_BOLD;
+    if (cells[0].style & STYLE_REVERSE) attributes |= A_REVERSE;
+    attrset(attributes);
+
+    if (cells[0].style & STYLE_LINE) {
+        for (int i = 0; i < count; i++) {
+            mvaddch(y, x + i, lineChar(cells[i].glyph));
+        }
+        return;
+    }
+
+    // Bytes de cada carcter seguidos: uma chamada por sequncia
+    char text[4 * 256];
+    int length = 0;
+    for (int i = 0; i < count; i++) {
+        for (uint32_t glyph = cells[i].glyph; glyph && length < static_cast<int>(sizeof(text)); glyph >>= 8) {
+            text[length++] = static_cast<char>(glyph & 0xFF);
+        }
+    }
+    mvaddnstr(y, x, text, length);
+}
+
+void CursesBackend::endFrame() {
+    attrset(A_NORMAL);
+    refresh();
+}
+
+void CursesBackend::clearTerminal() {
+    clear();
+}
+
+// ---------------------------------------------------------------------------
+// AnsiBackend
+
+AnsiBackend::AnsiBackend(int fd, int width, int height)
+    : fd(fd),
+    width(std::max(1, width)),
+    height(std::max(1, height)),
+    buffer(static_cast<size_t>(this->width) * this->height * MAX_CELL_BYTES + 64),
+    used(0),
+    lastFrameBytes(0),
+    writes(0),
+    cursorX(-1),
+    cursorY(-1),
+    currentColor(-1),
+    currentStyle(-1),
+    lineCharset(false)
+{
+}
+
+AnsiBackend::~AnsiBackend() {
+    // Deixa o terminal como o encontrou para o endwin()
+    used = 0;
+    if (lineCharset) append("\x1b(B", 3);
+    append("\x1b[0m", 4);
+    try {
+        flush();
+    }
+    catch (...) {
+        // Um destrutor no pode propagar excees
+    }
+}
+
+void AnsiBackend::drawRun(int x, int y, const ScreenCell* cells, int count) {
+    if (used + static_cast<size_t>(count) * MAX_CELL_BYTES + 16 > buffer.size()) {
+        flush();   // No acontece com o ecr do tamanho pedido no construtor
+    }
+
+    moveCursor(x, y);
+    setAttributes(cells[0].color, cells[0].style);
+
+    if (cells[0].style & STYLE_LINE) {
+        if (!lineCharset) {
+            append("\x1b(0", 3);
+            lineCharset = true;
+        }
+        for (int i = 0; i < count; i++) {
+            buffer[used++] = decLineChar(cells[i].glyph);
+        }
+    }
+    else {
+        if (lineCharset) {
+            append("\x1b(B", 3);
+            lineCharset = false;
+        }
+        for (int i = 0; i < count; i++) {
+            for (uint32_t glyph = cells[i].glyph; glyph; glyph >>= 8) {
+                buffer[used++] = static_cast<char>(glyph & 0xFF);
+            }
+        }
+    }
+
+    // Depois da ltima coluna o cursor fica  espera de mudar de linha:
+    // a posio real depende do terminal, por isso esquecemo-la
+    cursorX = x + count < width ? x + count : -1;
+}
+
+void AnsiBackend::endFrame() {
+    if (lineCharset) {
+        append("\x1b(B", 3);
+        lineCharset = false;
+    }
+    lastFrameBytes = used;
+    flush();
+}
+
+void AnsiBackend::clearTerminal() {
+    if (lineCharset) {
+        append("\x1b(B", 3);
+        lineCharset = false;
+    }
+    // Reset antes do ED: com SGR ativo alguns terminais pintam o fundo
+    append("\x1b[0m\x1b[2J", 8);
+    currentColor = 0;
+    currentStyle = STYLE_NONE;
+}
+
+void AnsiBackend::moveCursor(int x, int y) {
+    if (x == cursorX && y == cursorY) return;
+
+    // Posio absoluta (CUP); coordenadas do terminal comeam em 1
+    char best[32];
+    int bestLength = 0;
+    best[bestLength++] = '\x1b';
+    best[bestLength++] = '[';
+    bestLength += std::sprintf(best + bestLength, "%d", y + 1);
+    if (x > 0) {
+        bestLength += std::sprintf(best + bestLength, ";%d", x + 1);
+    }
+    best[bestLength++] = 'H';
+
+    // Movimento relativo a partir da posio conhecida, se for mais curto
+    if (cursorX >= 0 && cursorY >= 0) {
+        char relative[32];
+        int length = 0;
+        int fromX = cursorX;
+        if (y > cursorY && x == 0 && y - cursorY <= 2) {
+            for (int i = cursorY; i < y; i++) {
+                relative[length++] = '\r';
+                relative[length++] = '\n';
+            }
+            fromX = 0;
+        }
+        else if (y != cursorY) {
+            length += writeSequence(relative + length, std::abs(y - cursorY), y > cursorY ? 'B' : 'A');
+        }
+        if (x != fromX) {
+            if (x == 0) {
+                relative[length++] = '\r';
+            }
+            else if (x > fromX) {
+                length += writeSequence(relative + length, x - fromX, 'C');
+            }
+            else {
+                length += writeSequence(relative + length, fromX - x, 'D');
+            }
+        }
+        if (length < bestLength) {
+            std::copy(relative, relative + length, best);
+            bestLength = length;
+        }
+    }
+
+    append(best, bestLength);
+    cursorX = x;
+    cursorY = y;
+}
+
+void AnsiBackend::setAttributes(uint8_t color, uint8_t style) {
+    style &= SGR_STYLES;
+    if (color == currentColor && style == currentStyle) return;
+
+    // Sempre a partir do reset: mais curto do que desligar atributos um a um
+    append("\x1b[0", 3);
+    if (style & STYLE_BOLD) append(";1", 2);
+    if (style & STYLE_REVERSE) append(";7", 2);
+    if (color > 0 && color < PAIR_COUNT) {
+        buffer[used++] = ';';
+        appendNumber(PAIR_FOREGROUND[color]);
+        append(";40", 3);
+    }
+    buffer[used++] = 'm';
+    currentColor = color;
+    currentStyle = style;
+}
+
+void AnsiBackend::append(const char* bytes, size_t count) {
+    std::copy(bytes, bytes + count, buffer.begin() + used);
+    used += count;
+}
+
+void AnsiBackend::appendNumber(int value) {
+    char digits[12];
+    append(digits, static_cast<size_t>(std::sprintf(digits, "%d", value)));
+}
+
+void AnsiBackend::flush() {
+    size_t sent = 0;
+    while (sent < used) {
+        ssize_t result = ::write(fd, buffer.data() + sent, used - sent);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            used = 0;
+            throw std::runtime_error("Erro ao escrever no terminal");
+        }
+        sent += static_cast<size_t>(result);
+        writes++;
+    }
+    used = 0;
+}
+
+std::unique_ptr<ScreenBackend> createScreenBackend(RendererKind kind, int width, int height) {
+    if (kind == RendererKind::RAW_ANSI) {
+        if (!isatty(STDOUT_FILENO)) {
+            throw std::runtime_error("O renderer ANSI precisa de um terminal no stdout");
+        }
+        return std::unique_ptr<ScreenBackend>(new AnsiBackend(STDOUT_FILENO, width, height));
+    }
+    return std::unique_ptr<ScreenBackend>(new CursesBackend());
+}
+
+// ---------------------------------------------------------------------------
+// FrameRenderer
+
+FrameRenderer::FrameRenderer(int width, int height, std::unique_ptr<ScreenBackend> backend)
+    : width(std::max(1, width)),
+    height(std::max(1, height)),
+    backend(std::move(backend)),
+    next(static_cast<size_t>(this->width) * this->height, BLANK_CELL),
+    shown(static_cast<size_t>(this->width) * this->height, BLANK_CELL),
+    dirtyMin(static_cast<size_t>(this->height), this->width),
+    dirtyMax(static_cast<size_t>(this->height), -1),
+    fullRedraw(false),
+    threaded(false),
+    backSlot(0),
+    frontSlot(2),
+    middleSlot(1),
+    latestTick(0),
+    carryFullRedraw(false),
+    stopRequested(false)
+{
+    // O terminal comea em branco (initscr), tal como shown
+}
+
+FrameRenderer::~FrameRenderer() {
+    try {
+        stopThread();
+    }
+    catch (...) {
+        // Um destrutor no pode propagar excees
+    }
+}
+
+void FrameRenderer::startThread() {
+    if (threaded) return;
+
+    for (FrameSlot& slot : slots) {
+        slot.cells = next;
+        slot.dirtyMin.assign(static_cast<size_t>(height), width);
+        slot.dirtyMax.assign(static_cast<size_t>(height), -1);
+        slot.fullRedraw = false;
+        slot.tick = 0;
+    }
+    carryMin.assign(static_cast<size_t>(height), width);
+    carryMax.assign(static_cast<size_t>(height), -1);
+    carryFullRedraw = false;
+    backSlot = 0;
+    middleSlot.store(1);
+    frontSlot = 2;
+    stopRequested = false;
+
+    threaded = true;
+    renderThread = std::thread(&FrameRenderer::renderLoop, this);
+}
+
+void FrameRenderer::stopThread() {
+    if (!threaded) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopRequested = true;
+    }
+    wakeCondition.notify_one();
+    renderThread.join();
+    threaded = false;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (renderError) {
+        std::exception_ptr error = renderError;
+        renderError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+RenderStats FrameRenderer::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void FrameRenderer::clear() {
+    std::fill(next.begin(), next.end(), BLANK_CELL);
+    markAllDirty();
+}
+
+void FrameRenderer::clearArea(int x, int y, int areaWidth, int areaHeight) {
+    for (int row = std::max(0, y); row < std::min(height, y + areaHeight); row++) {
+        for (int column = std::max(0, x); column < std::min(width, x + areaWidth); column++) {
+            put(column, row, ' ');
+        }
+    }
+}
+
+void FrameRenderer::put(int x, int y, uint32_t glyph, uint8_t color, uint8_t style) {
+    if (x < 0 || y < 0 || x >= width || y >= height) return;
+    ScreenCell cell = { glyph, color, style, 0 };
+    ScreenCell& target = next[y * width + x];
+    if (target != cell) {
+        target = cell;
+        touch(x, y);
+    }
+}
+
+void FrameRenderer::putLine(int x, int y, LineGlyph glyph, uint8_t color) {
+    put(x, y, static_cast<uint32_t>(glyph), color, STYLE_LINE);
+}
+
+int FrameRenderer::print(int x, int y, const char* text, uint8_t color, uint8_t style) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+    int columns = 0;
+    while (*p) {
+        const int length = charLength(p);
+        uint32_t glyph = 0;
+        for (int i = 0; i < length; i++) {
+            glyph |= static_cast<uint32_t>(p[i]) << (8 * i);
+        }
+        put(x + columns, y, glyph, color, style);
+        p += length;
+        columns++;
+    }
+    return columns;
+}
+
+int FrameRenderer::printf(int x, int y, uint8_t color, uint8_t style, const char* format, ...) {
+    char text[256];
+    va_list arguments;
+    va_start(arguments, format);
+    std::vsnprintf(text, sizeof(text), format, arguments);
+    va_end(arguments);
+    return print(x, y, text, color, style);
+}
+
+void FrameRenderer::present(uint32_t tick) {
+    if (threaded) {
+        publish(tick);
+        return;
+    }
+    presentCells(next.data(), dirtyMin.data(), dirtyMax.data(), fullRedraw);
+    fullRedraw = false;
+}
+
+void FrameRenderer::publish(uint32_t tick) {
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (renderError) {
+            std::exception_ptr error = renderError;
+            renderError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    // O frame leva as suas mudanas e as dos frames que a thread talvez
+    // ainda no tenha visto; a mais s custa comparar algumas clulas
+    FrameSlot& slot = slots[backSlot];
+    std::copy(next.begin(), next.end(), slot.cells.begin());
+    for (int y = 0; y < height; y++) {
+        slot.dirtyMin[y] = std::min(carryMin[y], dirtyMin[y]);
+        slot.dirtyMax[y] = std::max(carryMax[y], dirtyMax[y]);
+    }
+    slot.fullRedraw = carryFullRedraw || fullRedraw;
+    slot.tick = tick;
+    slot.publishedAt = std::chrono::steady_clock::now();
+    latestTick.store(tick, std::memory_order_relaxed);
+
+    const int previous = middleSlot.exchange(backSlot | FRESH_SLOT, std::memory_order_acq_rel);
+    backSlot = previous & SLOT_MASK;
+    const bool dropped = (previous & FRESH_SLOT) != 0;
+
+    if (dropped) {
+        // O frame anterior nunca foi desenhado: as mudanas dele continuam pendentes
+        for (int y = 0; y < height; y++) {
+            carryMin[y] = std::min(carryMin[y], dirtyMin[y]);
+            carryMax[y] = std::max(carryMax[y], dirtyMax[y]);
+        }
+        carryFullRedraw = carryFullRedraw || fullRedraw;
+    }
+    else {
+        // A thread j levou o anterior: s faltam as mudanas deste
+        std::copy(dirtyMin.begin(), dirtyMin.end(), carryMin.begin());
+        std::copy(dirtyMax.begin(), dirtyMax.end(), carryMax.begin());
+        carryFullRedraw = fullRedraw;
+    }
+    std::fill(dirtyMin.begin(), dirtyMin.end(), width);
+    std::fill(dirtyMax.begin(), dirtyMax.end(), -1);
+    fullRedraw = false;
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.published++;
+        if (dropped) stats.dropped++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+void FrameRenderer::renderLoop() {
+    if (Tracer::isEnabled()) Tracer::setThreadName("render");
+    long long presented = 0;
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait(lock, [this] {
+                return stopRequested || (middleSlot.load(std::memory_order_acquire) & FRESH_SLOT);
+            });
+            stopping = stopRequested;
+        }
+
+        // Ao parar, o ltimo frame publicado ainda  desenhado
+        if (middleSlot.load(std::memory_order_acquire) & FRESH_SLOT) {
+            frontSlot = middleSlot.exchange(frontSlot, std::memory_order_acq_rel) & SLOT_MASK;
+            FrameSlot& slot = slots[frontSlot];
+            try {
+                presentCells(slot.cells.data(), slot.dirtyMin.data(), slot.dirtyMax.data(), slot.fullRedraw);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                renderError = std::current_exception();
+                return;
+            }
+
+            const double lagMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - slot.publishedAt).count();
+            const uint32_t lagTicks = latestTick.load(std::memory_order_relaxed) - slot.tick;
+            presented++;
+
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.lastLagTicks = lagTicks;
+            stats.maxLagTicks = std::max(stats.maxLagTicks, lagTicks);
+            stats.meanLagMs += (lagMs - stats.meanLagMs) / presented;
+            stats.maxLagMs = std::max(stats.maxLagMs, lagMs);
+        }
+        else if (stopping) {
+            return;
+        }
+    }
+}
+
+void FrameRenderer::presentCells(const ScreenCell* cells, int* rowMin, int* rowMax, bool clearFirst) {
+    TRACE_SCOPE("present");
+    int cellCount = 0;
+    int runs = 0;
+    bool begun = false;
+
+    if (clearFirst) {
+        // Mesmo que o frame esteja em branco, a limpeza tem de ser enviada
+        backend->beginFrame();
+        backend->clearTerminal();
+        begun = true;
+        std::fill(shown.begin(), shown.end(), BLANK_CELL);
+        std::fill(rowMin, rowMin + height, 0);
+        std::fill(rowMax, rowMax + height, width - 1);
+    }
+
+    for (int y = 0; y < height; y++) {
+        if (rowMin[y] > rowMax[y]) continue;
+        const ScreenCell* row = &cells[y * width];
+        ScreenCell* rowShown = &shown[y * width];
+
+        int x = rowMin[y];
+        const int end = rowMax[y] + 1;
+        while (x < end) {
+            if (row[x] == rowShown[x]) {
+                x++;
+                continue;
+            }
+
+            // Estende a sequncia enquanto os atributos forem iguais,
+            // atravessando pequenos trechos sem mudanas
+            const int start = x;
+            int last = x;
+            for (int probe = x + 1; probe < end && probe - last <= MAX_BRIDGE; probe++) {
+                if (!row[probe].sameAttributes(row[start])) break;
+                if (row[probe] != rowShown[probe]) last = probe;
+            }
+            const int count = last - start + 1;
+
+            if (!begun) {
+                backend->beginFrame();
+                begun = true;
+            }
+            backend->drawRun(start, y, row + start, count);
+            std::copy(row + start, row + start + count, rowShown + start);
+            cellCount += count;
+            runs++;
+            x = last + 1;
+        }
+        rowMin[y] = width;
+        rowMax[y] = -1;
+    }
+
+    if (begun) {
+        backend->endFrame();
+        Metrics::observe(MetricHistogram::FRAME_BYTES, static_cast<double>(backend->getLastFrameBytes()));
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (begun) {
+        stats.frames++;
+        stats.bytes += static_cast<long long>(backend->getLastFrameBytes());
+    }
+    else {
+        stats.idleFrames++;
+    }
+    stats.cells += cellCount;
+    stats.runs += runs;
+    stats.lastCells = cellCount;
+    stats.lastRuns = runs;
+}
+
+void FrameRenderer::invalidate() {
+    fullRedraw = true;
+}
+
+void FrameRenderer::touch(int x, int y) {
+    if (x < dirtyMin[y]) dirtyMin[y] = x;
+    if (x > dirtyMax[y]) dirtyMax[y] = x;
+}
+
+void FrameRenderer::markAllDirty() {
+    std::fill(dirtyMin.begin(), dirtyMin.end(), 0);
+    std::fill(dirtyMax.begin(), dirtyMax.end(), width - 1);
+}
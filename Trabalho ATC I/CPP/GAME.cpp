@@ -1,10 +1,41 @@
 // game.cpp
 #include "game.h"
+#include "replay.h"
+#include "replay_stream.h"
+#include "state_hash.h"
+#include "tick_profiler.h"
+#include "trace.h"
+#include "metrics.h"
+#include "frame_renderer.h"
 #include <curses.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+    struct GhostSpawn {
+        int x, y;
+        GhostType type;
+        uint32_t releaseDelay;   // Ticks na casa no incio do nvel
+    };
+
+    const GhostSpawn GHOST_SPAWNS[] = {
+        { 13, 11, GhostType::BLINKY, 1 },
+        { 13, 13, GhostType::PINKY, 90 },
+        { 15, 13, GhostType::INKY, 180 },
+        { 17, 13, GhostType::CLYDE, 270 }
+    };
+    const int GHOST_COUNT = sizeof(GHOST_SPAWNS) / sizeof(GHOST_SPAWNS[0]);
+
+    const uint32_t TRANSITION_TICKS = 90;       // Ecr entre nveis
+    const uint32_t GHOST_RESPAWN_TICKS = 90;    // Na casa depois de comido
+    const int GHOST_POINTS = 200;
+}
 
 Game::Game(int width, int height)
     : board(new Board(width, height)),
-    pacman(new Pacman(width / 2, height / 2)),
+    pacman(new Pacman(entities, width / 2, height / 2)),
     gameMenu(new GameMenu("Pac-Man")),
     highscoreManager(new HighScoreManager()),
     state(GameState::MENU),
@@ -12,143 +43,485 @@ Game::Game(int width, int height)
     score(0),
     lives(3),
     isGameOver(false),
-    transitionTimer(0)
+    renderDirty(true),
+    quitRequested(false),
+    showingHighScores(false),
+    tickCount(0),
+    controlledGhost(-1),
+    speculative(false),
+    seed(1),
+    rng(1),
+    recorder(nullptr),
+    streamWriter(nullptr),
+    rendererKind(RendererKind::CURSES_LIB),
+    renderThreaded(false),
+    shownScreen(-1)
 {
-    initializeGhosts();
+    clearHashHistory();
+#ifdef PACMAN_PROFILE
+    showProfiler = false;
+    profileSummaryTick = 0;
+    profileSummary = ProfileSummary();
+#endif
+    resetLevelEntities();
     initializeLevelConfigs();
     setupMainMenu();
+    // O primeiro frame no cresce o vetor: as entidades e as casas dos popups
+    drawnEntities.reserve(EntityWorld::CAPACITY + MAX_POPUPS * 4);
 }
 
 Game::~Game() {
-    delete board;
-    delete pacman;
-    delete gameMenu;
-    delete highscoreManager;
-    ghosts.clear();
+    // Uma sesso interrompida tambm fica gravada (til para relatar bugs)
+    if (recorder && recorder->isRecording()) {
+        try {
+            recorder->endSession(tickCount, score, lives, currentLevel);
+        }
+        catch (...) {
+            // Um destrutor no pode propagar excees
+        }
+    }
 }
 
-void Game::initializeGhosts() {
-    ghosts.push_back(std::make_shared<Ghost>(13, 11, GhostType::BLINKY));
-    ghosts.push_back(std::make_shared<Ghost>(13, 13, GhostType::PINKY));
-    ghosts.push_back(std::make_shared<Ghost>(15, 13, GhostType::INKY));
-    ghosts.push_back(std::make_shared<Ghost>(17, 13, GhostType::CLYDE));
+// As entidades so do nvel: em vez de um delete por entidade, a arena
+//  limpa de uma vez e os pools recomeam nela (os handles antigos deixam
+// de resolver). Os fantasmas so criados de novo no spawn, cada um com o
+// seu timer de sada da casa; o que no  do nvel (velocidade, controlo
+// pelo jogador) passa para os novos, tal como o respawn() o mantinha.
+void Game::resetLevelEntities() {
+    GhostSnapshot carried[GameSnapshot::MAX_GHOSTS];
+    const int carriedCount = ghosts.size();
+    for (int i = 0; i < carriedCount; i++) {
+        ghosts[i].saveState(carried[i]);
+    }
+    // As entidades dos fantasmas saem do mundo (do fim para o incio: os
+    // novos voltam a ficar nos mesmos slots, a seguir ao Pacman)
+    for (int i = carriedCount - 1; i >= 0; i--) {
+        timers.cancel(releaseTimer(i));
+        entities.destroy(ghosts[i].getEntity());
+    }
+
+    levelArena.reset();
+    ghosts.reset(levelArena);
+    popups.reset(levelArena);
+    for (int i = 0; i < GHOST_COUNT; i++) {
+        const GhostSpawn& spawn = GHOST_SPAWNS[i];
+        Ghost* ghost = ghosts.get(ghosts.create(entities, i, spawn.x, spawn.y, spawn.type));
+        if (i < carriedCount) {
+            GhostSnapshot kept;
+            ghost->saveState(kept);
+            kept.speed = carried[i].speed;
+            kept.controlled = carried[i].controlled;
+            ghost->restoreState(kept);
+        }
+        scheduleRelease(i, spawn.releaseDelay);
+    }
+}
+
+void Game::spawnEntities() {
+    pacman->respawn();
+    timers.cancel(powerTimer);
+    resetLevelEntities();
 }
 
 void Game::initializeLevelConfigs() {
     levelConfigs = {
-        {1, 1, 300, 500},  // Nvel 1
-        {2, 1, 250, 1000}, // Nvel 2
-        {2, 2, 200, 1500}  // Nvel 3
+        {1, 1, 300, 500, 4},  // Nvel 1
+        {2, 1, 250, 1000, 4}, // Nvel 2
+        {2, 2, 200, 1500, 3}  // Nvel 3: mais rpido, janela mais curta
     };
 }
 
 void Game::setupMainMenu() {
-    gameMenu->addOption("Novo Jogo", 10, 10, [this]() { startGame(); });
-    gameMenu->addOption("Continuar", 10, 12, [this]() { resumeGame(); });
-    gameMenu->addOption("Pontuaes", 10, 14, [this]() { showHighScore(); });
-    gameMenu->addOption("Sair", 10, 16, []() { exit(0); });
+    // As aes s mudam o estado; o desenho fica para o render()
+    MenuActions actions;
+    actions.newGame = [this]() { startGame(); };
+    actions.resume = [this]() { resumeGame(); };
+    actions.restartLevel = [this]() { resetLevel(); resumeGame(); };
+    actions.showHighScores = [this]() { showingHighScores = true; };
+    actions.quit = [this]() { requestQuit(); };
+    gameMenu->setActions(actions);
 }
 
 void Game::startGame() {
+    rng.reseed(seed);
+    tickCount = 0;
+    clearHashHistory();
+    if (recorder && !speculative) {
+        recorder->beginSession(seed, getMazeId(), levelConfigs);
+    }
     resetGameState();
     state = GameState::PLAYING;
     spawnEntities();
+    // Configurao do nvel 1 (pr-viragem, velocidades): tambm repe as
+    // velocidades que os fantasmas trazem de um jogo anterior
+    updateDifficulty();
+#ifdef PACMAN_PROFILE
+    profiler.reset();
+#endif
+    renderDirty = true;
+
+    // Frame inicial do stream (ser um keyframe)
+    if (streamWriter && !speculative) {
+        streamWriter->captureTick(*this);
+    }
 }
 
 void Game::resetGameState() {
+    timers.clear();
     score = 0;
     lives = 3;
     currentLevel = 1;
     isGameOver = false;
     board->resetBoard();
-    pacman->respawn();
-    for (auto& ghost : ghosts) {
-        ghost->respawn();
-    }
 }
 
+// Um tick da simulao. No desenha nada: o GameLoop chama render()
+// separadamente, com a sua prpria cadncia, quando needsRender()  true.
 void Game::updateGameState() {
+    TRACE_SCOPE("tick");
+    tickCount++;
+    tickEvents.clear();
+
     if (state == GameState::PLAYING) {
-        pacman->move(*board);
-        updateGhosts();
-        checkCollisions();
-        checkVictoryCondition();
-    }
-    else if (state == GameState::TRANSITION) {
-        if (--transitionTimer <= 0) {
-            nextLevel();
+        runTimers();
+
+        const int oldX = pacman->getX();
+        const int oldY = pacman->getY();
+
+        bool moved;
+        {
+            PROFILE_PHASE(profiler, TickPhase::PACMAN);
+            movePacman();
+        }
+        {
+            PROFILE_PHASE(profiler, TickPhase::GHOSTS);
+            moved = updateGhosts();
+        }
+        {
+            PROFILE_PHASE(profiler, TickPhase::COLLISIONS);
+            checkCollisions();
+        }
+        {
+            PROFILE_PHASE(profiler, TickPhase::VICTORY);
+            checkVictoryCondition();
+        }
+        dispatchEvents();
+
+        if (moved || pacman->getX() != oldX || pacman->getY() != oldY ||
+            state != GameState::PLAYING) {
+            renderDirty = true;
+        }
+        if (!speculative && updatePopups()) {
+            renderDirty = true;
+        }
+
+        if (Tracer::isEnabled()) {
+            int activeGhosts = 0;
+            for (const Ghost& ghost : ghosts) {
+                if (ghost.getIsActive() && ghost.getState() != GhostState::WAITING) activeGhosts++;
+            }
+            TRACE_COUNTER("pellets restantes", board->getRemainingPellets());
+            TRACE_COUNTER("fantasmas ativos", activeGhosts);
+        }
+    }
+    else if (state == GameState::TRANSITION || state == GameState::LEVEL_COMPLETE) {
+        runTimers();
+        // A contagem na tela muda a cada 30 ticks
+        if (timers.getRemaining(transitionTimer) % 30 == 0) {
+            renderDirty = true;
+        }
+    }
+
+    // Checksum do tick, para replays e peers compararem
+    const uint64_t hash = getStateHash();
+    TickHash& entry = hashHistory[tickCount % HASH_HISTORY];
+    entry.tick = tickCount;
+    entry.hash = hash;
+    if (recorder && recorder->isRecording() && !speculative) {
+        recorder->recordChecksum(tickCount, hash);
+    }
+
+    // O menu no faz parte da sesso gravada
+    if (streamWriter && state != GameState::MENU && !speculative) {
+        streamWriter->captureTick(*this);
+    }
+}
+
+uint64_t Game::getStateHash() const {
+    uint64_t hash = board->getHash() ^ pacman->getHash();
+    for (const Ghost& ghost : ghosts) {
+        hash ^= ghost.getHash();
+    }
+
+    // Escalares do jogo, cada um com o seu "sal" para no se anularem
+    hash ^= StateHash::mix(static_cast<uint32_t>(score) |
+        (static_cast<uint64_t>(static_cast<uint16_t>(lives)) << 32) |
+        (static_cast<uint64_t>(static_cast<uint8_t>(state)) << 48));
+    hash ^= StateHash::mix((static_cast<uint64_t>(static_cast<uint16_t>(currentLevel)) |
+        (static_cast<uint64_t>(timers.getRemaining(transitionTimer)) << 16)) ^ 0xA5A5000000000000ULL);
+    // Timers: o que falta a cada um (o tick da roda no  estado do snapshot)
+    uint64_t releases = 0;
+    for (int i = 0; i < ghosts.size(); i++) {
+        const TimerHandle release = entities.getTimer(ghosts[i].getEntity()).handle;
+        releases |= static_cast<uint64_t>(timers.getRemaining(release) & 0xFFFF) << (16 * i);
+    }
+    hash ^= StateHash::mix(releases ^ 0x3C3C3C3C3C3C3C3CULL);
+    hash ^= StateHash::mix(static_cast<uint64_t>(timers.getRemaining(powerTimer)) ^ 0xC3C3000000000000ULL);
+    hash ^= StateHash::mix(rng.getState() ^ 0x5A5A5A5A5A5A5A5AULL);
+    return hash;
+}
+
+void Game::clearHashHistory() {
+    for (int i = 0; i < HASH_HISTORY; i++) {
+        hashHistory[i].tick = UINT32_MAX;
+        hashHistory[i].hash = 0;
+    }
+}
+
+bool Game::getTickHash(uint32_t tick, uint64_t& hash) const {
+    const TickHash& entry = hashHistory[tick % HASH_HISTORY];
+    if (entry.tick != tick) {
+        return false;
+    }
+    hash = entry.hash;
+    return true;
+}
+
+// Com speed > 1 o Pacman anda uma casa de cada vez: no salta paredes e
+// come os pellets das casas por onde passa. A casa onde acaba (fantasmas
+// includos) fica para o checkCollisions(), como com speed 1.
+void Game::movePacman() {
+    const int speed = pacman->getSpeed();
+    for (int i = 0; i < speed; i++) {
+        const int x = pacman->getX();
+        const int y = pacman->getY();
+        if (!pacman->step(*board)) break;
+        if (i > 0) collectPellet(x, y);
+    }
+    pacman->endMove();
+}
+
+// Sistema de IA: percorre as entidades com AIController, pela ordem dos
+// arrays do mundo (a de criao dos fantasmas). Cada fantasma d speed
+// passos de uma casa, como o Pacman, e pra se chegar  casa do Pacman para
+// no passar por cima dele sem coliso.
+bool Game::updateGhosts() {
+    TRACE_SCOPE("ghosts");
+    bool moved = false;
+    const int pacmanX = pacman->getX();
+    const int pacmanY = pacman->getY();
+    const AIController* controllers = entities.getControllers();
+    for (int i = 0; i < entities.size(); i++) {
+        if ((entities.getComponents(i) & COMPONENT_AI) == 0) continue;
+        Ghost& ghost = ghosts[controllers[i].ghost];
+        const int oldX = ghost.getX();
+        const int oldY = ghost.getY();
+        const GhostState oldState = ghost.getState();
+        const int speed = ghost.getSpeed();
+        for (int step = 0; step < speed; step++) {
+            ghost.move(pacmanX, pacmanY, *board, rng);
+            if (ghost.getX() == pacmanX && ghost.getY() == pacmanY) break;
+        }
+        if (ghost.getX() != oldX || ghost.getY() != oldY || ghost.getState() != oldState) {
+            moved = true;
         }
     }
-    renderGame();
+    return moved;
 }
 
-void Game::updateGhosts() {
-    for (auto& ghost : ghosts) {
-        ghost->move(pacman->getX(), pacman->getY(), *board);
+void Game::runTimers() {
+    TRACE_SCOPE("timers");
+    TimerEvent expired[TimerWheel::CAPACITY];
+    const int count = timers.advance(expired);
+    for (int i = 0; i < count; i++) {
+        onTimer(expired[i]);
     }
 }
 
+void Game::onTimer(const TimerEvent& event) {
+    switch (event.action) {
+    case TimerAction::POWER_END:
+        // Pacman e fantasmas acabam no mesmo tick
+        pacman->setPowered(false);
+        for (Ghost& ghost : ghosts) {
+            ghost.recover();
+        }
+        break;
+    case TimerAction::GHOST_RELEASE:
+        if (event.target < ghosts.size()) {
+            ghosts[event.target].release();
+        }
+        break;
+    case TimerAction::TRANSITION_END:
+        nextLevel();
+        break;
+    }
+    renderDirty = true;
+}
+
+void Game::startPower() {
+    pacman->setPowered(true);
+    for (int i = 0; i < ghosts.size(); i++) {
+        // Um fantasma na casa fica vulnervel e sai quando o poder acabar
+        if (ghosts[i].getState() == GhostState::WAITING) {
+            timers.cancel(releaseTimer(i));
+        }
+        ghosts[i].makeVulnerable();
+    }
+    timers.cancel(powerTimer);
+    powerTimer = timers.schedule(static_cast<uint32_t>(levelConfigs[currentLevel - 1].powerPelletDuration),
+        TimerAction::POWER_END, 0);
+}
+
+void Game::scheduleRelease(int ghostIndex, uint32_t delay) {
+    TimerHandle& timer = releaseTimer(ghostIndex);
+    timers.cancel(timer);
+    timer = timers.schedule(delay, TimerAction::GHOST_RELEASE, ghostIndex);
+}
+
+TimerHandle& Game::releaseTimer(int ghostIndex) {
+    return entities.getTimer(ghosts[ghostIndex].getEntity()).handle;
+}
+
+bool Game::updatePopups() {
+    // De trs para a frente: destroy() traz o ltimo para a posio atual
+    const bool hadPopups = !popups.empty();
+    for (int i = popups.size() - 1; i >= 0; i--) {
+        if (--popups[i].ticksLeft <= 0) {
+            popups.destroy(popups.handleAt(i));
+        }
+    }
+    return hadPopups;
+}
+
+void Game::showScorePopup(int x, int y, int points) {
+    // Com o pool cheio o popup perde-se:  s visual
+    popups.create(ScorePopup{ x, y, points, POPUP_TICKS });
+}
+
+// As colises s mudam o mundo (pellets, fantasmas, poder) e registam o
+// que aconteceu; pontos, vidas e o resto ficam para os subscritores
 void Game::checkCollisions() {
-    CollisionResult result = checkCollisionAt(pacman->getX(), pacman->getY());
+    TRACE_SCOPE("collisions");
+    const int x = pacman->getX();
+    const int y = pacman->getY();
+    CollisionResult result = checkCollisionAt(x, y);
 
     if (result.hitGhost) {
-        if (pacman->isPowerPelletActive()) {
-            incrementScore(200);
-            for (auto& ghost : ghosts) {
-                if (ghost->getX() == pacman->getX() && ghost->getY() == pacman->getY()) {
-                    ghost->respawn();
-                    break;
-                }
-            }
+        // Conta o estado do fantasma, no o do Pac-Man: um fantasma que saiu
+        // da casa ou recuperou durante o power pellet j  perigoso
+        if (result.ghostVulnerable) {
+            tickEvents.push(GameEventType::GHOST_EATEN, x, y, GHOST_POINTS, result.ghost);
+            ghosts[result.ghost].respawn();
+            scheduleRelease(result.ghost, GHOST_RESPAWN_TICKS);
         }
         else {
-            loseLife();
-            if (lives <= 0) {
-                state = GameState::GAME_OVER;
-            }
-            else {
-                resetLevel();
-            }
+            tickEvents.push(GameEventType::LIFE_LOST, x, y, 0);
         }
     }
 
-    if (result.hitPellet) {
-        board->removePellet(pacman->getX(), pacman->getY());
-        incrementScore(10);
+    if (result.hitPellet || result.hitPowerPellet) {
+        collectPellet(x, y);
     }
+}
 
-    if (result.hitPowerPellet) {
-        board->removePellet(pacman->getX(), pacman->getY());
-        incrementScore(50);
-        for (auto& ghost : ghosts) {
-            ghost->makeVulnerable();
-        }
+void Game::collectPellet(int x, int y) {
+    if (board->isPellet(x, y)) {
+        tickEvents.push(GameEventType::PELLET_EATEN, x, y, board->getSquare(x, y).points);
+        board->removePellet(x, y);
+    }
+    else if (board->isPowerPellet(x, y)) {
+        tickEvents.push(GameEventType::POWER_PELLET_EATEN, x, y, board->getSquare(x, y).points);
+        board->removePellet(x, y);
+        startPower();
     }
 }
 
 void Game::checkVictoryCondition() {
-    if (isLevelComplete()) {
-        state = GameState::LEVEL_COMPLETE;
-        addLevelBonus();
-        transitionTimer = 90;
-        showTransitionScreen();
+    // Uma vida perdida no mesmo tick manda: o nvel recomea
+    if (isLevelComplete() && !tickEvents.contains(GameEventType::LIFE_LOST)) {
+        tickEvents.push(GameEventType::LEVEL_COMPLETE, pacman->getX(), pacman->getY(),
+            levelConfigs[currentLevel - 1].bonusPoints);
     }
 }
 
-bool Game::isLevelComplete() {
-    return board->getRemainingPellets() == 0;
+void Game::dispatchEvents() {
+    if (tickEvents.empty()) return;
+    TRACE_SCOPE("events");
+    const GameEvent* events = tickEvents.begin();
+    const int count = tickEvents.size();
+    scoreEvents(events, count);
+    hudEvents(events, count);
+    telemetryEvents(events, count);
+    outcomeEvents(events, count);
 }
 
-Game::CollisionResult Game::checkCollisionAt(int x, int y) {
-    CollisionResult result = { false, false, false, false };
+void Game::scoreEvents(const GameEvent* events, int count) {
+    for (int i = 0; i < count; i++) {
+        score += events[i].points;
+        if (events[i].type == GameEventType::LIFE_LOST) lives--;
+    }
+}
+
+void Game::hudEvents(const GameEvent* events, int count) {
+    renderDirty = true;   // Pelo menos o HUD mudou
+    if (speculative) return;
+    for (int i = 0; i < count; i++) {
+        if (events[i].type == GameEventType::GHOST_EATEN) {
+            showScorePopup(events[i].x, events[i].y, events[i].points);
+        }
+    }
+}
+
+void Game::telemetryEvents(const GameEvent* events, int count) {
+    // Um tick previsto pode ser desfeito: s conta o que ficou
+    if (speculative) return;
+    uint64_t perType[static_cast<int>(GameEventType::COUNT)] = {};
+    for (int i = 0; i < count; i++) {
+        perType[static_cast<int>(events[i].type)]++;
+    }
+    const MetricCounter counters[] = {
+        MetricCounter::PELLETS_EATEN, MetricCounter::POWER_PELLETS_EATEN, MetricCounter::GHOSTS_EATEN,
+        MetricCounter::LIVES_LOST, MetricCounter::LEVELS_COMPLETED
+    };
+    static_assert(sizeof(counters) / sizeof(counters[0]) == static_cast<int>(GameEventType::COUNT),
+        "Um contador por tipo de evento");
+    for (int type = 0; type < static_cast<int>(GameEventType::COUNT); type++) {
+        if (perType[type] > 0) Metrics::add(counters[type], perType[type]);
+    }
+}
 
-    for (const auto& ghost : ghosts) {
-        if (ghost->getX() == x && ghost->getY() == y) {
-            result.hitGhost = true;
-            result.ghostVulnerable = ghost->isVulnerable();
+void Game::outcomeEvents(const GameEvent* events, int count) {
+    for (int i = 0; i < count; i++) {
+        switch (events[i].type) {
+        case GameEventType::LIFE_LOST:
+            if (lives <= 0) finishGame();
+            else resetLevel();
+            break;
+        case GameEventType::LEVEL_COMPLETE:
+            state = GameState::LEVEL_COMPLETE;
+            transitionTimer = timers.schedule(TRANSITION_TICKS, TimerAction::TRANSITION_END, 0);
+            break;
+        default:
             break;
         }
     }
+}
+
+bool Game::isLevelComplete() {
+    return board->getRemainingPellets() == 0;
+}
+
+Game::CollisionResult Game::checkCollisionAt(int x, int y) {
+    CollisionResult result = { false, -1, false, false, false };
+
+    // Sistema de colises: o primeiro fantasma na casa, pela ordem do mundo
+    EntityHandle hit;
+    if (entities.findAt(x, y, LAYER_GHOST, &hit, 1) > 0) {
+        result.hitGhost = true;
+        result.ghost = entities.getAI(hit).ghost;
+        result.ghostVulnerable = ghosts[result.ghost].isVulnerable();
+    }
 
     if (board->isPellet(x, y)) {
         result.hitPellet = true;
@@ -161,6 +534,23 @@ Game::CollisionResult Game::checkCollisionAt(int x, int y) {
 }
 
 void Game::handleInput(int input) {
+#ifdef PACMAN_PROFILE
+    // S mexe no ecr: no entra no replay nem passa pelos estados
+    if ((input == 't' || input == 'T') && !speculative) {
+        showProfiler = !showProfiler;
+        shownScreen = -1;   // Redesenho completo apaga o overlay
+        renderDirty = true;
+        return;
+    }
+#endif
+    PROFILE_PHASE(profiler, TickPhase::INPUT);
+
+    // S a entrada que afeta a simulao entra no replay
+    if (recorder && recorder->isRecording() && !speculative &&
+        (state == GameState::PLAYING || state == GameState::PAUSED)) {
+        recorder->recordInput(tickCount, input);
+    }
+
     switch (state) {
     case GameState::PLAYING:
         handlePlayingInput(input);
@@ -169,8 +559,38 @@ void Game::handleInput(int input) {
         handlePausedInput(input);
         break;
     case GameState::MENU:
-        gameMenu->handleInput(input);
+        // Na tabela de pontuaes qualquer tecla volta ao menu
+        if (showingHighScores) showingHighScores = false;
+        else gameMenu->handleInput(input);
         break;
+    default:
+        // Sem entrada: LEVEL_COMPLETE e TRANSITION seguem os timers, GAME_OVER  o fim
+        break;
+    }
+    renderDirty = true;
+}
+
+void Game::handleGhostInput(int input) {
+    if (state != GameState::PLAYING || controlledGhost < 0) return;
+
+    Ghost& ghost = ghosts[controlledGhost];
+    switch (input) {
+    case KEY_UP:    ghost.changeDirection(0, -1); break;
+    case KEY_DOWN:  ghost.changeDirection(0, 1); break;
+    case KEY_LEFT:  ghost.changeDirection(-1, 0); break;
+    case KEY_RIGHT: ghost.changeDirection(1, 0); break;
+    default:        return;
+    }
+    renderDirty = true;
+}
+
+void Game::setGhostPlayer(int ghostIndex) {
+    if (ghostIndex >= ghosts.size()) {
+        throw std::runtime_error("Fantasma inexistente");
+    }
+    controlledGhost = ghostIndex < 0 ? -1 : ghostIndex;
+    for (int i = 0; i < ghosts.size(); i++) {
+        ghosts[i].setPlayerControlled(i == controlledGhost);
     }
 }
 
@@ -204,13 +624,14 @@ void Game::handlePausedInput(int input) {
 void Game::pauseGame() {
     if (state == GameState::PLAYING) {
         state = GameState::PAUSED;
-        showPauseMenu();
+        renderDirty = true;
     }
 }
 
 void Game::resumeGame() {
     if (state == GameState::PAUSED) {
         state = GameState::PLAYING;
+        renderDirty = true;
     }
 }
 
@@ -222,103 +643,279 @@ void Game::nextLevel() {
         state = GameState::PLAYING;
     }
     else {
-        showGameOver();
+        finishGame();
     }
 }
 
+void Game::finishGame() {
+    state = GameState::GAME_OVER;
+    // Um fim de jogo previsto pode ainda ser desfeito por rollback
+    if (!speculative) {
+        Metrics::add(MetricCounter::GAMES_COMPLETED);
+        Metrics::observe(MetricHistogram::GAME_LEVEL, currentLevel);
+        highscoreManager->addScore("Player", score);
+    }
+    if (recorder && recorder->isRecording() && !speculative) {
+        recorder->endSession(tickCount, score, lives, currentLevel);
+    }
+    renderDirty = true;
+}
+
 void Game::resetLevel() {
     board->resetBoard();
-    pacman->respawn();
-    for (auto& ghost : ghosts) {
-        ghost->respawn();
-    }
+    spawnEntities();
 }
 
 void Game::updateDifficulty() {
     const auto& config = levelConfigs[currentLevel - 1];
-    for (auto& ghost : ghosts) {
-        ghost->setSpeed(config.ghostSpeed);
+    for (Ghost& ghost : ghosts) {
+        ghost.setSpeed(config.ghostSpeed);
     }
     pacman->setSpeed(config.pacmanSpeed);
+    pacman->setTurnBuffer(config.turnBufferTicks);
 }
 
-void Game::incrementScore(int points) {
-    score += points;
+
+
+
+
+void Game::render() {
+    TRACE_SCOPE("render");
+    {
+        PROFILE_PHASE(profiler, TickPhase::RENDER);
+        renderGame();
+    }
+    renderDirty = false;
 }
 
-void Game::addLevelBonus() {
-    score += levelConfigs[currentLevel - 1].bonusPoints;
+void Game::saveSnapshot(GameSnapshot& out) const {
+    // Zera tudo (incluindo reserved) para o bloco ser determinstico
+    std::memset(&out, 0, sizeof(out));
+    saveFields(out);
+    board->savePellets(out.pelletPlane, out.powerPelletPlane, GameSnapshot::PLANE_BYTES);
 }
 
-void Game::loseLife() {
-    lives--;
+void Game::updateSnapshot(GameSnapshot& snapshot) const {
+    saveFields(snapshot);
+    board->updatePellets(snapshot.pelletPlane, snapshot.powerPelletPlane, GameSnapshot::PLANE_BYTES);
 }
 
+void Game::saveFields(GameSnapshot& out) const {
+    out.version = GameSnapshot::VERSION;
+    out.tickCount = tickCount;
+    out.seed = rng.getSeed();
+    out.rngState = rng.getState();
+    out.rngDraws = rng.getDraws();
+
+    out.score = score;
+    out.lives = static_cast<int16_t>(lives);
+    out.level = static_cast<int16_t>(currentLevel);
+    out.transitionTimer = static_cast<int16_t>(timers.getRemaining(transitionTimer));
+    out.state = static_cast<uint8_t>(state);
+    out.isGameOver = isGameOver ? 1 : 0;
+
+    pacman->saveState(out.pacman);
+    out.pacman.powerTimer = static_cast<int16_t>(timers.getRemaining(powerTimer));
+
+    // O pool tem capacidade MAX_GHOSTS: cabem sempre todos
+    out.ghostCount = static_cast<uint8_t>(ghosts.size());
+    for (int i = 0; i < out.ghostCount; i++) {
+        ghosts[i].saveState(out.ghosts[i]);
+        // Vulnervel: o fim do poder, partilhado; na casa: a sua sada
+        const TimerHandle timer = ghosts[i].getState() == GhostState::VULNERABLE ? powerTimer :
+            entities.getTimer(ghosts[i].getEntity()).handle;
+        out.ghosts[i].stateTimer = static_cast<int16_t>(timers.getRemaining(timer));
+    }
+
+    out.remainingPellets = static_cast<int16_t>(board->getRemainingPellets());
+}
+
+void Game::restoreSnapshot(const GameSnapshot& in) {
+    if (in.version != GameSnapshot::VERSION) {
+        throw std::runtime_error("Snapshot de outra versao");
+    }
+
+    tickCount = in.tickCount;
+    rng.restore(in.seed, in.rngState, in.rngDraws);
+    seed = in.seed;
 
+    score = in.score;
+    lives = in.lives;
+    currentLevel = in.level;
+    state = static_cast<GameState>(in.state);
+    isGameOver = in.isGameOver != 0;
 
+    pacman->restoreState(in.pacman);
+    for (int i = 0; i < in.ghostCount && i < ghosts.size(); i++) {
+        ghosts[i].restoreState(in.ghosts[i]);
+    }
+
+    // A roda recomea com o que faltava a cada timer
+    timers.clear();
+    if (in.transitionTimer > 0) {
+        transitionTimer = timers.schedule(static_cast<uint32_t>(in.transitionTimer), TimerAction::TRANSITION_END, 0);
+    }
+    if (in.pacman.powerTimer > 0) {
+        powerTimer = timers.schedule(static_cast<uint32_t>(in.pacman.powerTimer), TimerAction::POWER_END, 0);
+    }
+    for (int i = 0; i < in.ghostCount && i < ghosts.size(); i++) {
+        if (in.ghosts[i].state == static_cast<uint8_t>(GhostState::WAITING) && in.ghosts[i].stateTimer > 0) {
+            releaseTimer(i) = timers.schedule(static_cast<uint32_t>(in.ghosts[i].stateTimer),
+                TimerAction::GHOST_RELEASE, i);
+        }
+    }
+
+    board->restorePellets(in.pelletPlane, in.powerPelletPlane, GameSnapshot::PLANE_BYTES);
+    renderDirty = true;
+}
 
 void Game::renderGame() {
+    if (!screen) {
+        int rows, columns;
+        getmaxyx(stdscr, rows, columns);
+        screen.reset(new FrameRenderer(columns, rows, createScreenBackend(rendererKind, columns, rows)));
+        if (renderThreaded && rendererKind == RendererKind::RAW_ANSI) {
+            screen->startThread();
+        }
+    }
+
+    // Os ecrs de texto so recompostos por inteiro no frame ( s memria);
+    // o present() compara com o frame anterior e envia s a diferena
+    const int screenId = state == GameState::MENU && showingHighScores ? -2 : static_cast<int>(state);
+    const bool newScreen = screenId != shownScreen;
+    shownScreen = screenId;
+
     switch (state) {
-    case GameState::PLAYING:
-        board->draw();
-        pacman->draw();
-        for (const auto& ghost : ghosts) {
-            ghost->draw();
+    case GameState::MENU:
+        screen->clear();
+        if (showingHighScores) {
+            TRACE_SCOPE("highscores");
+            showHighScore();
+        }
+        else {
+            TRACE_SCOPE("menu");
+            gameMenu->display(*screen);
         }
-        drawHUD();
+        break;
+    case GameState::PLAYING:
+        drawPlaying(newScreen);
         break;
     case GameState::PAUSED:
+        screen->clear();
         showPauseMenu();
         break;
+    case GameState::LEVEL_COMPLETE:
     case GameState::TRANSITION:
+        screen->clear();
         showTransitionScreen();
         break;
     case GameState::GAME_OVER:
+        screen->clear();
         showGameOver();
         break;
     }
-    refresh();
+    screen->present(tickCount);
+}
+
+void Game::drawPlaying(bool fullBoard) {
+    if (fullBoard || board->getDirtyCount() < 0) {
+        screen->clear();
+        board->draw(*screen);
+    }
+    else {
+        // Repe as casas onde as entidades estavam e as que mudaram (pellets comidos)
+        for (const DrawnEntity& drawn : drawnEntities) {
+            board->drawCell(*screen, drawn.x, drawn.y);
+        }
+        const uint16_t* cells = board->getDirtyCells();
+        for (int i = 0; i < board->getDirtyCount(); i++) {
+            board->drawCell(*screen, cells[i] % board->getWidth(), cells[i] / board->getWidth());
+        }
+    }
+    board->clearDirtyCells();
+
+    drawnEntities.clear();
+    // Os popups ficam por baixo: o Pacman e os fantasmas desenham-se por cima
+    for (const ScorePopup& popup : popups) {
+        const int x = std::max(0, std::min(popup.x - 1, board->getWidth() - 3));
+        const int length = screen->printf(x, popup.y, 6, STYLE_BOLD, "%d", popup.points);
+        for (int i = 0; i < length; i++) {
+            drawnEntities.push_back({ x + i, popup.y });
+        }
+    }
+    // Sistema de desenho: o Pacman e depois os fantasmas (ordem do mundo)
+    Position drawn[EntityWorld::CAPACITY];
+    const int drawnCount = entities.render(*screen, drawn);
+    for (int i = 0; i < drawnCount; i++) {
+        drawnEntities.push_back({ drawn[i].x, drawn[i].y });
+    }
+    drawHUD();
+#ifdef PACMAN_PROFILE
+    if (showProfiler) drawProfiler();
+#endif
 }
 
 void Game::drawHUD() {
-    mvprintw(0, 0, "Nvel: %d", currentLevel);
-    mvprintw(0, 20, "Pontos: %d", score);
-    mvprintw(0, 40, "Vidas: %d", lives);
+    // Largura fixa: um nmero mais curto apaga os dgitos do anterior
+    screen->printf(0, 0, 0, STYLE_NONE, "Nvel: %-3d", currentLevel);
+    screen->printf(20, 0, 0, STYLE_NONE, "Pontos: %-7d", score);
+    screen->printf(40, 0, 0, STYLE_NONE, "Vidas: %-2d", lives);
+}
+
+#ifdef PACMAN_PROFILE
+void Game::drawProfiler() {
+    // Recalculado a cada 10 ticks: legvel e sem ordenar o anel em cada frame
+    if (profileSummaryTick == 0 || tickCount - profileSummaryTick >= 10) {
+        profileSummary = profiler.summarize();
+        profileSummaryTick = tickCount ? tickCount : 1;
+    }
+
+    const int x = board->getWidth() + 2;
+    int y = 2;
+    screen->print(x, y, "fase (us)", 0, STYLE_BOLD);
+    screen->print(x + 11, y, "   p50    p99", 0, STYLE_BOLD);
+    for (int phase = 0; phase < TickProfiler::PHASES; phase++) {
+        const PhaseTiming& timing = profileSummary.phases[phase];
+        y++;
+        screen->clearArea(x, y, 11, 1);
+        screen->print(x, y, TickProfiler::phaseName(static_cast<TickPhase>(phase)));
+        screen->printf(x + 11, y, 0, STYLE_NONE, "%6.1f %6.1f", timing.p50Us, timing.p99Us);
+    }
+    y++;
+    screen->print(x, y, "tick");
+    screen->printf(x + 11, y, 0, STYLE_NONE, "%6.1f %6.1f", profileSummary.total.p50Us,
+        profileSummary.total.p99Us);
+    y += 2;
+    screen->printf(x, y, 0, STYLE_NONE, "oramento %5.1f%% (%d ticks)",
+        profileSummary.budgetUsed * 100.0, profileSummary.ticks);
 }
+#endif
 
 void Game::showGameOver() {
-    clear();
-    mvprintw(10, 30, "GAME OVER");
-    mvprintw(12, 30, "Pontuao Final: %d", score);
-    highscoreManager->addScore("Player", score);
-    refresh();
+    screen->print(30, 10, "GAME OVER");
+    screen->printf(30, 12, 0, STYLE_NONE, "Pontuao Final: %d", score);
 }
 
 void Game::showTransitionScreen() {
-    clear();
-    mvprintw(10, 30, "Nvel %d Completo!", currentLevel);
-    mvprintw(12, 30, "Bnus: %d pontos", levelConfigs[currentLevel - 1].bonusPoints);
-    mvprintw(14, 30, "Prximo nvel em %d...", transitionTimer / 30);
-    refresh();
+    screen->printf(30, 10, 0, STYLE_NONE, "Nvel %d Completo!", currentLevel);
+    screen->printf(30, 12, 0, STYLE_NONE, "Bnus: %d pontos", levelConfigs[currentLevel - 1].bonusPoints);
+    screen->printf(30, 14, 0, STYLE_NONE, "Prximo nvel em %d...",
+        static_cast<int>(timers.getRemaining(transitionTimer) / 30));
 }
 
 void Game::showPauseMenu() {
-    clear();
-    mvprintw(10, 35, "JOGO PAUSADO");
-    mvprintw(12, 30, "Pressione P para continuar");
-    mvprintw(14, 30, "Nvel atual: %d", currentLevel);
-    mvprintw(15, 30, "Pontuao: %d", score);
-    refresh();
+    screen->print(35, 10, "JOGO PAUSADO");
+    screen->print(30, 12, "Pressione P para continuar");
+    screen->printf(30, 14, 0, STYLE_NONE, "Nvel atual: %d", currentLevel);
+    screen->printf(30, 15, 0, STYLE_NONE, "Pontuao: %d", score);
 }
 
 void Game::showHighScore() {
-    auto scores = highscoreManager->getTopScores();
-    clear();
+    const auto& scores = highscoreManager->getTopScores();
     int y = 5;
-    mvprintw(3, 30, "MAIORES PONTUAES");
+    screen->print(30, 3, "MAIORES PONTUAES");
     for (const auto& entry : scores) {
-        mvprintw(y++, 25, "%s: %d", entry.playerName.c_str(), entry.score);
+        screen->printf(25, y++, 0, STYLE_NONE, "%s: %d", entry.playerName.c_str(), entry.score);
     }
-    refresh();
-    getch();
+    screen->print(25, y + 1, "Pressione uma tecla para voltar");
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "game_loop.h"
+#include "game.h"
+#include "trace.h"
+#include "flight_recorder.h"
+#include "metrics.h"
+#include "allocation_tracker.h"
+#include <curses.h>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+GameLoop::GameLoop(Game& game, const GameLoopConfig& config)
+    : game(game),
+    driver(nullptr),
+    input(nullptr),
+    flightRecorder(nullptr),
+    config(config),
+    running(false),
+    hasLastTick(false),
+    intervalMean(0),
+    intervalM2(0)
+{
+    // Valores invlidos caem para os padres
+    if (this->config.ticksPerSecond <= 0) this->config.ticksPerSecond = 10;
+    if (this->config.maxFramesPerSecond <= 0) this->config.maxFramesPerSecond = 60;
+    if (this->config.maxTicksPerFrame <= 0) this->config.maxTicksPerFrame = 1;
+
+    tickStep = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(1000000000LL / this->config.ticksPerSecond));
+    renderStep = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(1000000000LL / this->config.maxFramesPerSecond));
+}
+
+void GameLoop::run() {
+    running = true;
+
+    Clock::time_point previous = Clock::now();
+    Clock::time_point nextRender = previous;
+    Clock::duration accumulator = Clock::duration::zero();
+
+    while (running && !game.shouldQuit()) {
+        Clock::time_point now = Clock::now();
+        accumulator += now - previous;
+        previous = now;
+
+        if (!input) pollInput();
+        Tracer::service();   // Despejo pedido por SIGUSR1 ou por um anel quase cheio
+
+        // Consome o tempo acumulado em ticks de durao fixa
+        int ticksThisFrame = 0;
+        while (accumulator >= tickStep && ticksThisFrame < config.maxTicksPerFrame) {
+            if (input) drainInput();
+            runTick();
+            accumulator -= tickStep;
+            ticksThisFrame++;
+            stats.ticks++;
+            recordTickTiming(now);
+        }
+
+        // Se o host ficou parado demasiado tempo, descarta o atraso em vez de
+        // acelerar o jogo para o recuperar
+        if (accumulator >= tickStep) {
+            stats.droppedTicks += accumulator / tickStep;
+            accumulator %= tickStep;
+        }
+
+        // Render limitado e s quando algo mudou
+        if (now >= nextRender) {
+            if (game.needsRender()) {
+                const bool wasPlaying = game.getState() == GameState::PLAYING;
+                const AllocationScope allocations;
+                game.render();
+                checkAllocations("render", wasPlaying, allocations.getAllocations());
+                stats.renders++;
+            }
+            else {
+                stats.skippedRenders++;
+            }
+            nextRender = now + renderStep;
+        }
+
+        // Dorme at ao prximo evento (tick ou render), sem ocupar a CPU
+        Clock::time_point nextTick = now + (tickStep - accumulator);
+        std::this_thread::sleep_until(std::min(nextTick, nextRender));
+    }
+
+    running = false;
+}
+
+void GameLoop::stop() {
+    running = false;
+}
+
+void GameLoop::pollInput() {
+    // nodelay(): getch() devolve ERR logo que no h mais teclas
+    int ch;
+    while ((ch = getch()) != ERR) {
+        applyInput(ch);
+    }
+}
+
+void GameLoop::drainInput() {
+    InputEvent event;
+    const Clock::time_point tickStart = Clock::now();
+    while (input->pop(event)) {
+        applyInput(event.key);
+        inputLatency.record(std::chrono::duration<double, std::milli>(tickStart - event.arrived).count());
+    }
+}
+
+void GameLoop::runTick() {
+    const Clock::time_point start = Clock::now();
+    try {
+        const bool wasPlaying = game.getState() == GameState::PLAYING;
+        const AllocationScope allocations;
+        if (driver) driver->tick();
+        else game.updateGameState();
+        checkAllocations("tick", wasPlaying, allocations.getAllocations());
+    }
+    catch (const std::exception& e) {
+        // Os ticks at aqui ficam no disco antes de a exceo subir
+        if (flightRecorder) flightRecorder->dump("exception", e.what());
+        throw;
+    }
+    const Clock::duration elapsed = Clock::now() - start;
+
+    Metrics::add(MetricCounter::TICKS);
+    Metrics::observe(MetricHistogram::TICK_SECONDS, std::chrono::duration<double>(elapsed).count());
+    if (flightRecorder) {
+        flightRecorder->recordTick(game, static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+}
+
+void GameLoop::checkAllocations(const char* phase, bool wasPlaying, uint64_t allocations) const {
+    // S o regime estvel: comear ou acabar uma partida (pontuaes, menus) pode alocar
+    if (!AllocationTracker::isEnabled() || allocations == 0 || !wasPlaying ||
+        game.getState() != GameState::PLAYING) {
+        return;
+    }
+    throw std::runtime_error(std::string(phase) + " em PLAYING fez " + std::to_string(allocations) +
+        " alocaes (tick " + std::to_string(game.getTickCount()) + ")");
+}
+
+void GameLoop::applyInput(int key) {
+    if (flightRecorder) {
+        if (key == FlightRecorder::DUMP_KEY) {
+            flightRecorder->dump("hotkey");
+            return;
+        }
+        flightRecorder->recordInput(key);
+    }
+    if (driver) driver->handleInput(key);
+    else game.handleInput(key);
+}
+
+void GameLoop::recordTickTiming(Clock::time_point now) {
+    // S o primeiro tick de cada frame tem um intervalo real; os restantes
+    // so ticks de recuperao e entram com intervalo zero, o que tambm
+    // conta como jitter
+    if (hasLastTick) {
+        double intervalMs = std::chrono::duration<double, std::milli>(now - lastTickTime).count();
+        double idealMs = std::chrono::duration<double, std::milli>(tickStep).count();
+
+        long long n = stats.ticks - 1;
+        double delta = intervalMs - intervalMean;
+        intervalMean += delta / n;
+        intervalM2 += delta * (intervalMs - intervalMean);
+
+        stats.meanTickIntervalMs = intervalMean;
+        stats.jitterMs = n > 1 ? std::sqrt(intervalM2 / (n - 1)) : 0.0;
+        stats.maxJitterMs = std::max(stats.maxJitterMs, std::fabs(intervalMs - idealMs));
+    }
+    lastTickTime = now;
+    hasLastTick = true;
+}
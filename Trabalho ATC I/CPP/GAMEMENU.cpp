@@ -3,10 +3,11 @@
 #define GAME_MENU_H
 
 #include <string>
-#include <vector>
 #include <functional>
+#include <cstdint>
 #include <curses.h>
-#include "game_object.h"
+
+class FrameRenderer;
 
 // Define as direções possíveis no menu
 enum class MenuNavigation {
@@ -16,22 +17,47 @@ enum class MenuNavigation {
     ESCAPE  // Tecla Esc
 };
 
-// Estrutura para representar cada opção do menu
+// O que uma opção faz: a navegação entre submenus é do próprio menu,
+// o resto passa às MenuActions do dono
+enum class MenuCommand : uint8_t {
+    NONE,             // Opção só informativa (ou ainda sem lógica)
+    NEW_GAME,
+    RESUME,
+    RESTART_LEVEL,
+    SHOW_HIGHSCORES,
+    QUIT,
+    MAIN_MENU,
+    CONFIG_MENU,
+    CONTROLS_MENU,
+    CONFIRM_EXIT
+};
+
+// Estrutura para representar cada opção do menu. Os menus são tabelas
+// estáticas: mudar de menu só troca um ponteiro, sem construir strings
+// nem std::function a cada show*Menu()
 struct MenuItem {
-    std::string label;           // Texto da opção
-    std::string description;     // Descrição/explicação da opção
-    std::function<void()> action;// Função a ser executada
+    const char* label;           // Texto da opção
+    const char* description;     // Descrição/explicação da opção
+    MenuCommand command;         // O que a opção faz
     bool isEnabled;              // Se a opção está habilitada
+};
 
-    MenuItem(const std::string& lbl, const std::string& desc,
-        std::function<void()> act, bool enabled = true)
-        : label(lbl), description(desc), action(act), isEnabled(enabled) {}
+// Ações que o dono do menu liga às opções. O menu não conhece o Game nem
+// termina o processo: "Sair" só avisa quem o criou.
+struct MenuActions {
+    std::function<void()> newGame;
+    std::function<void()> resume;
+    std::function<void()> restartLevel;
+    std::function<void()> showHighScores;
+    std::function<void()> quit;
 };
 
 class GameMenu {
 private:
     std::string title;                    // Título do menu
-    std::vector<MenuItem> menuItems;      // Lista de opções do menu
+    const MenuItem* menuItems;            // Opções do menu atual (tabela estática)
+    int itemCount;                        // Número de opções
+    MenuActions actions;                  // Ligadas pelo dono do menu
     int selectedOption;                   // Índice da opção selecionada
     bool isActive;                        // Se o menu está ativo
     bool showHelp;                        // Se mostra descrições das opções
@@ -46,15 +72,11 @@ public:
     // Construtor: inicializa o menu
     GameMenu(const std::string& menuTitle);
 
-    // Adiciona uma nova opção ao menu
-    void addMenuItem(const std::string& label,
-        const std::string& description,
-        std::function<void()> action,
-        bool enabled = true);
+    void setActions(const MenuActions& newActions) { actions = newActions; }
 
     // Funções principais do menu
-    void display();                           // Mostra o menu na tela
-    void handleInput(int key);                // Processa entrada do usuário
+    void display(FrameRenderer& screen);      // Compõe o menu no frame (só no render)
+    void handleInput(int key);                // Processa entrada do usuário (não desenha)
     void selectCurrentOption();               // Executa opção selecionada
 
     // Menus específicos
@@ -66,25 +88,72 @@ public:
 
 private:
     // Funções auxiliares de desenho
-    void drawFrame();                         // Desenha borda do menu
-    void drawTitle();                         // Desenha título
-    void drawOptions();                       // Desenha opções
-    void drawDescription();                   // Desenha descrição da opção atual
-    void drawControls();                      // Desenha teclas de controle
-    void clearMenuArea();                     // Limpa área do menu
+    void drawFrame(FrameRenderer& screen);    // Desenha borda do menu
+    void drawTitle(FrameRenderer& screen);    // Desenha título
+    void drawOptions(FrameRenderer& screen);  // Desenha opções
+    void drawDescription(FrameRenderer& screen); // Desenha descrição da opção atual
+    void drawControls(FrameRenderer& screen); // Desenha teclas de controle
+    void clearMenuArea(FrameRenderer& screen); // Limpa área do menu (no frame, não no terminal)
 
     // Funções de navegação
     void moveSelection(MenuNavigation dir);   // Move seleção
     void updateSelection();                   // Atualiza opção selecionada
+    void run(const std::function<void()>& action); // Executa uma ação, se ligada
+    void setItems(const MenuItem* items, int count); // Troca o menu atual
 };
 
 #endif
 
 // game_menu.cpp
 #include "game_menu.h"
+#include "frame_renderer.h"
+
+namespace {
+    const MenuItem MAIN_MENU_ITEMS[] = {
+        { "Novo Jogo", "Inicia uma nova partida do Pac-Man", MenuCommand::NEW_GAME, true },
+        { "Continuar", "Retorna ao jogo em andamento", MenuCommand::RESUME, true },
+        { "Controles", "Mostra os controles do jogo", MenuCommand::CONTROLS_MENU, true },
+        { "Configurações", "Ajusta configurações do jogo", MenuCommand::CONFIG_MENU, true },
+        { "Pontuações", "Mostra as melhores pontuações", MenuCommand::SHOW_HIGHSCORES, true },
+        { "Sair", "Sair do jogo (salva progresso)", MenuCommand::CONFIRM_EXIT, true }
+    };
+
+    const MenuItem PAUSE_MENU_ITEMS[] = {
+        { "Continuar", "Retorna ao jogo", MenuCommand::RESUME, true },
+        { "Reiniciar Nível", "Recomeça o nível atual", MenuCommand::RESTART_LEVEL, true },
+        { "Configurações", "Ajusta configurações do jogo", MenuCommand::CONFIG_MENU, true },
+        { "Menu Principal", "Volta ao menu principal", MenuCommand::MAIN_MENU, true }
+    };
+
+    // Dificuldade, som e música ainda não têm lógica
+    const MenuItem CONFIG_MENU_ITEMS[] = {
+        { "Dificuldade", "Ajusta a dificuldade do jogo", MenuCommand::NONE, true },
+        { "Som: Ligado", "Liga/Desliga efeitos sonoros", MenuCommand::NONE, true },
+        { "Música: Ligada", "Liga/Desliga música de fundo", MenuCommand::NONE, true },
+        { "Voltar", "Retorna ao menu anterior", MenuCommand::MAIN_MENU, true }
+    };
+
+    const MenuItem CONTROLS_MENU_ITEMS[] = {
+        { "Movimento", "Setas direcionais - Move o Pac-Man", MenuCommand::NONE, false },
+        { "Pausa", "P - Pausa o jogo", MenuCommand::NONE, false },
+        { "Power Pellet", "Quando ativo, permite comer fantasmas", MenuCommand::NONE, false },
+        { "Voltar", "Retorna ao menu anterior", MenuCommand::MAIN_MENU, true }
+    };
+
+    // Quem fecha a interface e termina é o dono do menu (ex.: GameLoop)
+    const MenuItem CONFIRM_EXIT_ITEMS[] = {
+        { "Sim", "Confirma e sai do jogo", MenuCommand::QUIT, true },
+        { "Não", "Retorna ao menu anterior", MenuCommand::MAIN_MENU, true }
+    };
+
+    template <int N>
+    int countOf(const MenuItem (&)[N]) { return N; }
+}
 
 GameMenu::GameMenu(const std::string& menuTitle)
     : title(menuTitle),
+    menuItems(nullptr),
+    itemCount(0),
     selectedOption(0),
     isActive(false),
     showHelp(true),
@@ -98,155 +167,89 @@ GameMenu::GameMenu(const std::string& menuTitle)
 }
 
 void GameMenu::showMainMenu() {
-    menuItems.clear();
-    addMenuItem("Novo Jogo", "Inicia uma nova partida do Pac-Man",
-        []() { /* Lógica de novo jogo */ });
-
-    addMenuItem("Continuar", "Retorna ao jogo em andamento",
-        []() { /* Lógica de continuar */ });
-
-    addMenuItem("Controles", "Mostra os controles do jogo",
-        [this]() { showControlsMenu(); });
-
-    addMenuItem("Configurações", "Ajusta configurações do jogo",
-        [this]() { showConfigMenu(); });
-
-    addMenuItem("Pontuações", "Mostra as melhores pontuações",
-        []() { /* Lógica de pontuações */ });
-
-    addMenuItem("Sair", "Sair do jogo (salva progresso)",
-        [this]() { showConfirmExit(); });
+    setItems(MAIN_MENU_ITEMS, countOf(MAIN_MENU_ITEMS));
 }
 
 void GameMenu::showPauseMenu() {
-    menuItems.clear();
-    addMenuItem("Continuar", "Retorna ao jogo",
-        []() { /* Lógica de continuar */ });
-
-    addMenuItem("Reiniciar Nível", "Recomeça o nível atual",
-        []() { /* Lógica de reiniciar */ });
-
-    addMenuItem("Configurações", "Ajusta configurações do jogo",
-        [this]() { showConfigMenu(); });
-
-    addMenuItem("Menu Principal", "Volta ao menu principal",
-        [this]() { showMainMenu(); });
+    setItems(PAUSE_MENU_ITEMS, countOf(PAUSE_MENU_ITEMS));
 }
 
 void GameMenu::showConfigMenu() {
-    menuItems.clear();
-    addMenuItem("Dificuldade", "Ajusta a dificuldade do jogo",
-        []() { /* Lógica de dificuldade */ });
-
-    addMenuItem("Som: Ligado", "Liga/Desliga efeitos sonoros",
-        []() { /* Lógica de som */ });
-
-    addMenuItem("Música: Ligada", "Liga/Desliga música de fundo",
-        []() { /* Lógica de música */ });
-
-    addMenuItem("Voltar", "Retorna ao menu anterior",
-        [this]() { showMainMenu(); });
+    setItems(CONFIG_MENU_ITEMS, countOf(CONFIG_MENU_ITEMS));
 }
 
 void GameMenu::showControlsMenu() {
-    menuItems.clear();
-    addMenuItem("Movimento", "Setas direcionais - Move o Pac-Man",
-        nullptr, false);
-
-    addMenuItem("Pausa", "P - Pausa o jogo",
-        nullptr, false);
-
-    addMenuItem("Power Pellet", "Quando ativo, permite comer fantasmas",
-        nullptr, false);
-
-    addMenuItem("Voltar", "Retorna ao menu anterior",
-        [this]() { showMainMenu(); });
+    setItems(CONTROLS_MENU_ITEMS, countOf(CONTROLS_MENU_ITEMS));
 }
 
 void GameMenu::showConfirmExit() {
-    menuItems.clear();
-    addMenuItem("Sim", "Confirma e sai do jogo",
-        []() { endwin(); exit(0); });
+    setItems(CONFIRM_EXIT_ITEMS, countOf(CONFIRM_EXIT_ITEMS));
+}
 
-    addMenuItem("Não", "Retorna ao menu anterior",
-        [this]() { showMainMenu(); });
+void GameMenu::setItems(const MenuItem* items, int count) {
+    menuItems = items;
+    itemCount = count;
 }
 
-void GameMenu::display() {
-    clearMenuArea();
-    drawFrame();
-    drawTitle();
-    drawOptions();
+void GameMenu::display(FrameRenderer& screen) {
+    // Recompõe tudo no frame; ao terminal só chega o que mudou
+    // (normalmente a opção selecionada e a descrição)
+    clearMenuArea(screen);
+    drawFrame(screen);
+    drawTitle(screen);
+    drawOptions(screen);
     if (showHelp) {
-        drawDescription();
+        drawDescription(screen);
     }
-    drawControls();
-    refresh();
+    drawControls(screen);
 }
 
-void GameMenu::drawFrame() {
+void GameMenu::drawFrame(FrameRenderer& screen) {
     // Desenha borda do menu
     for (int y = startY; y < startY + height; y++) {
-        mvaddch(y, startX, ACS_VLINE);
-        mvaddch(y, startX + width, ACS_VLINE);
+        screen.putLine(startX, y, LineGlyph::VERTICAL);
+        screen.putLine(startX + width, y, LineGlyph::VERTICAL);
     }
 
     for (int x = startX; x < startX + width; x++) {
-        mvaddch(startY, x, ACS_HLINE);
-        mvaddch(startY + height, x, ACS_HLINE);
+        screen.putLine(x, startY, LineGlyph::HORIZONTAL);
+        screen.putLine(x, startY + height, LineGlyph::HORIZONTAL);
     }
 
     // Cantos
-    mvaddch(startY, startX, ACS_ULCORNER);
-    mvaddch(startY, startX + width, ACS_URCORNER);
-    mvaddch(startY + height, startX, ACS_LLCORNER);
-    mvaddch(startY + height, startX + width, ACS_LRCORNER);
+    screen.putLine(startX, startY, LineGlyph::UPPER_LEFT);
+    screen.putLine(startX + width, startY, LineGlyph::UPPER_RIGHT);
+    screen.putLine(startX, startY + height, LineGlyph::LOWER_LEFT);
+    screen.putLine(startX + width, startY + height, LineGlyph::LOWER_RIGHT);
 }
 
-void GameMenu::drawTitle() {
-    attron(A_BOLD | COLOR_PAIR(6));
-    mvprintw(startY + 1, startX + (width - title.length()) / 2, "%s", title.c_str());
-    attroff(A_BOLD | COLOR_PAIR(6));
+void GameMenu::drawTitle(FrameRenderer& screen) {
+    screen.print(startX + (width - static_cast<int>(title.length())) / 2, startY + 1,
+        title.c_str(), 6, STYLE_BOLD);
 }
 
-void GameMenu::drawOptions() {
+void GameMenu::drawOptions(FrameRenderer& screen) {
     int y = startY + 3;
-    for (size_t i = 0; i < menuItems.size(); i++) {
-        if (i == selectedOption) {
-            attron(A_REVERSE);
-        }
-        if (!menuItems[i].isEnabled) {
-            attron(COLOR_PAIR(8)); // Cor para opções desabilitadas
-        }
-
-        mvprintw(y, startX + 2, "%s", menuItems[i].label.c_str());
-
-        if (!menuItems[i].isEnabled) {
-            attroff(COLOR_PAIR(8));
-        }
-        if (i == selectedOption) {
-            attroff(A_REVERSE);
-        }
+    for (int i = 0; i < itemCount; i++) {
+        const uint8_t style = i == selectedOption ? STYLE_REVERSE : STYLE_NONE;
+        const uint8_t color = menuItems[i].isEnabled ? 0 : 8; // Cor para opções desabilitadas
+        screen.print(startX + 2, y, menuItems[i].label, color, style);
         y += 2;
     }
 }
 
-void GameMenu::drawDescription() {
-    if (selectedOption >= 0 && selectedOption < static_cast<int>(menuItems.size())) {
-        const auto& item = menuItems[selectedOption];
-        if (!item.description.empty()) {
-            attron(COLOR_PAIR(6));
-            mvprintw(startY + height - 3, startX + 2, "%s", item.description.c_str());
-            attroff(COLOR_PAIR(6));
+void GameMenu::drawDescription(FrameRenderer& screen) {
+    if (selectedOption >= 0 && selectedOption < itemCount) {
+        const MenuItem& item = menuItems[selectedOption];
+        if (item.description[0] != '\0') {
+            screen.print(startX + 2, startY + height - 3, item.description, 6);
         }
     }
 }
 
-void GameMenu::drawControls() {
-    attron(COLOR_PAIR(6));
-    mvprintw(startY + height - 1, startX + 2,
-        "↑↓: Selecionar   Enter: Confirmar   Esc: Voltar");
-    attroff(COLOR_PAIR(6));
+void GameMenu::drawControls(FrameRenderer& screen) {
+    screen.print(startX + 2, startY + height - 1,
+        "↑↓: Selecionar   Enter: Confirmar   Esc: Voltar", 6);
 }
 
 void GameMenu::handleInput(int key) {
@@ -266,20 +269,19 @@ void GameMenu::handleInput(int key) {
         }
         break;
     }
-    display();
 }
 
 void GameMenu::moveSelection(MenuNavigation dir) {
     switch (dir) {
     case MenuNavigation::UP:
         do {
-            selectedOption = (selectedOption - 1 + menuItems.size()) % menuItems.size();
+            selectedOption = (selectedOption - 1 + itemCount) % itemCount;
         } while (!menuItems[selectedOption].isEnabled);
         break;
 
     case MenuNavigation::DOWN:
         do {
-            selectedOption = (selectedOption + 1) % menuItems.size();
+            selectedOption = (selectedOption + 1) % itemCount;
         } while (!menuItems[selectedOption].isEnabled);
         break;
 
@@ -289,24 +291,48 @@ void GameMenu::moveSelection(MenuNavigation dir) {
 }
 
 void GameMenu::selectCurrentOption() {
-    if (selectedOption >= 0 && selectedOption < static_cast<int>(menuItems.size())) {
-        const auto& item = menuItems[selectedOption];
-        if (item.isEnabled && item.action) {
-            item.action();
-        }
+    if (selectedOption < 0 || selectedOption >= itemCount || !menuItems[selectedOption].isEnabled) {
+        return;
+    }
+    switch (menuItems[selectedOption].command) {
+    case MenuCommand::NONE:
+        break;
+    case MenuCommand::NEW_GAME:
+        run(actions.newGame);
+        break;
+    case MenuCommand::RESUME:
+        run(actions.resume);
+        break;
+    case MenuCommand::RESTART_LEVEL:
+        run(actions.restartLevel);
+        break;
+    case MenuCommand::SHOW_HIGHSCORES:
+        run(actions.showHighScores);
+        break;
+    case MenuCommand::QUIT:
+        run(actions.quit);
+        break;
+    case MenuCommand::MAIN_MENU:
+        showMainMenu();
+        break;
+    case MenuCommand::CONFIG_MENU:
+        showConfigMenu();
+        break;
+    case MenuCommand::CONTROLS_MENU:
+        showControlsMenu();
+        break;
+    case MenuCommand::CONFIRM_EXIT:
+        showConfirmExit();
+        break;
     }
 }
 
-void GameMenu::clearMenuArea() {
-    for (int y = startY; y < startY + height + 1; y++) {
-        move(y, startX);
-        clrtoeol();
+void GameMenu::run(const std::function<void()>& action) {
+    if (action) {
+        action();
     }
 }
 
-void GameMenu::addMenuItem(const std::string& label,
-    const std::string& description,
-    std::function<void()> action,
-    bool enabled) {
-    menuItems.emplace_back(label, description, action, enabled);
-}
\ No newline at end of file
+void GameMenu::clearMenuArea(FrameRenderer& screen) {
+    screen.clearArea(startX, startY, screen.getWidth() - startX, height + 1);
+}
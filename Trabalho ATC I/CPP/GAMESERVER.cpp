@@ -0,0 +1,897 @@
+#include "game_server.h"
+#include "game.h"
+#include "game_snapshot.h"
+#include "snapshot_delta.h"
+#include "pacman_ui.h"
+#include "replay.h"
+#include "metrics.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    const int MAX_EVENTS = 256;
+    const int LISTEN_BACKLOG = 4096;
+    const int ACCEPTS_PER_WAKE = 16;
+    const int MAX_QUEUED_FRAMES = 64;     // Por ligao; maxPendingBytes corta antes
+    const int SEND_BATCH = 16;            // Frames por sendmsg()
+    const size_t FRAME_POOL_RESERVE = 1024;
+    const size_t MAX_FRAME_SIZE = SERVER_FRAME_HEADER_SIZE +
+        (sizeof(GameSnapshot) > SNAPSHOT_DELTA_MAX_SIZE ? sizeof(GameSnapshot) : SNAPSHOT_DELTA_MAX_SIZE);
+
+    void setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            throw std::runtime_error("Nao foi possivel configurar o socket");
+        }
+    }
+
+    void put16(uint8_t* p, uint16_t value) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void put32(uint8_t* p, uint32_t value) {
+        for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint32_t get32(const uint8_t* p) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(p[i]) << (8 * i);
+        return value;
+    }
+
+    uint64_t get64(const uint8_t* p) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(p[i]) << (8 * i);
+        return value;
+    }
+
+    template <typename T>
+    void storeMax(std::atomic<T>& target, T value) {
+        if (value > target.load(std::memory_order_relaxed)) {
+            target.store(value, std::memory_order_relaxed);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// EventLoop: uma thread, um epoll, as suas sesses
+
+class GameServer::EventLoop {
+public:
+    EventLoop(const GameServerConfig& config, int index, int sessionLimit,
+        const std::atomic<bool>& running, const std::vector<std::unique_ptr<EventLoop>>& peers);
+    ~EventLoop();
+
+    void listenTcp(int port);             // Listener prprio (SO_REUSEPORT)
+    void addSharedListener(int fd);       // Listener partilhado (EPOLLEXCLUSIVE)
+    void run();
+    void wake();
+    void adopt(int fd, uint32_t sessionId, bool isTcp);   // Chamado por outro loop
+    void addStats(GameServerStats& total) const;
+
+private:
+    // Frame montado uma vez e partilhado por todas as ligaes que o enviam;
+    // volta ao pool do loop quando a ltima o larga
+    struct SharedFrame {
+        int refs;
+        size_t size;                    // Cabealho includo
+        uint8_t data[MAX_FRAME_SIZE];
+    };
+
+    // Uma ligao: o jogador de uma sesso ou um espectador
+    struct Session {
+        int fd;
+        uint32_t id;
+        size_t index;                   // Posio em sessions
+        std::unique_ptr<Game> game;     // Criado no JOIN (nulo nos espectadores)
+        GameSnapshot previous;          // Estado do ltimo tick publicado
+        GameSnapshot current;
+        std::vector<Session*> spectators;   // Quem est a ver esta sesso
+        Session* watched;               // Sesso vista por este espectador
+        size_t spectatorIndex;          // Posio em watched->spectators
+        bool needsKeyframe;
+        bool isTcp;
+        bool watchingWrite;
+        bool closing;
+        uint8_t input[64];              // Mensagens do cliente ainda incompletas
+        size_t inputUsed;
+        SharedFrame* queue[MAX_QUEUED_FRAMES];  // Frames por enviar (anel)
+        int queueHead;
+        int queueCount;
+        size_t headSent;                // Bytes j enviados do primeiro frame
+        size_t pendingBytes;
+    };
+
+    // Ligao de espectador passada por outro loop
+    struct Handoff {
+        int fd;
+        uint32_t sessionId;
+        bool isTcp;
+    };
+
+    const GameServerConfig& config;
+    const std::atomic<bool>& running;
+    const std::vector<std::unique_ptr<EventLoop>>& peers;
+    int index;
+    size_t sessionLimit;
+    uint32_t nextId;
+
+    int epollFd;
+    int timerFd;
+    int wakeFd;
+    int tcpListener;
+    int sharedListener;
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::unordered_map<uint32_t, Session*> players;   // Sesses com jogo, por id
+    bool anyClosing;
+
+    std::vector<std::unique_ptr<SharedFrame>> frameStorage;
+    std::vector<SharedFrame*> freeFrames;
+
+    std::mutex inboxMutex;              // nica estrutura tocada por outras threads
+    std::vector<Handoff> inbox;
+    std::vector<Handoff> adopting;
+
+    // Escritos s por esta thread, lidos por getStats()
+    std::atomic<long long> accepted, rejected, ticks, keyframes, deltas, framesSent, resyncs;
+    std::atomic<long long> droppedFrames, lateTicks, bytesSent, openSessions, openSpectators;
+    std::atomic<double> maxTickMs;
+
+    void watch(int fd, void* tag, uint32_t events);
+    void acceptFrom(int listener, bool isTcp);
+    Session* addSession(int fd, bool isTcp);
+    void adoptPending();
+    void onTimer();
+    void onSession(Session& session, uint32_t events);
+    void readInput(Session& session);
+    void join(Session& session, uint64_t seed);
+    void watchSession(Session& session, uint32_t sessionId);
+    void attachSpectator(Session& spectator, Session& player);
+    void publishTick(Session& player);
+    void deliver(Session& viewer, SharedFrame* frame, SharedFrame*& keyframe, const GameSnapshot& state);
+    SharedFrame* makeKeyframe(const GameSnapshot& state);
+    SharedFrame* acquireFrame();
+    void releaseFrame(SharedFrame* frame);
+    void queueWelcome(Session& session, uint32_t sessionId);
+    void enqueue(Session& session, SharedFrame* frame);
+    void flushOutput(Session& session);
+    void setWriteInterest(Session& session, bool enabled);
+    void closeSession(Session& session);
+    void detach(Session& session);      // Tira a ligao do loop sem a fechar
+    void reapClosed();
+};
+
+GameServer::EventLoop::EventLoop(const GameServerConfig& config, int index, int sessionLimit,
+    const std::atomic<bool>& running, const std::vector<std::unique_ptr<EventLoop>>& peers)
+    : config(config), running(running), peers(peers), index(index),
+    sessionLimit(static_cast<size_t>(sessionLimit)), nextId(0),
+    epollFd(-1), timerFd(-1), wakeFd(-1), tcpListener(-1), sharedListener(-1),
+    anyClosing(false),
+    accepted(0), rejected(0), ticks(0), keyframes(0), deltas(0), framesSent(0), resyncs(0),
+    droppedFrames(0), lateTicks(0), bytesSent(0), openSessions(0), openSpectators(0), maxTickMs(0)
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || timerFd < 0 || wakeFd < 0) {
+        throw std::runtime_error("Nao foi possivel criar o event loop");
+    }
+
+    // Todos os loops com o mesmo perodo; cada um com a sua fase
+    const long long periodNs = 1000000000LL / std::max(1, config.ticksPerSecond);
+    itimerspec spec;
+    spec.it_interval.tv_sec = periodNs / 1000000000LL;
+    spec.it_interval.tv_nsec = periodNs % 1000000000LL;
+    spec.it_value = spec.it_interval;
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+
+    watch(timerFd, &timerFd, EPOLLIN);
+    watch(wakeFd, &wakeFd, EPOLLIN);
+    sessions.reserve(this->sessionLimit);
+    players.reserve(this->sessionLimit);
+    freeFrames.reserve(FRAME_POOL_RESERVE);
+}
+
+GameServer::EventLoop::~EventLoop() {
+    for (auto& session : sessions) {
+        if (session->fd >= 0) ::close(session->fd);
+    }
+    for (const Handoff& handoff : inbox) {
+        ::close(handoff.fd);
+    }
+    if (tcpListener >= 0) ::close(tcpListener);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (timerFd >= 0) ::close(timerFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+void GameServer::EventLoop::watch(int fd, void* tag, uint32_t events) {
+    epoll_event event;
+    event.events = events;
+    event.data.ptr = tag;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throw std::runtime_error("epoll_ctl falhou");
+    }
+}
+
+void GameServer::EventLoop::listenTcp(int port) {
+    tcpListener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (tcpListener < 0) {
+        throw std::runtime_error("Nao foi possivel criar o socket TCP");
+    }
+    // Um listener por loop na mesma porta: o kernel reparte as ligaes
+    int one = 1;
+    setsockopt(tcpListener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(tcpListener, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(tcpListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(tcpListener, LISTEN_BACKLOG) < 0) {
+        throw std::runtime_error("Porta TCP ocupada: " + std::to_string(port));
+    }
+    watch(tcpListener, &tcpListener, EPOLLIN);
+}
+
+void GameServer::EventLoop::addSharedListener(int fd) {
+    sharedListener = fd;
+    // S um dos loops acorda por ligao nova
+    watch(sharedListener, &sharedListener, EPOLLIN | EPOLLEXCLUSIVE);
+}
+
+void GameServer::EventLoop::wake() {
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void GameServer::EventLoop::adopt(int fd, uint32_t sessionId, bool isTcp) {
+    Handoff handoff;
+    handoff.fd = fd;
+    handoff.sessionId = sessionId;
+    handoff.isTcp = isTcp;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        inbox.push_back(handoff);
+    }
+    wake();
+}
+
+void GameServer::EventLoop::run() {
+    epoll_event events[MAX_EVENTS];
+
+    while (running.load(std::memory_order_relaxed)) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::fprintf(stderr, "loop %d: epoll_wait falhou (%s)\n", index, std::strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < count; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == &timerFd) {
+                onTimer();
+            }
+            else if (tag == &wakeFd) {
+                uint64_t value;
+                ssize_t ignored = read(wakeFd, &value, sizeof(value));
+                (void)ignored;
+                adoptPending();
+            }
+            else if (tag == &tcpListener) {
+                acceptFrom(tcpListener, true);
+            }
+            else if (tag == &sharedListener) {
+                acceptFrom(sharedListener, false);
+            }
+            else {
+                onSession(*static_cast<Session*>(tag), events[i].events);
+            }
+        }
+
+        // S depois do lote: eventos seguintes podiam apontar para a sesso
+        if (anyClosing) {
+            reapClosed();
+        }
+    }
+}
+
+void GameServer::EventLoop::acceptFrom(int listener, bool isTcp) {
+    // Com o listener partilhado aceita-se uma de cada vez, para que as
+    // restantes acordem outros loops e as sesses fiquem repartidas
+    const int limit = isTcp ? ACCEPTS_PER_WAKE : 1;
+    for (int i = 0; i < limit; i++) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;   // EAGAIN: no h mais (ou outro loop ficou com ela)
+        }
+        if (sessions.size() >= sessionLimit) {
+            ::close(fd);
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (isTcp) {
+            // Frames pequenos a 60 Hz: no esperar pelo Nagle
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        addSession(fd, isTcp);
+        accepted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+GameServer::EventLoop::Session* GameServer::EventLoop::addSession(int fd, bool isTcp) {
+    std::unique_ptr<Session> session(new Session());
+    session->fd = fd;
+    session->id = (static_cast<uint32_t>(index) << 24) | (nextId++ & 0xFFFFFF);
+    session->index = sessions.size();
+    session->watched = nullptr;
+    session->spectatorIndex = 0;
+    session->needsKeyframe = true;
+    session->isTcp = isTcp;
+    session->watchingWrite = false;
+    session->closing = false;
+    session->inputUsed = 0;
+    session->queueHead = 0;
+    session->queueCount = 0;
+    session->headSent = 0;
+    session->pendingBytes = 0;
+
+    watch(fd, session.get(), EPOLLIN | EPOLLRDHUP);
+    sessions.push_back(std::move(session));
+    Metrics::addGauge(MetricGauge::ACTIVE_SESSIONS, 1);
+    openSessions.store(static_cast<long long>(sessions.size()), std::memory_order_relaxed);
+    return sessions.back().get();
+}
+
+void GameServer::EventLoop::adoptPending() {
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        adopting.swap(inbox);
+    }
+    for (const Handoff& handoff : adopting) {
+        if (sessions.size() >= sessionLimit) {
+            ::close(handoff.fd);
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        Session* session = addSession(handoff.fd, handoff.isTcp);
+        watchSession(*session, handoff.sessionId);
+    }
+    adopting.clear();
+}
+
+void GameServer::EventLoop::onTimer() {
+    uint64_t expirations = 0;
+    if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0) {
+        return;
+    }
+
+    // Atrasos maiores so descartados em vez de acelerar todas as sesses
+    const uint64_t toRun = std::min<uint64_t>(expirations,
+        static_cast<uint64_t>(std::max(1, config.maxTicksPerWake)));
+    if (expirations > toRun) {
+        lateTicks.fetch_add(static_cast<long long>(expirations - toRun), std::memory_order_relaxed);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    long long ticked = 0;
+    for (uint64_t t = 0; t < toRun; t++) {
+        for (auto& session : sessions) {
+            if (session->closing || !session->game) continue;
+            session->game->updateGameState();
+            publishTick(*session);
+            ticked++;
+        }
+    }
+
+    // Um envio por ligao, com todos os frames do acordar
+    for (auto& session : sessions) {
+        if (!session->closing && session->queueCount > 0 && !session->watchingWrite) {
+            flushOutput(*session);
+        }
+    }
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    storeMax(maxTickMs, elapsedMs / static_cast<double>(toRun));
+    ticks.fetch_add(ticked, std::memory_order_relaxed);
+    Metrics::add(MetricCounter::TICKS, static_cast<uint64_t>(ticked));
+    for (uint64_t t = 0; t < toRun; t++) {
+        Metrics::observe(MetricHistogram::TICK_SECONDS, elapsedMs / 1000.0 / static_cast<double>(toRun));
+    }
+}
+
+void GameServer::EventLoop::onSession(Session& session, uint32_t events) {
+    if (session.closing) return;
+
+    if (events & EPOLLIN) {
+        readInput(session);
+    }
+    if (!session.closing && (events & EPOLLOUT)) {
+        flushOutput(session);
+    }
+    if (!session.closing && (events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP))) {
+        closeSession(session);
+    }
+}
+
+void GameServer::EventLoop::readInput(Session& session) {
+    for (;;) {
+        ssize_t received = recv(session.fd, session.input + session.inputUsed,
+            sizeof(session.input) - session.inputUsed, 0);
+        if (received == 0) {
+            closeSession(session);
+            return;
+        }
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) closeSession(session);
+            return;
+        }
+        session.inputUsed += static_cast<size_t>(received);
+
+        size_t pos = 0;
+        while (pos < session.inputUsed) {
+            const uint8_t* message = session.input + pos;
+            const size_t available = session.inputUsed - pos;
+            if (message[0] == static_cast<uint8_t>(ClientMessage::JOIN) && !session.watched) {
+                if (available < CLIENT_JOIN_SIZE) break;
+                join(session, get64(message + 1));
+                pos += CLIENT_JOIN_SIZE;
+            }
+            else if (message[0] == static_cast<uint8_t>(ClientMessage::INPUT)) {
+                if (available < CLIENT_INPUT_SIZE) break;
+                // Os espectadores no tm jogo: a entrada  ignorada
+                if (session.game && message[1] <= static_cast<uint8_t>(ReplayCode::PAUSE)) {
+                    session.game->handleInput(replayKeyForCode(static_cast<ReplayCode>(message[1])));
+                }
+                pos += CLIENT_INPUT_SIZE;
+            }
+            else if (message[0] == static_cast<uint8_t>(ClientMessage::WATCH) &&
+                !session.game && !session.watched) {
+                if (available < CLIENT_WATCH_SIZE) break;
+                // Pode passar a ligao a outro loop; um espectador no manda
+                // mais nada que interesse, o resto do buffer  descartado
+                watchSession(session, get32(message + 1));
+                if (!session.closing) session.inputUsed = 0;
+                return;
+            }
+            else {
+                closeSession(session);   // Protocolo invlido
+                return;
+            }
+            if (session.closing) return;
+        }
+        session.inputUsed -= pos;
+        std::memmove(session.input, session.input + pos, session.inputUsed);
+    }
+}
+
+void GameServer::EventLoop::join(Session& session, uint64_t seed) {
+    try {
+        if (!session.game) {
+            session.game.reset(new Game(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT));
+            players[session.id] = &session;
+        }
+        // Um segundo JOIN recomea o jogo na mesma sesso
+        session.game->setSeed(seed);
+        session.game->startGame();
+    }
+    catch (const std::exception&) {
+        closeSession(session);
+        return;
+    }
+
+    // O tick 0  publicado a todos como keyframe (os espectadores de um
+    // jogo recomeado tambm precisam dele)
+    session.game->saveSnapshot(session.previous);
+    session.game->clearDirtyCells();
+    queueWelcome(session, session.id);
+    SharedFrame* keyframe = makeKeyframe(session.previous);
+    session.needsKeyframe = true;
+    deliver(session, keyframe, keyframe, session.previous);
+    for (Session* spectator : session.spectators) {
+        spectator->needsKeyframe = true;
+        deliver(*spectator, keyframe, keyframe, session.previous);
+    }
+    releaseFrame(keyframe);
+    flushOutput(session);
+}
+
+void GameServer::EventLoop::watchSession(Session& session, uint32_t sessionId) {
+    const size_t owner = sessionId >> 24;
+    if (owner != static_cast<size_t>(index)) {
+        if (owner >= peers.size()) {
+            closeSession(session);
+            return;
+        }
+        // A sesso vive noutro loop: a ligao muda-se para l
+        const int fd = session.fd;
+        const bool isTcp = session.isTcp;
+        detach(session);
+        peers[owner]->adopt(fd, sessionId, isTcp);
+        return;
+    }
+
+    auto found = players.find(sessionId);
+    if (found == players.end() || found->second->closing) {
+        closeSession(session);
+        return;
+    }
+    attachSpectator(session, *found->second);
+}
+
+void GameServer::EventLoop::attachSpectator(Session& spectator, Session& player) {
+    spectator.watched = &player;
+    spectator.spectatorIndex = player.spectators.size();
+    spectator.needsKeyframe = true;   // Recebe um keyframe no prximo tick
+    player.spectators.push_back(&spectator);
+    openSpectators.fetch_add(1, std::memory_order_relaxed);
+    Metrics::addGauge(MetricGauge::SPECTATORS, 1);
+
+    queueWelcome(spectator, player.id);
+    flushOutput(spectator);
+}
+
+void GameServer::EventLoop::publishTick(Session& player) {
+    // Parte do tick anterior: s as casas alteradas so lidas do tabuleiro
+    std::memcpy(&player.current, &player.previous, sizeof(GameSnapshot));
+    player.game->updateSnapshot(player.current);
+    const SnapshotDirtyCells dirty(player.game->getDirtyCells(), player.game->getDirtyCount());
+
+    SharedFrame* frame;
+    SharedFrame* keyframe = nullptr;
+    if (needsSnapshotKeyframe(player.previous, player.current, dirty)) {
+        frame = keyframe = makeKeyframe(player.current);
+    }
+    else {
+        frame = acquireFrame();
+        const size_t size = encodeSnapshotDelta(player.previous, player.current,
+            frame->data + SERVER_FRAME_HEADER_SIZE, dirty);
+        put16(frame->data, static_cast<uint16_t>(size));
+        frame->data[2] = static_cast<uint8_t>(ServerMessage::DELTA);
+        frame->size = SERVER_FRAME_HEADER_SIZE + size;
+        deltas.fetch_add(1, std::memory_order_relaxed);
+    }
+    player.game->clearDirtyCells();
+    Metrics::observe(MetricHistogram::FRAME_BYTES, static_cast<double>(frame->size));
+
+    // O mesmo frame para todos; o keyframe de recuperao tambm s se monta uma vez
+    deliver(player, frame, keyframe, player.current);
+    for (Session* spectator : player.spectators) {
+        deliver(*spectator, frame, keyframe, player.current);
+    }
+
+    if (keyframe && keyframe != frame) {
+        releaseFrame(keyframe);
+    }
+    releaseFrame(frame);
+    std::memcpy(&player.previous, &player.current, sizeof(GameSnapshot));
+}
+
+void GameServer::EventLoop::deliver(Session& viewer, SharedFrame* frame, SharedFrame*& keyframe,
+    const GameSnapshot& state) {
+    if (viewer.closing) return;
+
+    // Ligao lenta: no acumular mais; recebe um keyframe quando recuperar
+    if (viewer.pendingBytes > config.maxPendingBytes || viewer.queueCount == MAX_QUEUED_FRAMES) {
+        viewer.needsKeyframe = true;
+        droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (viewer.needsKeyframe && frame != keyframe) {
+        if (!keyframe) {
+            keyframe = makeKeyframe(state);
+        }
+        enqueue(viewer, keyframe);
+        resyncs.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        enqueue(viewer, frame);
+    }
+    viewer.needsKeyframe = false;
+}
+
+GameServer::EventLoop::SharedFrame* GameServer::EventLoop::makeKeyframe(const GameSnapshot& state) {
+    SharedFrame* frame = acquireFrame();
+    std::memcpy(frame->data + SERVER_FRAME_HEADER_SIZE, &state, sizeof(GameSnapshot));
+    put16(frame->data, static_cast<uint16_t>(sizeof(GameSnapshot)));
+    frame->data[2] = static_cast<uint8_t>(ServerMessage::KEYFRAME);
+    frame->size = SERVER_FRAME_HEADER_SIZE + sizeof(GameSnapshot);
+    keyframes.fetch_add(1, std::memory_order_relaxed);
+    return frame;
+}
+
+GameServer::EventLoop::SharedFrame* GameServer::EventLoop::acquireFrame() {
+    // O pool s cresce at ao mximo de frames em voo ao mesmo tempo
+    SharedFrame* frame;
+    if (freeFrames.empty()) {
+        frameStorage.emplace_back(new SharedFrame());
+        frame = frameStorage.back().get();
+    }
+    else {
+        frame = freeFrames.back();
+        freeFrames.pop_back();
+    }
+    frame->refs = 1;   // Referncia de quem o montou
+    frame->size = 0;
+    return frame;
+}
+
+void GameServer::EventLoop::releaseFrame(SharedFrame* frame) {
+    if (--frame->refs == 0) {
+        freeFrames.push_back(frame);
+    }
+}
+
+void GameServer::EventLoop::queueWelcome(Session& session, uint32_t sessionId) {
+    SharedFrame* frame = acquireFrame();
+    put16(frame->data, 6);
+    frame->data[2] = static_cast<uint8_t>(ServerMessage::WELCOME);
+    put32(frame->data + 3, sessionId);
+    put16(frame->data + 7, static_cast<uint16_t>(config.ticksPerSecond));
+    frame->size = SERVER_FRAME_HEADER_SIZE + 6;
+    enqueue(session, frame);
+    releaseFrame(frame);
+}
+
+void GameServer::EventLoop::enqueue(Session& session, SharedFrame* frame) {
+    session.queue[(session.queueHead + session.queueCount) % MAX_QUEUED_FRAMES] = frame;
+    session.queueCount++;
+    session.pendingBytes += frame->size;
+    Metrics::addGauge(MetricGauge::QUEUED_FRAMES, 1);
+    Metrics::addGauge(MetricGauge::QUEUED_BYTES, static_cast<int64_t>(frame->size));
+    frame->refs++;
+    framesSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GameServer::EventLoop::flushOutput(Session& session) {
+    while (session.queueCount > 0) {
+        // Os frames vo diretamente dos buffers partilhados, sem cpia
+        iovec parts[SEND_BATCH];
+        int count = 0;
+        for (; count < session.queueCount && count < SEND_BATCH; count++) {
+            SharedFrame* frame = session.queue[(session.queueHead + count) % MAX_QUEUED_FRAMES];
+            const size_t skip = count == 0 ? session.headSent : 0;
+            parts[count].iov_base = frame->data + skip;
+            parts[count].iov_len = frame->size - skip;
+        }
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = parts;
+        message.msg_iovlen = static_cast<size_t>(count);
+
+        ssize_t sent = sendmsg(session.fd, &message, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            setWriteInterest(session, true);
+            return;
+        }
+        if (sent <= 0) {
+            closeSession(session);
+            return;
+        }
+        bytesSent.fetch_add(sent, std::memory_order_relaxed);
+        session.pendingBytes -= static_cast<size_t>(sent);
+        Metrics::addGauge(MetricGauge::QUEUED_BYTES, -static_cast<int64_t>(sent));
+
+        size_t remaining = static_cast<size_t>(sent);
+        while (remaining > 0) {
+            SharedFrame* frame = session.queue[session.queueHead];
+            const size_t left = frame->size - session.headSent;
+            if (remaining < left) {
+                session.headSent += remaining;
+                break;
+            }
+            remaining -= left;
+            session.headSent = 0;
+            session.queueHead = (session.queueHead + 1) % MAX_QUEUED_FRAMES;
+            session.queueCount--;
+            Metrics::addGauge(MetricGauge::QUEUED_FRAMES, -1);
+            releaseFrame(frame);
+        }
+    }
+
+    if (session.watchingWrite) {
+        setWriteInterest(session, false);
+    }
+}
+
+void GameServer::EventLoop::setWriteInterest(Session& session, bool enabled) {
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP | (enabled ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.ptr = &session;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, session.fd, &event);
+    session.watchingWrite = enabled;
+}
+
+void GameServer::EventLoop::closeSession(Session& session) {
+    if (session.closing) return;
+    const int fd = session.fd;
+    detach(session);
+    ::close(fd);
+}
+
+void GameServer::EventLoop::detach(Session& session) {
+    session.closing = true;
+    Metrics::addGauge(MetricGauge::ACTIVE_SESSIONS, -1);
+
+    if (session.watched) {
+        // Troca com o ltimo espectador da sesso vista
+        std::vector<Session*>& list = session.watched->spectators;
+        list[session.spectatorIndex] = list.back();
+        list[session.spectatorIndex]->spectatorIndex = session.spectatorIndex;
+        list.pop_back();
+        session.watched = nullptr;
+        openSpectators.fetch_sub(1, std::memory_order_relaxed);
+        Metrics::addGauge(MetricGauge::SPECTATORS, -1);
+    }
+    // Sem jogo no h nada para ver
+    for (Session* spectator : session.spectators) {
+        spectator->watched = nullptr;
+        openSpectators.fetch_sub(1, std::memory_order_relaxed);
+        Metrics::addGauge(MetricGauge::SPECTATORS, -1);
+        closeSession(*spectator);
+    }
+    session.spectators.clear();
+    if (session.game) {
+        players.erase(session.id);
+    }
+
+    Metrics::addGauge(MetricGauge::QUEUED_FRAMES, -session.queueCount);
+    Metrics::addGauge(MetricGauge::QUEUED_BYTES, -static_cast<int64_t>(session.pendingBytes));
+    while (session.queueCount > 0) {
+        releaseFrame(session.queue[session.queueHead]);
+        session.queueHead = (session.queueHead + 1) % MAX_QUEUED_FRAMES;
+        session.queueCount--;
+    }
+    session.pendingBytes = 0;
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+    session.fd = -1;
+    anyClosing = true;
+}
+
+void GameServer::EventLoop::reapClosed() {
+    // Troca com o ltimo: O(1) por sesso, sem mexer na ordem das outras
+    size_t i = 0;
+    while (i < sessions.size()) {
+        if (sessions[i]->closing) {
+            sessions[i] = std::move(sessions.back());
+            sessions[i]->index = i;
+            sessions.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+    anyClosing = false;
+    openSessions.store(static_cast<long long>(sessions.size()), std::memory_order_relaxed);
+}
+
+void GameServer::EventLoop::addStats(GameServerStats& total) const {
+    total.sessions += openSessions.load(std::memory_order_relaxed);
+    total.spectators += openSpectators.load(std::memory_order_relaxed);
+    total.accepted += accepted.load(std::memory_order_relaxed);
+    total.rejected += rejected.load(std::memory_order_relaxed);
+    total.ticks += ticks.load(std::memory_order_relaxed);
+    total.keyframes += keyframes.load(std::memory_order_relaxed);
+    total.deltas += deltas.load(std::memory_order_relaxed);
+    total.framesSent += framesSent.load(std::memory_order_relaxed);
+    total.resyncs += resyncs.load(std::memory_order_relaxed);
+    total.droppedFrames += droppedFrames.load(std::memory_order_relaxed);
+    total.lateTicks += lateTicks.load(std::memory_order_relaxed);
+    total.bytesSent += bytesSent.load(std::memory_order_relaxed);
+    total.maxTickMs = std::max(total.maxTickMs, maxTickMs.load(std::memory_order_relaxed));
+}
+
+// ---------------------------------------------------------------------------
+// GameServer
+
+GameServer::GameServer(const GameServerConfig& config)
+    : config(config), tcpPort(0), unixListener(-1), running(false) {
+    int count = config.threads > 0 ? config.threads
+        : static_cast<int>(std::thread::hardware_concurrency());
+    if (count <= 0) count = 1;
+
+    const int perLoop = (std::max(1, config.maxSessions) + count - 1) / count;
+    for (int i = 0; i < count; i++) {
+        loops.emplace_back(new EventLoop(this->config, i, perLoop, running, loops));
+    }
+}
+
+GameServer::~GameServer() {
+    stop();
+    for (auto& thread : threads) {
+        if (thread.joinable()) thread.join();
+    }
+    loops.clear();
+    if (unixListener >= 0) {
+        ::close(unixListener);
+        unlink(unixPath.c_str());
+    }
+}
+
+void GameServer::listenTcp(int port) {
+    tcpPort = port;
+    for (auto& loop : loops) {
+        loop->listenTcp(port);
+    }
+}
+
+void GameServer::listenUnix(const std::string& path) {
+    sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Caminho de socket Unix demasiado longo");
+    }
+    unixListener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (unixListener < 0) {
+        throw std::runtime_error("Nao foi possivel criar o socket Unix");
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    unlink(path.c_str());
+    if (bind(unixListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(unixListener, LISTEN_BACKLOG) < 0) {
+        throw std::runtime_error("Nao foi possivel escutar em " + path);
+    }
+    setNonBlocking(unixListener);
+    unixPath = path;
+
+    for (auto& loop : loops) {
+        loop->addSharedListener(unixListener);
+    }
+}
+
+void GameServer::run() {
+    running = true;
+    for (size_t i = 1; i < loops.size(); i++) {
+        threads.emplace_back(&EventLoop::run, loops[i].get());
+    }
+    loops[0]->run();   // O primeiro loop corre na thread de quem chamou
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+}
+
+void GameServer::stop() {
+    // S operaes async-signal-safe: store atmico e write() no eventfd
+    running = false;
+    for (auto& loop : loops) {
+        loop->wake();
+    }
+}
+
+GameServerStats GameServer::getStats() const {
+    GameServerStats total;
+    for (const auto& loop : loops) {
+        loop->addStats(total);
+    }
+    return total;
+}
@@ -0,0 +1,34 @@
+#include "game_snapshot.h"
+#include <cstdio>
+#include <stdexcept>
+
+// O bloco vai para disco tal como est em memria (layout fixo,
+// little-endian nas plataformas suportadas). Usa stdio em vez de
+// fstream para no alocar buffers.
+
+void writeSnapshotFile(const std::string& path, const GameSnapshot& snapshot) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Nao foi possivel gravar o jogo: " + path);
+    }
+    size_t written = std::fwrite(&snapshot, sizeof(snapshot), 1, file);
+    std::fclose(file);
+    if (written != 1) {
+        throw std::runtime_error("Erro ao gravar o jogo: " + path);
+    }
+}
+
+void readSnapshotFile(const std::string& path, GameSnapshot& snapshot) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Jogo gravado nao encontrado: " + path);
+    }
+    size_t read = std::fread(&snapshot, sizeof(snapshot), 1, file);
+    std::fclose(file);
+    if (read != 1) {
+        throw std::runtime_error("Jogo gravado truncado: " + path);
+    }
+    if (snapshot.version != GameSnapshot::VERSION) {
+        throw std::runtime_error("Jogo gravado noutra versao: " + path);
+    }
+}
@@ -1,49 +1,35 @@
 #include "ghost.h"
-#include "pacman_ui.h"
-#include <cstdlib>
+#include "state_hash.h"
 #include <cmath>
 
-Ghost::Ghost(int startX, int startY, GhostType ghostType)
-    : x(startX), y(startY), spawnX(startX), spawnY(startY),
-    speed(1), state(GhostState::WAITING), type(ghostType),
-    vulnerableTimer(0), isActive(true) {
+Ghost::Ghost(EntityWorld& entityWorld, int index, int startX, int startY, GhostType ghostType)
+    : world(&entityWorld),
+    entity(entityWorld.create(COMPONENT_POSITION | COMPONENT_VELOCITY | COMPONENT_AI |
+        COMPONENT_TIMER | COMPONENT_RENDERABLE | COMPONENT_COLLIDER)),
+    spawnX(startX), spawnY(startY),
+    state(GhostState::WAITING), type(ghostType),
+    isActive(true) {
+
+    world->getPosition(entity) = Position{ static_cast<int16_t>(startX), static_cast<int16_t>(startY) };
+    world->getVelocity(entity).speed = 1;
+    world->getCollider(entity).layer = LAYER_GHOST;
+    world->getAI(entity).ghost = static_cast<uint8_t>(index);
 
     // Define aparncia baseada no tipo
-    switch (type) {
-    case GhostType::BLINKY:
-        colorPair = 2;  // Vermelho (definido na PacmanUI)
-        ghostChar = 'B';
-        break;
-    case GhostType::PINKY:
-        colorPair = 3;  // Magenta (definido na PacmanUI)
-        ghostChar = 'P';
-        break;
-    case GhostType::INKY:
-        colorPair = 4;  // Cyan (definido na PacmanUI)
-        ghostChar = 'I';
-        break;
-    case GhostType::CLYDE:
-        colorPair = 5;  // Verde (definido na PacmanUI)
-        ghostChar = 'C';
-        break;
-    }
+    updateDisplay();
 }
 
-void Ghost::move(int pacmanX, int pacmanY, Board& board) {
+void Ghost::move(int pacmanX, int pacmanY, Board& board, GameRandom& rng) {
     if (!isActive) return;
 
-    if (state == GhostState::VULNERABLE) {
-        if (--vulnerableTimer <= 0) {
-            recover();
-        }
-    }
-
     switch (state) {
     case GhostState::NORMAL:
-        moveNormal(pacmanX, pacmanY, board);
+        if (isPlayerControlled()) movePlayer(board);
+        else moveNormal(pacmanX, pacmanY, board);
         break;
     case GhostState::VULNERABLE:
-        moveVulnerable(pacmanX, pacmanY, board);
+        if (isPlayerControlled()) movePlayer(board);
+        else moveVulnerable(pacmanX, pacmanY, board, rng);
         break;
     case GhostState::RETURNING:
         moveReturning(board);
@@ -70,10 +56,10 @@ void Ghost::moveNormal(int pacmanX, int pacmanY, Board& board) {
     }
 }
 
-void Ghost::moveVulnerable(int pacmanX, int pacmanY, Board& board) {
-    // Movimento aleatrio quando vulnervel
-    int randDir = rand() % 4;
-    int newX = x, newY = y;
+void Ghost::moveVulnerable(int /*pacmanX*/, int /*pacmanY*/, Board& board, GameRandom& rng) {
+    // Movimento aleatrio quando vulnervel (RNG do jogo, para ser reproduzvel)
+    int randDir = rng.nextInt(4);
+    int newX = getX(), newY = getY();
     switch (randDir) {
     case 0: newX++; break;
     case 1: newX--; break;
@@ -81,29 +67,49 @@ void Ghost::moveVulnerable(int pacmanX, int pacmanY, Board& board) {
     case 3: newY--; break;
     }
     if (canMoveTo(newX, newY, board)) {
-        x = newX;
-        y = newY;
+        moveTo(newX, newY);
     }
 }
 
 void Ghost::moveReturning(Board& board) {
     // Retorna ao ponto de spawn
-    int nextX = x, nextY = y;
+    int nextX = getX(), nextY = getY();
     calculateNextMove(spawnX, spawnY, board, nextX, nextY);
-    x = nextX;
-    y = nextY;
+    moveTo(nextX, nextY);
 
     // Se chegou ao spawn, volta ao estado normal
-    if (x == spawnX && y == spawnY) {
+    if (nextX == spawnX && nextY == spawnY) {
         state = GhostState::NORMAL;
         updateDisplay();
     }
 }
 
+void Ghost::movePlayer(Board& board) {
+    // Mesma regra do Pacman: segue a direo enquanto no houver obstculo
+    // (uma casa por passo, como os fantasmas da IA)
+    const Velocity& velocity = world->getVelocity(entity);
+    int newX = getX() + velocity.dx;
+    int newY = getY() + velocity.dy;
+    if ((velocity.dx || velocity.dy) && canMoveTo(newX, newY, board)) {
+        moveTo(newX, newY);
+    }
+}
+
+void Ghost::setPlayerControlled(bool controlled) {
+    world->getAI(entity).playerControlled = controlled ? 1 : 0;
+    changeDirection(0, 0);
+}
+
+void Ghost::changeDirection(int dx, int dy) {
+    Velocity& velocity = world->getVelocity(entity);
+    velocity.dx = static_cast<int8_t>(dx);
+    velocity.dy = static_cast<int8_t>(dy);
+}
+
+// O fim da vulnerabilidade e a sada da casa so timers do Game
 void Ghost::makeVulnerable() {
     if (state != GhostState::RETURNING) {
         state = GhostState::VULNERABLE;
-        vulnerableTimer = 300;
         updateDisplay();
     }
 }
@@ -111,64 +117,161 @@ void Ghost::makeVulnerable() {
 void Ghost::recover() {
     if (state == GhostState::VULNERABLE) {
         state = GhostState::NORMAL;
-        vulnerableTimer = 0;
+        updateDisplay();
+    }
+}
+
+void Ghost::release() {
+    if (state == GhostState::WAITING) {
+        state = GhostState::NORMAL;
         updateDisplay();
     }
 }
 
 void Ghost::respawn() {
-    x = spawnX;
-    y = spawnY;
+    moveTo(spawnX, spawnY);
     state = GhostState::WAITING;
     isActive = true;
+    changeDirection(0, 0);
     updateDisplay();
 }
 
-void Ghost::draw() {
-    attron(COLOR_PAIR(colorPair));
-    mvaddch(y, x, ghostChar);
-    attroff(COLOR_PAIR(colorPair));
+bool Ghost::isVulnerable() const {
+    return state == GhostState::VULNERABLE;
+}
+
+void Ghost::setState(GhostState newState) {
+    state = newState;
+    updateDisplay();
+}
+
+void Ghost::setPosition(int newX, int newY) {
+    moveTo(newX, newY);
+}
+
+void Ghost::setSpeed(int speed) {
+    world->getVelocity(entity).speed = static_cast<uint8_t>(speed);
 }
 
 void Ghost::updateDisplay() {
+    Renderable& renderable = world->getRenderable(entity);
     switch (state) {
     case GhostState::VULNERABLE:
-        ghostChar = 'v';
-        colorPair = 6;  // Branco para vulnervel
+        renderable.glyph = 'v';
+        renderable.color = 6;  // Branco para vulnervel
         break;
     case GhostState::RETURNING:
-        ghostChar = 'x';
-        colorPair = 6;  // Branco para retornando
+        renderable.glyph = 'x';
+        renderable.color = 6;  // Branco para retornando
         break;
     default:
         switch (type) {
         case GhostType::BLINKY:
-            ghostChar = 'B';
-            colorPair = 2;  // Vermelho
+            renderable.glyph = 'B';
+            renderable.color = 2;  // Vermelho
             break;
         case GhostType::PINKY:
-            ghostChar = 'P';
-            colorPair = 3;  // Magenta
+            renderable.glyph = 'P';
+            renderable.color = 3;  // Magenta
             break;
         case GhostType::INKY:
-            ghostChar = 'I';
-            colorPair = 4;  // Cyan
+            renderable.glyph = 'I';
+            renderable.color = 4;  // Cyan
             break;
         case GhostType::CLYDE:
-            ghostChar = 'C';
-            colorPair = 5;  // Verde
+            renderable.glyph = 'C';
+            renderable.color = 5;  // Verde
             break;
         }
     }
 }
 
-// Implementao dos mtodos de movimento especficos dos fantasmas
-// (moveBlinky, movePinky, moveInky, moveClyde continuam os mesmos)
+uint64_t Ghost::getHash() const {
+    // Cada tipo de fantasma  uma entidade diferente na tabela Zobrist
+    const int hashEntity = 1 + static_cast<int>(type);
+    const Velocity& velocity = world->getVelocity(entity);
+    uint64_t counters = (static_cast<uint64_t>(velocity.speed) << 32) |
+        (static_cast<uint64_t>(hashEntity) << 40);
+    if (isPlayerControlled()) {
+        // Direo 3x3 codificada em 0..8, mais o bit de controlo
+        counters ^= static_cast<uint64_t>(0x10 | ((velocity.dx + 1) * 3 + (velocity.dy + 1))) << 48;
+    }
+    return StateHash::position(hashEntity, getX(), getY()) ^
+        StateHash::entityState(hashEntity, static_cast<int>(state) + (isActive ? 0 : 8)) ^
+        StateHash::mix(counters);
+}
+
+void Ghost::saveState(GhostSnapshot& out) const {
+    const Position& position = world->getPosition(entity);
+    const Velocity& velocity = world->getVelocity(entity);
+    out.x = position.x;
+    out.y = position.y;
+    out.stateTimer = 0;   // O Game preenche com o timer da roda
+    out.state = static_cast<uint8_t>(state);
+    out.active = isActive ? 1 : 0;
+    out.speed = velocity.speed;
+    out.directionX = velocity.dx;
+    out.directionY = velocity.dy;
+    out.controlled = world->getAI(entity).playerControlled;
+}
+
+void Ghost::restoreState(const GhostSnapshot& in) {
+    world->getPosition(entity) = Position{ in.x, in.y };
+    world->getVelocity(entity) = Velocity{ in.directionX, in.directionY, in.speed };
+    world->getAI(entity).playerControlled = in.controlled != 0 ? 1 : 0;
+    state = static_cast<GhostState>(in.state);
+    isActive = in.active != 0;
+    updateDisplay();
+}
+
+// Movimento de cada tipo: escolhe uma casa alvo e d um passo em direo a
+// ela. S depende das posies, sem o RNG, para os replays serem iguais.
+
+// Persegue o Pacman diretamente
+void Ghost::moveBlinky(int pacmanX, int pacmanY, Board& board) {
+    int nextX = getX(), nextY = getY();
+    calculateNextMove(pacmanX, pacmanY, board, nextX, nextY);
+    moveTo(nextX, nextY);
+}
+
+// Emboscada: aponta 4 casas para l do Pacman, na linha que vem do fantasma
+void Ghost::movePinky(int pacmanX, int pacmanY, Board& board) {
+    const int dx = (pacmanX > getX()) - (pacmanX < getX());
+    const int dy = (pacmanY > getY()) - (pacmanY < getY());
+    int nextX = getX(), nextY = getY();
+    calculateNextMove(pacmanX + 4 * dx, pacmanY + 4 * dy, board, nextX, nextY);
+    moveTo(nextX, nextY);
+}
+
+// Flanqueia: aponta para a casa simtrica da sua em relao ao Pacman, e
+// por isso ora vem de frente, ora tenta passar para o outro lado
+void Ghost::moveInky(int pacmanX, int pacmanY, Board& board) {
+    int nextX = getX(), nextY = getY();
+    calculateNextMove(2 * pacmanX - getX(), 2 * pacmanY - getY(), board, nextX, nextY);
+    moveTo(nextX, nextY);
+}
+
+// Persegue de longe; a menos de 8 casas foge para o canto inferior esquerdo
+void Ghost::moveClyde(int pacmanX, int pacmanY, Board& board) {
+    const int distance = std::abs(pacmanX - getX()) + std::abs(pacmanY - getY());
+    int nextX = getX(), nextY = getY();
+    if (distance > 8) {
+        calculateNextMove(pacmanX, pacmanY, board, nextX, nextY);
+    }
+    else {
+        calculateNextMove(0, board.getHeight() - 1, board, nextX, nextY);
+    }
+    moveTo(nextX, nextY);
+}
 
 bool Ghost::canMoveTo(int newX, int newY, Board& board) {
     return board.isValidPosition(newX, newY);
 }
 
+void Ghost::moveTo(int newX, int newY) {
+    world->getPosition(entity) = Position{ static_cast<int16_t>(newX), static_cast<int16_t>(newY) };
+}
+
 void Ghost::calculateNextMove(int targetX, int targetY, Board& board, int& nextX, int& nextY) {
     int bestX = nextX;
     int bestY = nextY;
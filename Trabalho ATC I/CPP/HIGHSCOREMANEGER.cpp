@@ -1,15 +1,22 @@
 #include "highscore_manager.h"
+#include "trace.h"
+#include "metrics.h"
 #include <curses.h>
 #include <iostream>
 
-// Construtor padro: quando o HighScoreManager  criado, carrega as pontuaes salvas
-HighScoreManager::HighScoreManager() {
-    // Ao criar o gerenciador, tentamos carregar pontuaes salvas anteriormente
-    loadScores();
+// Construtor padro: as pontuaes salvas s so carregadas quando forem precisas
+HighScoreManager::HighScoreManager() : loaded(false) {
+}
+
+void HighScoreManager::ensureLoaded() {
+    if (!loaded) {
+        loadScores();
+    }
 }
 
 // Mtodo para adicionar uma nova pontuao ao registro
 void HighScoreManager::addScore(const std::string& playerName, int score) {
+    ensureLoaded();
     // Cria uma nova entrada de pontuao com o nome e score do jogador
     ScoreEntry newEntry(playerName, score);
     // Adiciona a nova entrada  lista de pontuaes
@@ -21,23 +28,17 @@ void HighScoreManager::addScore(const std::string& playerName, int score) {
 }
 
 // Mtodo para obter as melhores pontuaes
-std::list<ScoreEntry> HighScoreManager::getTopScores(size_t count) {
-    // Se o nmero de pontuaes for menor que o solicitado, retorna todas
-    if (count > scores.size()) {
-        count = scores.size();
-    }
-    // Cria uma lista temporria com as melhores pontuaes
-    std::list<ScoreEntry> topScores;
-    auto it = scores.begin();
-    // Adiciona as primeiras "count" pontuaes na lista
-    for (size_t i = 0; i < count && it != scores.end(); ++i, ++it) {
-        topScores.push_back(*it);
-    }
-    return topScores;
+const std::list<ScoreEntry>& HighScoreManager::getTopScores() {
+    ensureLoaded();
+    // addScore() e loadScores() mantm a lista ordenada e limitada
+    return scores;
 }
 
 // Mtodo para salvar pontuaes em arquivo
 void HighScoreManager::saveScores() {
+    TRACE_SCOPE("highscore save");   // I/O sncrono no thread do jogo
+    // Sem isto, gravar antes de ler apagaria as pontuaes antigas
+    ensureLoaded();
     // Abre o arquivo para escrita, substituindo contedo anterior
     std::ofstream file(HIGHSCORE_FILE);
     // Verifica se o arquivo foi aberto corretamente
@@ -55,6 +56,7 @@ void HighScoreManager::saveScores() {
         file << entry.playerName << ";" << entry.score << std::endl;
     }
     file.close();
+    Metrics::add(MetricCounter::HIGHSCORE_WRITES);
 
     // Mostra mensagem de sucesso usando PDCurses
     clear();
@@ -66,8 +68,10 @@ void HighScoreManager::saveScores() {
 
 // Mtodo para carregar pontuaes de arquivo
 void HighScoreManager::loadScores() {
+    TRACE_SCOPE("highscore load");
     // Limpa pontuaes atuais antes de carregar
     scores.clear();
+    loaded = true;
     // Abre arquivo para leitura
     std::ifstream file(HIGHSCORE_FILE);
     // Se arquivo no existe, no faz nada
@@ -0,0 +1,199 @@
+#include "input_thread.h"
+#include "trace.h"
+#include <curses.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// InputRing
+
+bool InputRing::push(const InputEvent& event) {
+    const size_t position = tail.load(std::memory_order_relaxed);
+    if (position - head.load(std::memory_order_acquire) == CAPACITY) {
+        return false;
+    }
+    events[position & (CAPACITY - 1)] = event;
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool InputRing::pop(InputEvent& event) {
+    const size_t position = head.load(std::memory_order_relaxed);
+    if (position == tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    event = events[position & (CAPACITY - 1)];
+    head.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// InputLatencyHistogram
+
+const double InputLatencyHistogram::BUCKET_LIMITS_MS[BUCKETS] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, std::numeric_limits<double>::infinity()
+};
+
+void InputLatencyHistogram::record(double latencyMs) {
+    int bucket = 0;
+    while (latencyMs > BUCKET_LIMITS_MS[bucket]) bucket++;   // O ltimo  infinito
+    counts[bucket]++;
+    keys++;
+    meanMs += (latencyMs - meanMs) / keys;
+    maxMs = std::max(maxMs, latencyMs);
+}
+
+double InputLatencyHistogram::percentile(double fraction) const {
+    if (keys == 0) return 0;
+    const long long target = std::max(1LL, static_cast<long long>(std::ceil(fraction * keys)));
+    long long seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= target) return std::min(BUCKET_LIMITS_MS[i], maxMs);
+    }
+    return maxMs;
+}
+
+// ---------------------------------------------------------------------------
+// InputThread
+
+InputThread::InputThread(int fd)
+    : fd(fd),
+    wakeFd(-1),
+    droppedKeys(0),
+    pendingLength(0)
+{
+}
+
+InputThread::~InputThread() {
+    stop();
+}
+
+void InputThread::start() {
+    if (thread.joinable()) return;
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        throw std::runtime_error("Nao foi possivel criar o eventfd da entrada");
+    }
+    pendingLength = 0;
+    thread = std::thread(&InputThread::run, this);
+}
+
+void InputThread::stop() {
+    if (!thread.joinable()) return;
+
+    const uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) {
+        // O eventfd s falha se o contador encher: a thread j vai acordar
+    }
+    thread.join();
+    close(wakeFd);
+    wakeFd = -1;
+}
+
+void InputThread::run() {
+    if (Tracer::isEnabled()) Tracer::setThreadName("input");
+    pollfd fds[2];
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeFd;
+    fds[1].events = POLLIN;
+
+    unsigned char bytes[64];
+    for (;;) {
+        // Com uma sequncia a meio, espera pouco pelo resto
+        const int ready = poll(fds, 2, pendingLength ? ESCAPE_TIMEOUT_MS : -1);
+        const auto now = std::chrono::steady_clock::now();
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (ready == 0) {
+            flushPending();
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            const ssize_t count = read(fd, bytes, sizeof(bytes));
+            if (count > 0) {
+                decode(bytes, static_cast<int>(count), now);
+            }
+            else if (count == 0 || (errno != EINTR && errno != EAGAIN)) {
+                return;   // Terminal fechado
+            }
+        }
+        else if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+            return;
+        }
+    }
+}
+
+void InputThread::decode(const unsigned char* bytes, int count,
+    std::chrono::steady_clock::time_point arrived) {
+    for (int i = 0; i < count; i++) {
+        const unsigned char byte = bytes[i];
+
+        if (pendingLength == 0) {
+            if (byte == 27) {
+                pending[pendingLength++] = byte;
+                pendingArrived = arrived;
+            }
+            else if (byte == '\r') emit(10, arrived);              // Enter, como no getch()
+            else if (byte == 127) emit(KEY_BACKSPACE, arrived);
+            else emit(byte, arrived);
+            continue;
+        }
+
+        pending[pendingLength++] = byte;
+        if (pendingLength == 2) {
+            if (byte == '[' || byte == 'O') continue;
+            // ESC seguido de outra coisa: o ESC vale por si (Alt+tecla)
+            pendingLength = 1;
+            flushPending();
+            i--;
+            continue;
+        }
+
+        // ESC [ ... final (0x40-0x7E): s as setas interessam ao jogo
+        if (byte >= 0x40 && byte <= 0x7E) {
+            if (pendingLength == 3) {
+                switch (byte) {
+                case 'A': emit(KEY_UP, pendingArrived); break;
+                case 'B': emit(KEY_DOWN, pendingArrived); break;
+                case 'C': emit(KEY_RIGHT, pendingArrived); break;
+                case 'D': emit(KEY_LEFT, pendingArrived); break;
+                default: break;
+                }
+            }
+            pendingLength = 0;
+        }
+        else if (pendingLength == static_cast<int>(sizeof(pending))) {
+            pendingLength = 0;   // Sequncia desconhecida demasiado longa
+        }
+    }
+}
+
+void InputThread::flushPending() {
+    for (int i = 0; i < pendingLength; i++) {
+        emit(pending[i], pendingArrived);
+    }
+    pendingLength = 0;
+}
+
+void InputThread::emit(int key, std::chrono::steady_clock::time_point arrived) {
+    InputEvent event;
+    event.key = key;
+    event.arrived = arrived;
+    if (!ring.push(event)) {
+        droppedKeys.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,606 @@
+// Latncia de ponta a ponta da interface: lana o jogo num pseudo-terminal,
+// carrega numa seta num instante conhecido e l o que o jogo escreve at o
+// glyph do Pac-Man mudar de casa (tecla -> tick -> render -> bytes no pty).
+// Corre cada combinao de renderer e ritmo de ticks e mostra p50/p99 e os
+// bytes por frame; com --budget-ms falha se algum p99 passar do oramento.
+//
+// Uso: pacman_latency --game CAMINHO [--renderers curses,ansi] [--tick-rates 10,20]
+//                     [--samples N] [--seed N] [--budget-ms MS] [--timeout SEGUNDOS]
+//                     [-- ARGUMENTOS EXTRA PARA O JOGO]
+#include <pty.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+    const int TERMINAL_WIDTH = 80;
+    const int TERMINAL_HEIGHT = 40;
+
+    // Pac-Man: 'C' no par de cores 1 (amarelo). O Clyde tambm  'C', mas verde.
+    const char PACMAN_GLYPH = 'C';
+    const int PACMAN_COLOR = 3;
+    const char WALL_GLYPH = '#';
+
+    // Frames: escritas separadas por mais do que isto contam como frames diferentes
+    const double FRAME_GAP_MS = 1.0;
+}
+
+// Terminal virtual: o suficiente de xterm para seguir o que o curses e o
+// backend ANSI escrevem (cursor, apagar, inserir/apagar, scroll, SGR de cor)
+class VirtualTerminal {
+public:
+    VirtualTerminal(int width, int height)
+        : width(width), height(height), cells(static_cast<size_t>(width) * height),
+        cursorX(0), cursorY(0), savedX(0), savedY(0), foreground(-1), lastGlyph(' '),
+        wrapPending(false), applicationCursor(false), scrollTop(0), scrollBottom(height - 1),
+        state(ParseState::GROUND), utf8Remaining(0) {}
+
+    void feed(const char* data, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            consume(static_cast<unsigned char>(data[i]));
+        }
+    }
+
+    char at(int x, int y) const {
+        if (x < 0 || y < 0 || x >= width || y >= height) return WALL_GLYPH;
+        return cells[y * width + x].glyph;
+    }
+
+    bool find(char glyph, int color, int& x, int& y) const {
+        for (int row = 0; row < height; row++) {
+            for (int column = 0; column < width; column++) {
+                const Cell& cell = cells[row * width + column];
+                if (cell.glyph == glyph && cell.foreground == color) {
+                    x = column;
+                    y = row;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Com keypad() o curses pede as setas em modo aplicao (ESC O A)
+    const char* arrowSequence(int dx, int dy) const {
+        const char letter = dy < 0 ? 'A' : dy > 0 ? 'B' : dx > 0 ? 'C' : 'D';
+        static char sequence[4];
+        sequence[0] = '\x1b';
+        sequence[1] = applicationCursor ? 'O' : '[';
+        sequence[2] = letter;
+        sequence[3] = '\0';
+        return sequence;
+    }
+
+private:
+    struct Cell {
+        char glyph;
+        int foreground;
+        Cell() : glyph(' '), foreground(-1) {}
+    };
+
+    enum class ParseState {
+        GROUND,
+        ESCAPE,
+        CSI,
+        CHARSET,    // ESC ( X: um byte a ignorar
+        OSC         // At BEL ou ESC
+    };
+
+    int width;
+    int height;
+    std::vector<Cell> cells;
+    int cursorX, cursorY;
+    int savedX, savedY;
+    int foreground;
+    char lastGlyph;        // Para REP (CSI b)
+    bool wrapPending;
+    bool applicationCursor;
+    int scrollTop, scrollBottom;
+    ParseState state;
+    std::string parameters;
+    int utf8Remaining;
+
+    void consume(unsigned char byte) {
+        switch (state) {
+        case ParseState::ESCAPE:
+            state = ParseState::GROUND;
+            switch (byte) {
+            case '[': state = ParseState::CSI; parameters.clear(); break;
+            case ']': state = ParseState::OSC; break;
+            case '(': case ')': case '*': case '+': state = ParseState::CHARSET; break;
+            case '7': savedX = cursorX; savedY = cursorY; break;
+            case '8': moveTo(savedX, savedY); break;
+            case 'D': lineFeed(); break;
+            case 'E': cursorX = 0; lineFeed(); break;
+            case 'M': reverseIndex(); break;
+            case 'c': reset(); break;
+            default: break;   // ESC = / ESC > e afins
+            }
+            return;
+        case ParseState::CSI:
+            if (byte >= 0x40 && byte <= 0x7E) {
+                state = ParseState::GROUND;
+                controlSequence(static_cast<char>(byte));
+            }
+            else {
+                parameters += static_cast<char>(byte);
+            }
+            return;
+        case ParseState::CHARSET:
+            state = ParseState::GROUND;
+            return;
+        case ParseState::OSC:
+            if (byte == 7) state = ParseState::GROUND;
+            else if (byte == 27) state = ParseState::ESCAPE;
+            return;
+        case ParseState::GROUND:
+            break;
+        }
+
+        if (utf8Remaining > 0 && (byte & 0xC0) == 0x80) {
+            utf8Remaining--;   // Continuao: o carcter j ocupou a casa
+            return;
+        }
+        utf8Remaining = 0;
+
+        switch (byte) {
+        case 27: state = ParseState::ESCAPE; return;
+        case '\r': cursorX = 0; wrapPending = false; return;
+        case '\n': case '\v': case '\f': lineFeed(); return;
+        case '\b': if (cursorX > 0) cursorX--; wrapPending = false; return;
+        case '\t': cursorX = std::min(width - 1, (cursorX / 8 + 1) * 8); return;
+        default: break;
+        }
+        if (byte < 0x20 || byte == 0x7F) return;
+
+        if (byte >= 0x80) {
+            utf8Remaining = (byte & 0xE0) == 0xC0 ? 1 : (byte & 0xF0) == 0xE0 ? 2 : 3;
+            put('?');
+            return;
+        }
+        put(static_cast<char>(byte));
+    }
+
+    void put(char glyph) {
+        if (wrapPending) {
+            cursorX = 0;
+            lineFeed();
+        }
+        Cell& cell = cells[cursorY * width + cursorX];
+        cell.glyph = glyph;
+        cell.foreground = foreground;
+        lastGlyph = glyph;
+        if (cursorX == width - 1) wrapPending = true;
+        else cursorX++;
+    }
+
+    void lineFeed() {
+        wrapPending = false;
+        if (cursorY == scrollBottom) scrollUp(scrollTop, scrollBottom, 1);
+        else if (cursorY < height - 1) cursorY++;
+    }
+
+    void reverseIndex() {
+        wrapPending = false;
+        if (cursorY == scrollTop) scrollDown(scrollTop, scrollBottom, 1);
+        else if (cursorY > 0) cursorY--;
+    }
+
+    void scrollUp(int top, int bottom, int lines) {
+        for (int i = 0; i < lines; i++) {
+            std::copy(cells.begin() + (top + 1) * width, cells.begin() + (bottom + 1) * width,
+                cells.begin() + top * width);
+            std::fill(cells.begin() + bottom * width, cells.begin() + (bottom + 1) * width, Cell());
+        }
+    }
+
+    void scrollDown(int top, int bottom, int lines) {
+        for (int i = 0; i < lines; i++) {
+            std::copy_backward(cells.begin() + top * width, cells.begin() + bottom * width,
+                cells.begin() + (bottom + 1) * width);
+            std::fill(cells.begin() + top * width, cells.begin() + (top + 1) * width, Cell());
+        }
+    }
+
+    void erase(int from, int to) {   // ndices de clulas, [from, to)
+        std::fill(cells.begin() + std::max(0, from), cells.begin() + std::min(width * height, to), Cell());
+    }
+
+    void moveTo(int x, int y) {
+        cursorX = std::max(0, std::min(width - 1, x));
+        cursorY = std::max(0, std::min(height - 1, y));
+        wrapPending = false;
+    }
+
+    void reset() {
+        std::fill(cells.begin(), cells.end(), Cell());
+        cursorX = cursorY = 0;
+        foreground = -1;
+        scrollTop = 0;
+        scrollBottom = height - 1;
+        wrapPending = false;
+    }
+
+    void controlSequence(char final) {
+        const bool privateMode = !parameters.empty() && (parameters[0] == '?' || parameters[0] == '>');
+        std::vector<int> values;
+        const char* p = parameters.c_str() + (privateMode ? 1 : 0);
+        for (;;) {
+            values.push_back(*p >= '0' && *p <= '9' ? std::atoi(p) : -1);
+            p = std::strchr(p, ';');
+            if (!p) break;
+            p++;
+        }
+        const int first = values[0];
+        const int n = first > 0 ? first : 1;
+        const int cursor = cursorY * width + cursorX;
+
+        if (privateMode) {
+            if ((final == 'h' || final == 'l') && first == 1) applicationCursor = final == 'h';
+            return;
+        }
+
+        switch (final) {
+        case 'A': moveTo(cursorX, cursorY - n); break;
+        case 'B': moveTo(cursorX, cursorY + n); break;
+        case 'C': moveTo(cursorX + n, cursorY); break;
+        case 'D': moveTo(cursorX - n, cursorY); break;
+        case 'E': moveTo(0, cursorY + n); break;
+        case 'F': moveTo(0, cursorY - n); break;
+        case 'G': case '`': moveTo(n - 1, cursorY); break;
+        case 'd': moveTo(cursorX, n - 1); break;
+        case 'H': case 'f':
+            moveTo((values.size() > 1 && values[1] > 0 ? values[1] : 1) - 1, n - 1);
+            break;
+        case 'J':
+            if (first <= 0) erase(cursor, width * height);
+            else if (first == 1) erase(0, cursor + 1);
+            else erase(0, width * height);
+            break;
+        case 'K':
+            if (first <= 0) erase(cursor, (cursorY + 1) * width);
+            else if (first == 1) erase(cursorY * width, cursor + 1);
+            else erase(cursorY * width, (cursorY + 1) * width);
+            break;
+        case 'X': erase(cursor, std::min(cursor + n, (cursorY + 1) * width)); break;
+        case '@': {
+            const int end = (cursorY + 1) * width;
+            const int count = std::min(n, end - cursor);
+            std::copy_backward(cells.begin() + cursor, cells.begin() + end - count, cells.begin() + end);
+            erase(cursor, cursor + count);
+            break;
+        }
+        case 'P': {
+            const int end = (cursorY + 1) * width;
+            const int count = std::min(n, end - cursor);
+            std::copy(cells.begin() + cursor + count, cells.begin() + end, cells.begin() + cursor);
+            erase(end - count, end);
+            break;
+        }
+        case 'L':
+            if (cursorY >= scrollTop && cursorY <= scrollBottom) scrollDown(cursorY, scrollBottom, n);
+            break;
+        case 'M':
+            if (cursorY >= scrollTop && cursorY <= scrollBottom) scrollUp(cursorY, scrollBottom, n);
+            break;
+        case 'S': scrollUp(scrollTop, scrollBottom, n); break;
+        case 'T': scrollDown(scrollTop, scrollBottom, n); break;
+        case 'b': for (int i = 0; i < n; i++) put(lastGlyph); break;
+        case 'r':
+            scrollTop = first > 0 ? first - 1 : 0;
+            scrollBottom = values.size() > 1 && values[1] > 0 ? values[1] - 1 : height - 1;
+            moveTo(0, 0);
+            break;
+        case 's': savedX = cursorX; savedY = cursorY; break;
+        case 'u': moveTo(savedX, savedY); break;
+        case 'm':
+            for (size_t i = 0; i < values.size(); i++) {
+                const int value = values[i];
+                if (value <= 0 || value == 39) foreground = -1;
+                else if (value >= 30 && value <= 37) foreground = value - 30;
+                else if (value >= 90 && value <= 97) foreground = value - 90 + 8;
+                else if ((value == 38 || value == 48) && i + 2 < values.size() && values[i + 1] == 5) {
+                    if (value == 38) foreground = values[i + 2];
+                    i += 2;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+struct BenchConfig {
+    const char* gamePath;
+    std::vector<std::string> renderers;
+    std::vector<int> tickRates;
+    int samples;
+    uint64_t seed;
+    double budgetMs;           // 0 = sem oramento
+    int timeoutSeconds;        // Por combinao
+    std::vector<std::string> gameArguments;
+
+    BenchConfig() : gamePath(nullptr), samples(50), seed(1), budgetMs(0), timeoutSeconds(60) {}
+};
+
+struct BenchResult {
+    std::string renderer;
+    int tickRate;
+    std::vector<double> latenciesMs;
+    long long bytes;           // Escritos pelo jogo durante a partida
+    long long frames;          // Rajadas de escrita separadas por > FRAME_GAP_MS
+    int discarded;             // Pac-Man moveu-se por outro motivo (morte) ou no se moveu
+
+    BenchResult() : tickRate(0), bytes(0), frames(0), discarded(0) {}
+};
+
+static double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+static double millisecondsBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+static void writeAll(int fd, const char* data) {
+    size_t size = std::strlen(data);
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Erro ao escrever no pseudo-terminal");
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+static pid_t launchGame(const BenchConfig& config, const std::string& renderer, int tickRate, int& master) {
+    winsize size;
+    std::memset(&size, 0, sizeof(size));
+    size.ws_col = TERMINAL_WIDTH;
+    size.ws_row = TERMINAL_HEIGHT;
+
+    const pid_t child = forkpty(&master, nullptr, nullptr, &size);
+    if (child < 0) {
+        throw std::runtime_error("forkpty falhou");
+    }
+    if (child == 0) {
+        setenv("TERM", "xterm-256color", 1);
+        const std::string rate = std::to_string(tickRate);
+        const std::string seed = std::to_string(config.seed);
+        std::vector<const char*> arguments = {
+            config.gamePath, "--renderer", renderer.c_str(), "--tick-rate", rate.c_str(),
+            "--seed", seed.c_str()
+        };
+        for (const auto& argument : config.gameArguments) {
+            arguments.push_back(argument.c_str());
+        }
+        arguments.push_back(nullptr);
+        execv(config.gamePath, const_cast<char* const*>(arguments.data()));
+        _exit(127);
+    }
+    return child;
+}
+
+// Uma partida: entra no jogo e recolhe amostras at ter config.samples,
+// o jogo acabar ou passar o tempo limite
+static BenchResult runOnce(const BenchConfig& config, const std::string& renderer, int tickRate) {
+    enum class Phase {
+        MENU,        //  espera do menu para carregar em Enter
+        STILL,       //  espera de ver o Pac-Man parado
+        MEASURING    // Tecla enviada,  espera do movimento
+    };
+
+    BenchResult result;
+    result.renderer = renderer;
+    result.tickRate = tickRate;
+
+    int master = -1;
+    const pid_t child = launchGame(config, renderer, tickRate, master);
+
+    VirtualTerminal terminal(TERMINAL_WIDTH, TERMINAL_HEIGHT);
+    const double tickMs = 1000.0 / tickRate;
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::seconds(config.timeoutSeconds);
+
+    Phase phase = Phase::MENU;
+    bool playing = false;
+    Clock::time_point lastOutput = start;
+    Clock::time_point lastMove = start;
+    Clock::time_point keySent;
+    Clock::time_point lastSeen = start;
+    int pacmanX = -1, pacmanY = -1;
+    int keyDx = 0, keyDy = 0;
+    double settleMs = 0;
+    uint64_t jitter = config.seed | 1;
+    char buffer[16384];
+
+    while (static_cast<int>(result.latenciesMs.size()) < config.samples && Clock::now() < deadline) {
+        pollfd pfd;
+        pfd.fd = master;
+        pfd.events = POLLIN;
+        const int ready = poll(&pfd, 1, 1);
+        const auto now = Clock::now();
+
+        if (ready > 0) {
+            const ssize_t count = read(master, buffer, sizeof(buffer));
+            if (count <= 0) break;   // O jogo terminou
+
+            terminal.feed(buffer, static_cast<size_t>(count));
+            if (playing) {
+                result.bytes += count;
+                if (millisecondsBetween(lastOutput, now) > FRAME_GAP_MS) result.frames++;
+            }
+            lastOutput = now;
+
+            int x, y;
+            if (terminal.find(PACMAN_GLYPH, PACMAN_COLOR, x, y)) {
+                playing = true;
+                lastSeen = now;
+                if (x != pacmanX || y != pacmanY) {
+                    if (phase == Phase::MEASURING) {
+                        // S conta se andou para onde a tecla mandou
+                        const bool expected = (keyDx == 0 || (x - pacmanX) * keyDx > 0) &&
+                            (keyDy == 0 || (y - pacmanY) * keyDy > 0) &&
+                            (keyDx != 0 || x == pacmanX) && (keyDy != 0 || y == pacmanY);
+                        if (expected) result.latenciesMs.push_back(millisecondsBetween(keySent, now));
+                        else result.discarded++;
+                        phase = Phase::STILL;
+                    }
+                    else if (phase == Phase::MENU) {
+                        phase = Phase::STILL;
+                    }
+                    pacmanX = x;
+                    pacmanY = y;
+                    lastMove = now;
+                }
+            }
+        }
+
+        if (phase == Phase::MENU && !playing && millisecondsBetween(lastOutput, now) > 200 &&
+            lastOutput != start) {
+            writeAll(master, "\r");   // "Novo Jogo"  a primeira opo
+            lastOutput = now;
+        }
+        else if (phase == Phase::STILL && playing &&
+            millisecondsBetween(lastMove, now) > 3 * tickMs + 20 + settleMs) {
+            // Parado contra uma parede: escolhe uma direo livre
+            static const int DIRECTIONS[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+            const int offset = static_cast<int>(result.latenciesMs.size() + result.discarded) % 4;
+            for (int i = 0; i < 4; i++) {
+                const int* direction = DIRECTIONS[(offset + i) % 4];
+                const char next = terminal.at(pacmanX + direction[0], pacmanY + direction[1]);
+                if (next != WALL_GLYPH && pacmanY + direction[1] > 0) {
+                    keyDx = direction[0];
+                    keyDy = direction[1];
+                    keySent = Clock::now();
+                    writeAll(master, terminal.arrowSequence(keyDx, keyDy));
+                    phase = Phase::MEASURING;
+                    // Espera extra aleatria de at um tick: as teclas caem em
+                    // qualquer fase do tick e no sempre no mesmo ponto
+                    jitter ^= jitter << 13;
+                    jitter ^= jitter >> 7;
+                    jitter ^= jitter << 17;
+                    settleMs = tickMs * static_cast<double>(jitter % 1000) / 1000.0;
+                    break;
+                }
+            }
+        }
+        else if (phase == Phase::MEASURING && millisecondsBetween(keySent, now) > 20 * tickMs + 500) {
+            result.discarded++;
+            phase = Phase::STILL;
+            lastMove = now;
+        }
+
+        // Sem Pac-Man no ecr h muito tempo: fim de jogo
+        if (playing && millisecondsBetween(lastSeen, now) > 3000) break;
+    }
+
+    kill(child, SIGTERM);
+    int status;
+    waitpid(child, &status, 0);
+    close(master);
+    return result;
+}
+
+static std::vector<std::string> splitList(const char* text) {
+    std::vector<std::string> items;
+    std::string item;
+    for (const char* p = text; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (!item.empty()) items.push_back(item);
+            item.clear();
+            if (*p == '\0') break;
+        }
+        else {
+            item += *p;
+        }
+    }
+    return items;
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    config.renderers = { "curses", "ansi" };
+    config.tickRates = { 10, 20 };
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--game") == 0 && i + 1 < argc) config.gamePath = argv[++i];
+        else if (std::strcmp(argv[i], "--renderers") == 0 && i + 1 < argc) config.renderers = splitList(argv[++i]);
+        else if (std::strcmp(argv[i], "--tick-rates") == 0 && i + 1 < argc) {
+            config.tickRates.clear();
+            for (const auto& rate : splitList(argv[++i])) {
+                if (std::atoi(rate.c_str()) > 0) config.tickRates.push_back(std::atoi(rate.c_str()));
+            }
+        }
+        else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) config.samples = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--budget-ms") == 0 && i + 1 < argc) config.budgetMs = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) config.timeoutSeconds = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--") == 0) {
+            for (i++; i < argc; i++) config.gameArguments.push_back(argv[i]);
+        }
+    }
+    if (!config.gamePath) {
+        std::fprintf(stderr, "Uso: %s --game CAMINHO [--renderers curses,ansi] [--tick-rates 10,20]"
+            " [--samples N] [--seed N] [--budget-ms MS] [--timeout SEGUNDOS] [-- ARGUMENTOS]\n", argv[0]);
+        return 2;
+    }
+    if (config.samples <= 0) config.samples = 1;
+    if (config.timeoutSeconds <= 0) config.timeoutSeconds = 60;
+
+    std::vector<BenchResult> results;
+    try {
+        for (const auto& renderer : config.renderers) {
+            for (int rate : config.tickRates) {
+                results.push_back(runOnce(config, renderer, rate));
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+
+    // Tecla escrita no pty -> bytes com o Pac-Man noutra casa lidos do pty
+    bool overBudget = false;
+    std::printf("%-8s %8s %9s %8s %8s %8s %12s %10s\n",
+        "render", "ticks/s", "amostras", "p50 ms", "p99 ms", "max ms", "bytes/frame", "perdidas");
+    for (const auto& result : results) {
+        const double p99 = percentile(result.latenciesMs, 0.99);
+        const double worst = result.latenciesMs.empty() ? 0 :
+            *std::max_element(result.latenciesMs.begin(), result.latenciesMs.end());
+        std::printf("%-8s %8d %9zu %8.1f %8.1f %8.1f %12.1f %10d\n",
+            result.renderer.c_str(), result.tickRate, result.latenciesMs.size(),
+            percentile(result.latenciesMs, 0.50), p99, worst,
+            result.frames > 0 ? static_cast<double>(result.bytes) / result.frames : 0.0,
+            result.discarded);
+        if (config.budgetMs > 0 && (result.latenciesMs.empty() || p99 > config.budgetMs)) {
+            overBudget = true;
+        }
+    }
+    if (overBudget) {
+        std::printf("p99 acima do orcamento de %.1f ms\n", config.budgetMs);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "level_arena.h"
+#include <stdexcept>
+#include <string>
+
+LevelArena::LevelArena(size_t capacity)
+    : memory(new unsigned char[capacity]), capacity(capacity), used(0), highWater(0), resets(0) {
+}
+
+void* LevelArena::allocate(size_t bytes, size_t alignment) {
+    // Alinha o endereo, no o deslocamento: o bloco s garante o alinhamento do new[]
+    const uintptr_t base = reinterpret_cast<uintptr_t>(memory.get());
+    const uintptr_t start = (base + used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    const size_t offset = static_cast<size_t>(start - base);
+    if (offset > capacity || bytes > capacity - offset) {
+        throw std::runtime_error("Arena do nvel esgotada (" + std::to_string(capacity) + " bytes)");
+    }
+    used = offset + bytes;
+    if (used > highWater) highWater = used;
+    return memory.get() + offset;
+}
+
+void LevelArena::reset() {
+    used = 0;
+    resets++;
+}
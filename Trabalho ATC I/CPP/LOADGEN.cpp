@@ -0,0 +1,372 @@
+// Gerador de carga para o servidor: abre muitas sesses, carrega nas setas
+// de vez em quando e mede o ritmo e o tamanho dos frames recebidos.
+// Uso: pacman_loadgen [--host ENDERECO] [--port N | --unix CAMINHO] [--sessions N]
+//                     [--threads N] [--duration SEGUNDOS] [--input-interval FRAMES]
+//                     [--spectators N] [--verify]
+#include "game_server.h"
+#include "game_random.h"
+#include "game_snapshot.h"
+#include "snapshot_delta.h"
+#include "replay.h"
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct LoadConfig {
+    const char* host;
+    int port;
+    const char* unixPath;
+    int sessions;
+    int threads;
+    int durationSeconds;
+    int inputInterval;     // Frames entre teclas
+    int spectators;        // Espectadores por sesso
+    bool verify;           // Reconstri o estado com os deltas
+
+    LoadConfig() : host("127.0.0.1"), port(7777), unixPath(nullptr), sessions(1000),
+        threads(0), durationSeconds(10), inputInterval(15), spectators(0), verify(false) {}
+};
+
+// Resultados de uma thread
+struct LoadResult {
+    long long connected;
+    long long watching;       // Espectadores ligados
+    long long failed;
+    long long keyframes;
+    long long deltas;
+    long long bytes;
+    long long inputs;
+    long long lateFrames;     // Intervalo entre frames acima de 2 ticks
+    long long errors;         // Deltas invlidos ou ligaes perdidas
+    double maxGapMs;
+
+    LoadResult() : connected(0), watching(0), failed(0), keyframes(0), deltas(0), bytes(0), inputs(0),
+        lateFrames(0), errors(0), maxGapMs(0) {}
+};
+
+struct Client {
+    int fd;
+    bool spectator;
+    bool watchersOpened;   // J abriu os seus espectadores
+    bool welcomed;         // J recebeu o WELCOME
+    uint32_t sessionId;
+    GameRandom rng;
+    uint8_t buffer[8192];
+    size_t used;
+    int tickRate;
+    int framesUntilInput;
+    bool hasFrame;
+    Clock::time_point lastFrame;
+    GameSnapshot state;
+};
+
+static int connectClient(const LoadConfig& config, const sockaddr* address, socklen_t length) {
+    int fd = socket(address->sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, address, length) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (!config.unixPath) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    return fd;
+}
+
+static void sendAll(int fd, const uint8_t* data, size_t size) {
+    // Mensagens de poucos bytes: um socket cheio aqui  erro do teste
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            throw std::runtime_error("Ligacao perdida");
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+}
+
+// L os frames completos em buffer; devolve false se a ligao tiver de fechar
+static bool readFrames(Client& client, const LoadConfig& config, LoadResult& result) {
+    for (;;) {
+        ssize_t received = recv(client.fd, client.buffer + client.used,
+            sizeof(client.buffer) - client.used, 0);
+        if (received == 0) return false;
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.used += static_cast<size_t>(received);
+        result.bytes += received;
+
+        size_t pos = 0;
+        while (client.used - pos >= SERVER_FRAME_HEADER_SIZE) {
+            const uint8_t* header = client.buffer + pos;
+            const size_t size = static_cast<size_t>(header[0] | (header[1] << 8));
+            if (client.used - pos < SERVER_FRAME_HEADER_SIZE + size) break;
+            const uint8_t* data = header + SERVER_FRAME_HEADER_SIZE;
+            const ServerMessage type = static_cast<ServerMessage>(header[2]);
+
+            if (type == ServerMessage::WELCOME) {
+                client.welcomed = true;
+                if (size >= 6) {
+                    client.sessionId = static_cast<uint32_t>(data[0] | (data[1] << 8) |
+                        (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24));
+                    client.tickRate = data[4] | (data[5] << 8);
+                }
+            }
+            else {
+                const Clock::time_point now = Clock::now();
+                if (client.hasFrame) {
+                    double gapMs = std::chrono::duration<double, std::milli>(now - client.lastFrame).count();
+                    result.maxGapMs = std::max(result.maxGapMs, gapMs);
+                    if (gapMs > 2000.0 / std::max(1, client.tickRate)) result.lateFrames++;
+                }
+                client.hasFrame = true;
+                client.lastFrame = now;
+
+                if (type == ServerMessage::KEYFRAME) {
+                    result.keyframes++;
+                    if (config.verify && size == sizeof(GameSnapshot)) {
+                        std::memcpy(&client.state, data, sizeof(GameSnapshot));
+                    }
+                }
+                else {
+                    result.deltas++;
+                    if (config.verify) {
+                        try {
+                            if (applySnapshotDelta(data, size, client.state) != size) result.errors++;
+                        }
+                        catch (const std::exception&) {
+                            result.errors++;
+                        }
+                    }
+                }
+
+                // De vez em quando, uma direo nova (s o jogador)
+                if (!client.spectator && --client.framesUntilInput <= 0) {
+                    uint8_t input[CLIENT_INPUT_SIZE] = {
+                        static_cast<uint8_t>(ClientMessage::INPUT),
+                        static_cast<uint8_t>(client.rng.nextInt(4))  // UP..RIGHT
+                    };
+                    sendAll(client.fd, input, sizeof(input));
+                    result.inputs++;
+                    client.framesUntilInput = config.inputInterval;
+                }
+            }
+            pos += SERVER_FRAME_HEADER_SIZE + size;
+        }
+        client.used -= pos;
+        std::memmove(client.buffer, client.buffer + pos, client.used);
+    }
+}
+
+// Liga um cliente e manda a primeira mensagem (JOIN ou WATCH)
+static Client* openClient(const LoadConfig& config, const sockaddr_storage* address,
+    socklen_t length, int epollFd, const uint8_t* hello, size_t helloSize,
+    std::vector<std::unique_ptr<Client>>& clients, LoadResult* result) {
+    int fd = connectClient(config, reinterpret_cast<const sockaddr*>(address), length);
+    if (fd < 0) {
+        result->failed++;
+        return nullptr;
+    }
+    std::unique_ptr<Client> client(new Client());
+    client->fd = fd;
+    client->spectator = hello[0] == static_cast<uint8_t>(ClientMessage::WATCH);
+    client->watchersOpened = false;
+    client->welcomed = false;
+    client->sessionId = 0;
+    client->used = 0;
+    client->tickRate = 60;
+    client->framesUntilInput = config.inputInterval;
+    client->hasFrame = false;
+    try {
+        sendAll(fd, hello, helloSize);
+    }
+    catch (const std::exception&) {
+        close(fd);
+        result->failed++;
+        return nullptr;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = client.get();
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    clients.push_back(std::move(client));
+    (clients.back()->spectator ? result->watching : result->connected)++;
+    return clients.back().get();
+}
+
+static void runThread(const LoadConfig& config, int first, int count,
+    const sockaddr_storage* address, socklen_t length, LoadResult* result) {
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<std::unique_ptr<Client>> clients;
+    clients.reserve(static_cast<size_t>(count) * (1 + static_cast<size_t>(config.spectators)));
+
+    for (int i = 0; i < count; i++) {
+        uint8_t join[CLIENT_JOIN_SIZE];
+        join[0] = static_cast<uint8_t>(ClientMessage::JOIN);
+        const uint64_t seed = static_cast<uint64_t>(first + i) + 1;
+        for (int b = 0; b < 8; b++) join[1 + b] = static_cast<uint8_t>(seed >> (8 * b));
+        Client* client = openClient(config, address, length, epollFd, join, sizeof(join),
+            clients, result);
+        if (client) {
+            client->rng.reseed(seed);
+        }
+    }
+
+    const Clock::time_point deadline = Clock::now() + std::chrono::seconds(config.durationSeconds);
+    epoll_event events[256];
+    while (Clock::now() < deadline) {
+        int ready = epoll_wait(epollFd, events, 256, 100);
+        for (int i = 0; i < ready; i++) {
+            Client& client = *static_cast<Client*>(events[i].data.ptr);
+            if (client.fd < 0) continue;
+            bool keep;
+            try {
+                keep = readFrames(client, config, *result);
+            }
+            catch (const std::exception&) {
+                keep = false;
+            }
+            if (!keep) {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+                close(client.fd);
+                client.fd = -1;
+                result->errors++;
+                continue;
+            }
+
+            // Com o id da sesso j se podem ligar os espectadores
+            if (!client.spectator && client.welcomed && !client.watchersOpened) {
+                client.watchersOpened = true;
+                uint8_t watch[CLIENT_WATCH_SIZE];
+                watch[0] = static_cast<uint8_t>(ClientMessage::WATCH);
+                for (int b = 0; b < 4; b++) watch[1 + b] = static_cast<uint8_t>(client.sessionId >> (8 * b));
+                for (int w = 0; w < config.spectators; w++) {
+                    openClient(config, address, length, epollFd, watch, sizeof(watch), clients, result);
+                }
+            }
+        }
+    }
+
+    for (auto& client : clients) {
+        if (client->fd >= 0) close(client->fd);
+    }
+    close(epollFd);
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--host") == 0 && i + 1 < argc) config.host = argv[++i];
+        else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) config.port = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--unix") == 0 && i + 1 < argc) config.unixPath = argv[++i];
+        else if (std::strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) config.sessions = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) config.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--duration") == 0 && i + 1 < argc) config.durationSeconds = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--input-interval") == 0 && i + 1 < argc) config.inputInterval = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--spectators") == 0 && i + 1 < argc) config.spectators = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--verify") == 0) config.verify = true;
+    }
+    if (config.threads <= 0) config.threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    if (config.inputInterval <= 0) config.inputInterval = 1;
+    if (config.spectators < 0) config.spectators = 0;
+
+    // Um descritor por sesso
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    sockaddr_storage address;
+    socklen_t length = 0;
+    std::memset(&address, 0, sizeof(address));
+    if (config.unixPath) {
+        sockaddr_un* un = reinterpret_cast<sockaddr_un*>(&address);
+        if (std::strlen(config.unixPath) >= sizeof(un->sun_path)) {
+            std::fprintf(stderr, "Erro: caminho de socket Unix demasiado longo\n");
+            return 2;
+        }
+        un->sun_family = AF_UNIX;
+        std::strcpy(un->sun_path, config.unixPath);
+        length = sizeof(sockaddr_un);
+    }
+    else {
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        const std::string port = std::to_string(config.port);
+        if (getaddrinfo(config.host, port.c_str(), &hints, &found) != 0 || !found) {
+            std::fprintf(stderr, "Erro: endereco invalido %s\n", config.host);
+            return 2;
+        }
+        std::memcpy(&address, found->ai_addr, found->ai_addrlen);
+        length = found->ai_addrlen;
+        freeaddrinfo(found);
+    }
+
+    std::vector<LoadResult> results(static_cast<size_t>(config.threads));
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    int first = 0;
+    for (int t = 0; t < config.threads; t++) {
+        int count = config.sessions / config.threads + (t < config.sessions % config.threads ? 1 : 0);
+        threads.emplace_back(runThread, std::cref(config), first, count, &address, length, &results[t]);
+        first += count;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LoadResult total;
+    for (const auto& r : results) {
+        total.connected += r.connected;
+        total.watching += r.watching;
+        total.failed += r.failed;
+        total.keyframes += r.keyframes;
+        total.deltas += r.deltas;
+        total.bytes += r.bytes;
+        total.inputs += r.inputs;
+        total.lateFrames += r.lateFrames;
+        total.errors += r.errors;
+        total.maxGapMs = std::max(total.maxGapMs, r.maxGapMs);
+    }
+    const long long frames = total.keyframes + total.deltas;
+    std::printf("sessoes: %lld ligadas, %lld espectadores, %lld falharam\n",
+        total.connected, total.watching, total.failed);
+    std::printf("frames: %lld (%lld keyframes) em %.1f s = %.0f frames/s, %.1f bytes/frame\n",
+        frames, total.keyframes, seconds, frames / seconds,
+        frames ? static_cast<double>(total.bytes) / frames : 0.0);
+    std::printf("entradas: %lld  frames atrasados: %lld  maior intervalo: %.1f ms  erros: %lld\n",
+        total.inputs, total.lateFrames, total.maxGapMs, total.errors);
+    return total.errors || total.failed ? 1 : 0;
+}
@@ -0,0 +1,486 @@
+#include "game.h"
+#include "game_loop.h"
+#include "netplay.h"
+#include "pacman_ui.h"
+#include "replay.h"
+#include "replay_stream.h"
+#include "trace.h"
+#include "flight_recorder.h"
+#include "metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Reproduz um replay sem interface e confirma o resultado gravado.
+// Com streamPath, exporta tambm o stream de keyframes/deltas.
+static int runReplay(const char* path, const char* streamPath) {
+    try {
+        ReplayPlayer player;
+        player.load(path);
+
+        std::unique_ptr<ReplayStreamWriter> stream;
+        if (streamPath) {
+            stream.reset(new ReplayStreamWriter(streamPath));
+        }
+
+        Game game(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT);
+        game.setStreamWriter(stream.get());
+        ReplayResult result = player.play(game);
+        if (stream) {
+            stream->finish();
+            std::printf("stream: %u frames, %zu keyframes, %llu bytes\n",
+                stream->getFrameCount(), stream->getKeyframeCount(),
+                static_cast<unsigned long long>(stream->getBytesWritten()));
+        }
+
+        const ReplaySummary& recorded = player.getRecordedSummary();
+        std::printf("replay: %u ticks em %.2f ms (%.0fx tempo real a 10 ticks/s)\n",
+            result.summary.totalTicks, result.elapsedMs,
+            result.elapsedMs > 0 ? (result.summary.totalTicks * 100.0) / result.elapsedMs : 0.0);
+        std::printf("gravado:    score %d  vidas %d  nivel %d\n",
+            recorded.score, recorded.lives, recorded.level);
+        std::printf("reproduzido: score %d  vidas %d  nivel %d  -> %s\n",
+            result.summary.score, result.summary.lives, result.summary.level,
+            result.matchesRecording ? "OK" : "DIVERGE");
+        std::printf("checksums conferidos: %d", result.checksumsVerified);
+        if (result.divergedAtTick) {
+            std::printf("  primeira divergencia no tick %u", result.divergedAtTick);
+        }
+        std::printf("\n");
+        return result.matchesRecording ? 0 : 1;
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+}
+
+// Mostra o estado guardado num stream, num dado frame
+static int runInspect(const char* path, uint32_t frame) {
+    try {
+        ReplayStreamReader reader;
+        reader.open(path);
+
+        GameSnapshot snapshot;
+        reader.seek(frame, snapshot);
+        std::printf("frame %u/%u (tick %u): score %d  vidas %d  nivel %d  pellets %d\n",
+            frame, reader.getLastFrame(), snapshot.tickCount, snapshot.score,
+            snapshot.lives, snapshot.level, snapshot.remainingPellets);
+        std::printf("pacman (%d, %d)", snapshot.pacman.x, snapshot.pacman.y);
+        for (int i = 0; i < snapshot.ghostCount; i++) {
+            std::printf("  fantasma %d (%d, %d)", i, snapshot.ghosts[i].x, snapshot.ghosts[i].y);
+        }
+        std::printf("\n");
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+}
+
+// Mostra os ticks guardados num despejo do gravador de voo
+static int runFlightDump(const char* path) {
+    try {
+        FlightDumpHeader header;
+        std::vector<FlightRecord> records;
+        FlightRecorder::readDump(path, header, records);
+        std::printf("despejo: %s  %s  %u ticks a %u ticks/s  seed %llu\n", header.reason, header.detail,
+            header.recordCount, header.ticksPerSecond, static_cast<unsigned long long>(header.seed));
+        for (const FlightRecord& record : records) {
+            std::printf("tick %6u %7u us  estado %u  pontos %6d  vidas %u  nivel %u  pacman (%d,%d)%+d%+d",
+                record.tick, record.tickMicros, record.gameState, record.score, record.lives, record.level,
+                record.pacmanX, record.pacmanY, record.pacmanDirectionX, record.pacmanDirectionY);
+            for (int i = 0; i < FlightRecord::MAX_GHOSTS; i++) {
+                std::printf("  f%d (%d,%d)/%u", i, record.ghostX[i], record.ghostY[i], record.ghostState[i]);
+            }
+            if (record.events != 0) {
+                static const char* const EVENT_NAMES[] = { "pellet", "power", "fantasma", "vida", "nivel" };
+                std::printf("  eventos");
+                for (int i = 0; i < static_cast<int>(GameEventType::COUNT); i++) {
+                    if (record.events & (1u << i)) std::printf(" %s", EVENT_NAMES[i]);
+                }
+            }
+            if (record.inputCount > 0) {
+                std::printf("  teclas");
+                for (int i = 0; i < record.inputCount && i < FlightRecord::MAX_INPUTS; i++) {
+                    std::printf(" %d", record.inputs[i]);
+                }
+                if (record.inputCount > FlightRecord::MAX_INPUTS) {
+                    std::printf(" (+%d)", record.inputCount - FlightRecord::MAX_INPUTS);
+                }
+            }
+            std::printf("  hash %016llx\n", static_cast<unsigned long long>(record.stateHash));
+        }
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+}
+
+// Latncia da entrada: da chegada da tecla ao tick que a aplicou
+static void printInputLatency(const InputLatencyHistogram& latency, long long droppedKeys) {
+    std::printf("entrada: %lld teclas  media %.2f ms  p50 %.1f ms  p99 %.1f ms  max %.2f ms"
+        "  descartadas %lld\n", latency.keys, latency.meanMs, latency.percentile(0.50),
+        latency.percentile(0.99), latency.maxMs, droppedKeys);
+    double lower = 0;
+    for (int i = 0; i < InputLatencyHistogram::BUCKETS; i++) {
+        const double upper = InputLatencyHistogram::BUCKET_LIMITS_MS[i];
+        if (latency.counts[i] > 0) {
+            if (i + 1 < InputLatencyHistogram::BUCKETS) {
+                std::printf("  %5.0f - %-5.0f ms: %lld\n", lower, upper, latency.counts[i]);
+            }
+            else {
+                std::printf("  %5.0f+ ms        : %lld\n", lower, latency.counts[i]);
+            }
+        }
+        lower = upper;
+    }
+}
+
+#ifdef PACMAN_PROFILE
+// Percentis por fase dos ltimos ticks (build com -DPACMAN_PROFILE)
+static void printProfile(const ProfileSummary& profile) {
+    std::printf("perfil dos ultimos %d ticks (us):\n", profile.ticks);
+    for (int phase = 0; phase < TickProfiler::PHASES; phase++) {
+        std::printf("  %-10s p50 %8.1f  p99 %8.1f\n", TickProfiler::phaseName(static_cast<TickPhase>(phase)),
+            profile.phases[phase].p50Us, profile.phases[phase].p99Us);
+    }
+    std::printf("  %-10s p50 %8.1f  p99 %8.1f  (%.1f%% do tick)\n", "total",
+        profile.total.p50Us, profile.total.p99Us, profile.budgetUsed * 100.0);
+}
+#endif
+
+// Opes do modo versus em rede
+struct VersusOptions {
+    VersusRole role;
+    const char* unixLocal;    // --unix LOCAL REMOTO
+    const char* unixRemote;
+    int udpLocalPort;         // --udp PORTA HOST PORTA
+    const char* udpHost;
+    int udpRemotePort;
+    int netDelayMs;           // Atraso artificial por sentido (RTT = 2x)
+    int maxRollback;
+
+    VersusOptions() : role(VersusRole::PACMAN), unixLocal(nullptr), unixRemote(nullptr),
+        udpLocalPort(0), udpHost(nullptr), udpRemotePort(0), netDelayMs(0),
+        maxRollback(RollbackSession::DEFAULT_ROLLBACK) {}
+};
+
+// Partida a dois: um jogador no Pac-Man, o outro no Blinky
+static int runVersus(const VersusOptions& options, uint64_t seed, const GameLoopConfig& config,
+    RendererKind renderer) {
+    RollbackStats stats;
+    try {
+        NetSocket socket;
+        if (options.unixLocal) {
+            socket.openUnix(options.unixLocal, options.unixRemote);
+        }
+        else if (options.udpHost) {
+            socket.openUdp(options.udpLocalPort, options.udpHost, options.udpRemotePort);
+        }
+        else {
+            throw std::runtime_error("Indique --udp ou --unix");
+        }
+        socket.setSimulatedLatency(options.netDelayMs);
+
+        Game game(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT);
+        game.setRendererKind(renderer);
+        RollbackSession session(game, socket, options.role, options.maxRollback);
+        std::printf("A espera do outro jogador...\n");
+        session.connect(seed);
+
+        PacmanUI::initializeUI();
+        GameLoop loop(game, config);
+        loop.setDriver(&session);
+        loop.run();
+        PacmanUI::cleanupUI();
+        stats = session.getStats();
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+
+    std::printf("ticks: %lld  esperas: %lld  pacotes: %lld enviados / %lld recebidos\n",
+        stats.ticks, stats.stalls, stats.packetsSent, stats.packetsReceived);
+    std::printf("rollbacks: %lld  ticks re-simulados: %lld  maior: %d ticks em %.2f ms\n",
+        stats.rollbacks, stats.resimulatedTicks, stats.maxRollbackDepth, stats.maxResimulationMs);
+    if (stats.desyncs) {
+        std::printf("DESSINCRONIZADO: %lld checksums diferentes, o primeiro no tick %u\n",
+            stats.desyncs, stats.firstDesyncTick);
+    }
+    return stats.desyncs ? 1 : 0;
+}
+
+// Uso: pacman [--tick-rate N] [--fps N] [--seed N] [--record FICHEIRO] [--stream FICHEIRO]
+//               [--checksum-interval N] [--renderer curses|ansi] [--render-thread]
+//               [--input-thread] [--trace FICHEIRO] [--flight BASE | --no-flight]   (ou PACMAN_FLIGHT=BASE)
+//               [--flight-seconds N] [--flight-budget-ms MS]
+//               [--metrics-port N] [--metrics-file CAMINHO]
+//        pacman --flight-dump FICHEIRO
+//        pacman --replay FICHEIRO [--stream FICHEIRO]
+//        pacman --inspect STREAM FRAME
+//        pacman --versus pacman|ghost (--udp PORTA HOST PORTA | --unix LOCAL REMOTO)
+//               [--net-delay MS] [--rollback N] [--seed N]
+int main(int argc, char* argv[]) {
+    GameLoopConfig config;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* streamPath = nullptr;
+    const char* inspectPath = nullptr;
+    uint32_t inspectFrame = 0;
+    uint32_t checksumInterval = ReplayRecorder::DEFAULT_CHECKSUM_INTERVAL;
+    bool versus = false;
+    RendererKind renderer = RendererKind::CURSES_LIB;
+    bool renderThread = false;
+    bool inputThreadEnabled = false;
+    const char* tracePath = nullptr;    // Chrome trace (kill -USR1 despeja a meio)
+    const char* flightBase = std::getenv("PACMAN_FLIGHT");   // nullptr = gravador de voo desligado
+    int flightSeconds = FlightRecorder::DEFAULT_SECONDS;
+    double flightBudgetMs = -1;         // Negativo = um perodo de tick
+    const char* flightDumpPath = nullptr;
+    int metricsPort = 0;                // Prometheus em 127.0.0.1 (0 = desligado)
+    std::string metricsFile;            // Para o textfile collector
+    VersusOptions versusOptions;
+    uint64_t seed = static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+
+    if (flightBase && !*flightBase) flightBase = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            config.ticksPerSecond = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            config.maxFramesPerSecond = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            streamPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--checksum-interval") == 0 && i + 1 < argc) {
+            checksumInterval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--versus") == 0 && i + 1 < argc) {
+            versus = true;
+            versusOptions.role = std::strcmp(argv[++i], "ghost") == 0 ? VersusRole::GHOST
+                : VersusRole::PACMAN;
+        }
+        else if (std::strcmp(argv[i], "--unix") == 0 && i + 2 < argc) {
+            versusOptions.unixLocal = argv[++i];
+            versusOptions.unixRemote = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--udp") == 0 && i + 3 < argc) {
+            versusOptions.udpLocalPort = std::atoi(argv[++i]);
+            versusOptions.udpHost = argv[++i];
+            versusOptions.udpRemotePort = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--net-delay") == 0 && i + 1 < argc) {
+            versusOptions.netDelayMs = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--rollback") == 0 && i + 1 < argc) {
+            versusOptions.maxRollback = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+            renderer = std::strcmp(argv[++i], "ansi") == 0 ? RendererKind::RAW_ANSI
+                : RendererKind::CURSES_LIB;
+        }
+        else if (std::strcmp(argv[i], "--render-thread") == 0) {
+            renderThread = true;
+        }
+        else if (std::strcmp(argv[i], "--flight") == 0 && i + 1 < argc) {
+            flightBase = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--no-flight") == 0) {
+            flightBase = nullptr;
+        }
+        else if (std::strcmp(argv[i], "--flight-seconds") == 0 && i + 1 < argc) {
+            flightSeconds = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--flight-budget-ms") == 0 && i + 1 < argc) {
+            flightBudgetMs = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--flight-dump") == 0 && i + 1 < argc) {
+            flightDumpPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metricsPort = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            metricsFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--input-thread") == 0) {
+            inputThreadEnabled = true;
+        }
+        else if (std::strcmp(argv[i], "--inspect") == 0 && i + 2 < argc) {
+            inspectPath = argv[++i];
+            inspectFrame = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    // O curses no pode desenhar noutra thread enquanto esta faz getch()
+    if (renderThread) {
+        renderer = RendererKind::RAW_ANSI;
+    }
+
+    if (inspectPath) {
+        return runInspect(inspectPath, inspectFrame);
+    }
+    if (flightDumpPath) {
+        return runFlightDump(flightDumpPath);
+    }
+    if (replayPath) {
+        return runReplay(replayPath, streamPath);
+    }
+    if (versus) {
+        return runVersus(versusOptions, seed, config, renderer);
+    }
+
+    // S a pedido (--flight ou PACMAN_FLIGHT): num terminal lento qualquer
+    // tick acima do oramento escreveria despejos no diretrio atual
+    std::unique_ptr<FlightRecorder> flightRecorder;
+    MetricsExporter metrics;
+    try {
+        if (tracePath) {
+            Tracer::start(tracePath);
+        }
+        if (metricsPort > 0 || !metricsFile.empty()) {
+            metrics.start(metricsPort, metricsFile);
+        }
+        if (flightBase) {
+            // Mesmo ritmo que o GameLoop vai usar (valores invlidos caem para o padro)
+            const int tickRate = config.ticksPerSecond > 0 ? config.ticksPerSecond : GameLoopConfig().ticksPerSecond;
+            flightRecorder.reset(new FlightRecorder(flightBase, tickRate, flightSeconds));
+            flightRecorder->setBudgetMs(flightBudgetMs >= 0 ? flightBudgetMs : 1000.0 / tickRate);
+            flightRecorder->installCrashHandlers();
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+
+    PacmanUI::initializeUI();
+
+    std::unique_ptr<ReplayRecorder> recorder;
+    if (recordPath) {
+        recorder.reset(new ReplayRecorder(recordPath, checksumInterval));
+    }
+    std::unique_ptr<ReplayStreamWriter> stream;
+    if (streamPath) {
+        stream.reset(new ReplayStreamWriter(streamPath));
+    }
+
+    // L o teclado depois de o curses pr o terminal em modo cbreak
+    InputThread inputThread;
+    if (inputThreadEnabled) {
+        inputThread.start();
+    }
+
+    FrameTimingStats stats;
+    RenderStats renderStats;
+    InputLatencyHistogram inputLatency;
+#ifdef PACMAN_PROFILE
+    ProfileSummary profile = ProfileSummary();
+#endif
+    // Um erro no jogo (o GameLoop relana-o depois do despejo de voo, a
+    // verificao de alocaes lana em PLAYING) no pode deixar o terminal
+    // em modo curses: o Game  destrudo, o terminal reposto e s depois
+    // se mostra o erro
+    try {
+        Game game(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT);
+        game.setSeed(seed);
+        game.setRecorder(recorder.get());
+        game.setStreamWriter(stream.get());
+        game.setRendererKind(renderer);
+        game.setRenderThreaded(renderThread);
+#ifdef PACMAN_PROFILE
+        game.getProfiler().setTickRate(config.ticksPerSecond);
+#endif
+
+        GameLoop loop(game, config);
+        if (inputThreadEnabled) {
+            loop.setInputThread(&inputThread);
+        }
+        loop.setFlightRecorder(flightRecorder.get());
+        loop.run();
+        stats = loop.getStats();
+        renderStats = game.getRenderStats();
+        inputLatency = loop.getInputLatency();
+#ifdef PACMAN_PROFILE
+        profile = game.getProfiler().summarize();
+#endif
+    }
+    catch (const std::exception& e) {
+        inputThread.stop();
+        metrics.stop();
+        PacmanUI::cleanupUI();
+        if (tracePath) {
+            Tracer::stop();
+        }
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        if (flightRecorder && flightRecorder->getDumps() > 0) {
+            std::fprintf(stderr, "gravador de voo: %s\n", flightRecorder->getLastDumpPath().c_str());
+        }
+        return 1;
+    }
+    inputThread.stop();
+    metrics.stop();
+
+    PacmanUI::cleanupUI();
+    if (tracePath) {
+        Tracer::stop();
+        std::printf("traco: %s (%lld eventos perdidos)\n", tracePath, Tracer::getDroppedEvents());
+    }
+
+    // Relatrio de ritmo dos frames
+    std::printf("ticks: %lld  renders: %lld  renders evitados: %lld  ticks descartados: %lld\n",
+        stats.ticks, stats.renders, stats.skippedRenders, stats.droppedTicks);
+    std::printf("intervalo medio: %.2f ms  jitter: %.2f ms  jitter max: %.2f ms\n",
+        stats.meanTickIntervalMs, stats.jitterMs, stats.maxJitterMs);
+    if (renderStats.frames > 0) {
+        std::printf("frames enviados: %lld  celulas/frame: %.1f  sequencias/frame: %.1f\n",
+            renderStats.frames, static_cast<double>(renderStats.cells) / renderStats.frames,
+            static_cast<double>(renderStats.runs) / renderStats.frames);
+        if (renderStats.bytes > 0) {
+            std::printf("bytes enviados: %lld  bytes/frame: %.1f\n", renderStats.bytes,
+                static_cast<double>(renderStats.bytes) / renderStats.frames);
+        }
+    }
+    if (renderStats.published > 0) {
+        std::printf("thread de render: %lld frames publicados  %lld descartados  "
+            "atraso medio %.2f ms  max %.2f ms (%u ticks)\n",
+            renderStats.published, renderStats.dropped, renderStats.meanLagMs,
+            renderStats.maxLagMs, renderStats.maxLagTicks);
+    }
+    if (inputThreadEnabled) {
+        printInputLatency(inputLatency, inputThread.getDroppedKeys());
+    }
+    if (flightRecorder && flightRecorder->getDumps() > 0) {
+        std::printf("gravador de voo: %lld despejos, o ultimo em %s\n", flightRecorder->getDumps(),
+            flightRecorder->getLastDumpPath().c_str());
+    }
+#ifdef PACMAN_PROFILE
+    printProfile(profile);
+#endif
+    return 0;
+}
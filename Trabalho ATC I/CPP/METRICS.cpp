@@ -0,0 +1,319 @@
+#include "metrics.h"
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const int COUNTERS = static_cast<int>(MetricCounter::COUNT);
+    const int GAUGES = static_cast<int>(MetricGauge::COUNT);
+    const int HISTOGRAMS = static_cast<int>(MetricHistogram::COUNT);
+
+    struct MetricInfo {
+        const char* name;
+        const char* help;
+    };
+
+    const MetricInfo COUNTER_INFO[COUNTERS] = {
+        { "pacman_ticks_total", "Ticks de simulacao" },
+        { "pacman_games_completed_total", "Jogos que chegaram ao fim" },
+        { "pacman_highscore_writes_total", "Gravacoes do ficheiro de pontuacoes" },
+        { "pacman_pellets_eaten_total", "Pellets comidos" },
+        { "pacman_power_pellets_eaten_total", "Power pellets comidos" },
+        { "pacman_ghosts_eaten_total", "Fantasmas comidos" },
+        { "pacman_lives_lost_total", "Vidas perdidas" },
+        { "pacman_levels_completed_total", "Niveis completos" }
+    };
+
+    const MetricInfo GAUGE_INFO[GAUGES] = {
+        { "pacman_active_sessions", "Ligacoes abertas no servidor" },
+        { "pacman_spectators", "Ligacoes de espectadores" },
+        { "pacman_queued_frames", "Frames nas filas de saida" },
+        { "pacman_queued_bytes", "Bytes por enviar nas filas de saida" }
+    };
+
+    struct HistogramInfo {
+        const char* name;
+        const char* help;
+        int buckets;
+        double bounds[Metrics::MAX_BUCKETS];
+    };
+
+    const HistogramInfo HISTOGRAM_INFO[HISTOGRAMS] = {
+        { "pacman_tick_duration_seconds", "Duracao de um tick (servidor: todas as sessoes de um loop)", 10,
+            { 0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5 } },
+        { "pacman_frame_bytes", "Bytes por frame enviado (terminal ou rede)", 9,
+            { 16, 32, 64, 128, 256, 512, 1024, 4096, 16384 } },
+        { "pacman_game_level", "Nivel em que cada jogo acabou (acima de 3: completou todos)", 3,
+            { 1, 2, 3 } }
+    };
+
+    // Bloco de uma thread: s ela escreve, o scrape l
+    struct alignas(64) MetricsShard {
+        std::atomic<uint64_t> counters[COUNTERS];
+        std::atomic<int64_t> gauges[GAUGES];
+        struct Histogram {
+            std::atomic<uint64_t> buckets[Metrics::MAX_BUCKETS + 1];   // O ltimo  o +Inf
+            std::atomic<double> sum;
+        } histograms[HISTOGRAMS];
+
+        MetricsShard() {
+            for (auto& counter : counters) counter.store(0, std::memory_order_relaxed);
+            for (auto& gauge : gauges) gauge.store(0, std::memory_order_relaxed);
+            for (auto& histogram : histograms) {
+                for (auto& bucket : histogram.buckets) bucket.store(0, std::memory_order_relaxed);
+                histogram.sum.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::mutex shardsMutex;                             // S ao criar blocos e no scrape
+    std::vector<std::unique_ptr<MetricsShard>> shards;  // Vivem at ao fim do processo
+    thread_local MetricsShard* threadShard = nullptr;
+
+    MetricsShard& currentShard() {
+        if (!threadShard) {
+            std::lock_guard<std::mutex> lock(shardsMutex);
+            shards.push_back(std::unique_ptr<MetricsShard>(new MetricsShard()));
+            threadShard = shards.back().get();
+        }
+        return *threadShard;
+    }
+
+    // Um s escritor: no precisa de fetch_add
+    template <typename T>
+    void bump(std::atomic<T>& value, T amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void appendf(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    void appendf(std::string& out, const char* format, ...) {
+        char line[256];
+        va_list args;
+        va_start(args, format);
+        const int length = std::vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (length > 0) out.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+    }
+}
+
+void Metrics::add(MetricCounter counter, uint64_t amount) {
+    bump(currentShard().counters[static_cast<int>(counter)], amount);
+}
+
+void Metrics::addGauge(MetricGauge gauge, int64_t delta) {
+    bump(currentShard().gauges[static_cast<int>(gauge)], delta);
+}
+
+void Metrics::observe(MetricHistogram histogram, double value) {
+    const HistogramInfo& info = HISTOGRAM_INFO[static_cast<int>(histogram)];
+    MetricsShard::Histogram& target = currentShard().histograms[static_cast<int>(histogram)];
+    int bucket = 0;
+    while (bucket < info.buckets && value > info.bounds[bucket]) bucket++;
+    bump(target.buckets[bucket], static_cast<uint64_t>(1));
+    bump(target.sum, value);
+}
+
+std::string Metrics::scrape() {
+    uint64_t counters[COUNTERS] = {};
+    int64_t gauges[GAUGES] = {};
+    uint64_t buckets[HISTOGRAMS][MAX_BUCKETS + 1] = {};
+    double sums[HISTOGRAMS] = {};
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        for (const auto& shard : shards) {
+            for (int i = 0; i < COUNTERS; i++) counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+            for (int i = 0; i < GAUGES; i++) gauges[i] += shard->gauges[i].load(std::memory_order_relaxed);
+            for (int h = 0; h < HISTOGRAMS; h++) {
+                for (int b = 0; b <= MAX_BUCKETS; b++) {
+                    buckets[h][b] += shard->histograms[h].buckets[b].load(std::memory_order_relaxed);
+                }
+                sums[h] += shard->histograms[h].sum.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::string out;
+    out.reserve(4096);
+    for (int i = 0; i < COUNTERS; i++) {
+        appendf(out, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", COUNTER_INFO[i].name, COUNTER_INFO[i].help,
+            COUNTER_INFO[i].name, COUNTER_INFO[i].name, static_cast<unsigned long long>(counters[i]));
+    }
+    for (int i = 0; i < GAUGES; i++) {
+        appendf(out, "# HELP %s %s\n# TYPE %s gauge\n%s %lld\n", GAUGE_INFO[i].name, GAUGE_INFO[i].help,
+            GAUGE_INFO[i].name, GAUGE_INFO[i].name, static_cast<long long>(gauges[i]));
+    }
+    for (int h = 0; h < HISTOGRAMS; h++) {
+        const HistogramInfo& info = HISTOGRAM_INFO[h];
+        appendf(out, "# HELP %s %s\n# TYPE %s histogram\n", info.name, info.help, info.name);
+        // Os baldes do Prometheus so cumulativos
+        uint64_t cumulative = 0;
+        for (int b = 0; b < info.buckets; b++) {
+            cumulative += buckets[h][b];
+            appendf(out, "%s_bucket{le=\"%g\"} %llu\n", info.name, info.bounds[b],
+                static_cast<unsigned long long>(cumulative));
+        }
+        cumulative += buckets[h][info.buckets];
+        appendf(out, "%s_bucket{le=\"+Inf\"} %llu\n%s_sum %.9g\n%s_count %llu\n", info.name,
+            static_cast<unsigned long long>(cumulative), info.name, sums[h], info.name,
+            static_cast<unsigned long long>(cumulative));
+    }
+    return out;
+}
+
+bool Metrics::writeTextFile(const std::string& path) {
+    const std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) return false;
+    const std::string text = scrape();
+    const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// MetricsExporter
+
+MetricsExporter::MetricsExporter() : listenFd(-1), wakeFd(-1), intervalSeconds(5) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::start(int port, const std::string& file, int interval) {
+    if (thread.joinable()) {
+        throw std::runtime_error("Exportador de mtricas j iniciado");
+    }
+    textFile = file;
+    intervalSeconds = interval > 0 ? interval : 5;
+
+    if (port > 0) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) {
+            throw std::runtime_error("No foi possvel criar o socket de mtricas");
+        }
+        const int enable = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // S local
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listenFd, 16) < 0) {
+            ::close(listenFd);
+            listenFd = -1;
+            throw std::runtime_error("No foi possvel escutar na porta de mtricas " + std::to_string(port));
+        }
+    }
+
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        if (listenFd >= 0) ::close(listenFd);
+        listenFd = -1;
+        throw std::runtime_error("No foi possvel criar o eventfd de mtricas");
+    }
+    thread = std::thread(&MetricsExporter::run, this);
+}
+
+void MetricsExporter::stop() {
+    if (!thread.joinable()) return;
+    const uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) {
+        // O eventfd s falha se o contador transbordar: a thread j vai acordar
+    }
+    thread.join();
+    if (!textFile.empty()) Metrics::writeTextFile(textFile);
+    if (listenFd >= 0) ::close(listenFd);
+    ::close(wakeFd);
+    listenFd = -1;
+    wakeFd = -1;
+}
+
+void MetricsExporter::run() {
+    pollfd fds[2];
+    fds[0].fd = wakeFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = listenFd;
+    fds[1].events = POLLIN;
+    const int count = listenFd >= 0 ? 2 : 1;
+
+    auto nextWrite = std::chrono::steady_clock::now();
+    for (;;) {
+        int timeoutMs = -1;
+        if (!textFile.empty()) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= nextWrite) {
+                Metrics::writeTextFile(textFile);
+                nextWrite = now + std::chrono::seconds(intervalSeconds);
+            }
+            timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                nextWrite - now).count()) + 1;
+        }
+
+        const int ready = poll(fds, count, timeoutMs);
+        if (ready < 0 && errno != EINTR) return;
+        if (ready <= 0) continue;
+        if (fds[0].revents & POLLIN) return;
+        if (count > 1 && (fds[1].revents & POLLIN)) {
+            const int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serve(client);
+                ::close(client);
+            }
+        }
+    }
+}
+
+void MetricsExporter::serve(int client) {
+    // Um pedido por ligao; um cliente que no fala em 1 s  largado
+    timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    char request[2048];
+    size_t used = 0;
+    while (used < sizeof(request) - 1) {
+        const ssize_t received = recv(client, request + used, sizeof(request) - 1 - used, 0);
+        if (received <= 0) return;
+        used += static_cast<size_t>(received);
+        request[used] = '\0';
+        if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) break;
+    }
+    request[used] = '\0';
+
+    const bool found = std::strncmp(request, "GET /metrics", 12) == 0 || std::strncmp(request, "GET / ", 6) == 0;
+    const std::string body = found ? Metrics::scrape() : std::string("nao encontrado\n");
+    char header[160];
+    const int headerLength = std::snprintf(header, sizeof(header),
+        "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n"
+        "Connection: close\r\n\r\n", found ? "200 OK" : "404 Not Found", body.size());
+
+    std::string response(header, static_cast<size_t>(headerLength));
+    response += body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        const ssize_t written = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) return;
+        sent += static_cast<size_t>(written);
+    }
+}
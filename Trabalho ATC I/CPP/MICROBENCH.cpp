@@ -0,0 +1,514 @@
+// Microbenchmarks das peas do tick: tabuleiro, movimento, IA dos fantasmas,
+// colises, um tick completo e o desenho num ecr fora do terminal.
+// Escreve os resultados em JSON e, com --baseline, compara-os com um JSON
+// anterior e falha se alguma medida piorar mais do que --threshold %.
+// Compilado com -DPACMAN_ALLOC_CHECK, conta tambm as alocaes de cada
+// benchmark e falha se alguma pea do tick em regime alocar.
+//
+// Uso: pacman_bench [--filter TEXTO] [--json CAMINHO] [--baseline CAMINHO]
+//                   [--threshold PERCENTAGEM] [--min-time-ms MS] [--list]
+#include "board.h"
+#include "pacman.h"
+#include "ghost.h"
+#include "game.h"
+#include "game_random.h"
+#include "game_snapshot.h"
+#include "pacman_ui.h"
+#include "frame_renderer.h"
+#include "allocation_tracker.h"
+#include <curses.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+    // Cada amostra dura pelo menos isto (rondas calibradas), para o relgio no pesar
+    const double MIN_SAMPLE_NS = 1e6;
+    const int MIN_SAMPLES = 5;
+    const int MAX_SAMPLES = 1000;
+
+    // Resultados que o compilador no pode descartar
+    volatile uint64_t sink;
+}
+
+struct BenchConfig {
+    const char* filter;
+    const char* jsonPath;       // nullptr = stdout
+    const char* baselinePath;
+    double thresholdPercent;
+    double minTimeMs;           // Por benchmark
+    bool list;
+
+    BenchConfig() : filter(nullptr), jsonPath(nullptr), baselinePath(nullptr),
+        thresholdPercent(10), minTimeMs(200), list(false) {}
+};
+
+// setup() prepara cada amostra fora do tempo medido; run(rondas) devolve
+// o nmero de operaes feitas. fixedRounds: uma ronda gasta o estado
+// preparado (ex.: comer os pellets todos) e no pode ser repetida.
+// mayAllocate: pode alocar sem falhar a verificao (ex.: acabar a partida).
+struct Benchmark {
+    std::string name;
+    std::function<void()> setup;
+    std::function<long long(int rounds)> run;
+    bool fixedRounds;
+    bool mayAllocate;
+};
+
+struct BenchResult {
+    std::string name;
+    double medianNs;     // Por operao
+    double minNs;
+    double p90Ns;
+    long long operations;
+    int samples;
+    long long allocations;   // Nas amostras medidas (0 sem PACMAN_ALLOC_CHECK)
+};
+
+// Ecr fora do terminal: o FrameRenderer faz a diferena toda, mas as
+// sequncias no vo a lado nenhum
+class NullBackend : public ScreenBackend {
+public:
+    void drawRun(int x, int y, const ScreenCell* cells, int count) override {
+        sink += static_cast<uint64_t>(x + y + count) + cells[0].glyph;
+    }
+    void endFrame() override {}
+};
+
+static double nanosecondsBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::nano>(to - from).count();
+}
+
+static BenchResult measure(const Benchmark& bench, double minTimeMs) {
+    // Calibrao: duplica as rondas at uma amostra passar de MIN_SAMPLE_NS
+    int rounds = 1;
+    while (!bench.fixedRounds) {
+        if (bench.setup) bench.setup();
+        const auto start = Clock::now();
+        bench.run(rounds);
+        if (nanosecondsBetween(start, Clock::now()) >= MIN_SAMPLE_NS || rounds >= (1 << 24)) break;
+        rounds *= 2;
+    }
+
+    std::vector<double> perOperation;
+    perOperation.reserve(MAX_SAMPLES);   // No conta como alocao do benchmark
+    long long operations = 0;
+    long long allocations = 0;
+    double spentNs = 0;
+    while (static_cast<int>(perOperation.size()) < MAX_SAMPLES &&
+        (static_cast<int>(perOperation.size()) < MIN_SAMPLES || spentNs < minTimeMs * 1e6)) {
+        if (bench.setup) bench.setup();
+        const AllocationScope scope;
+        const auto start = Clock::now();
+        const long long count = bench.run(rounds);
+        const double elapsed = nanosecondsBetween(start, Clock::now());
+        allocations += static_cast<long long>(scope.getAllocations());
+        spentNs += elapsed;
+        if (count > 0) {
+            perOperation.push_back(elapsed / count);
+            operations += count;
+        }
+    }
+    if (perOperation.empty()) {
+        throw std::runtime_error("Benchmark sem operaes: " + bench.name);
+    }
+
+    std::sort(perOperation.begin(), perOperation.end());
+    BenchResult result;
+    result.name = bench.name;
+    result.medianNs = perOperation[perOperation.size() / 2];
+    result.minNs = perOperation.front();
+    result.p90Ns = perOperation[perOperation.size() * 9 / 10];
+    result.operations = operations;
+    result.samples = static_cast<int>(perOperation.size());
+    result.allocations = allocations;
+    return result;
+}
+
+// Estado partilhado pelos benchmarks: criado uma vez, reposto no setup()
+struct BenchWorld {
+    EntityWorld entities;                          // Do Pacman e dos fantasmas dos benchmarks
+    Board board;
+    std::vector<std::pair<int, int>> openCells;   // Casas sem parede
+    std::vector<std::pair<int, int>> pelletCells; // Com pellet depois de resetBoard()
+    GameRandom rng;
+
+    BenchWorld() : board(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT), rng(1) {
+        for (int y = 0; y < board.getHeight(); y++) {
+            for (int x = 0; x < board.getWidth(); x++) {
+                if (!board.isWall(x, y)) openCells.push_back(std::make_pair(x, y));
+                if (board.isPellet(x, y) || board.isPowerPellet(x, y)) {
+                    pelletCells.push_back(std::make_pair(x, y));
+                }
+            }
+        }
+        if (openCells.empty()) {
+            throw std::runtime_error("Tabuleiro sem casas livres");
+        }
+    }
+};
+
+static const char* ghostTypeName(GhostType type) {
+    switch (type) {
+    case GhostType::BLINKY: return "blinky";
+    case GhostType::PINKY: return "pinky";
+    case GhostType::INKY: return "inky";
+    case GhostType::CLYDE: return "clyde";
+    }
+    return "?";
+}
+
+static const char* ghostStateName(GhostState state) {
+    switch (state) {
+    case GhostState::NORMAL: return "chase";
+    case GhostState::VULNERABLE: return "frightened";
+    case GhostState::RETURNING: return "returning";
+    case GhostState::WAITING: return "waiting";
+    }
+    return "?";
+}
+
+static int directionKey(int index) {
+    static const int KEYS[4] = { KEY_UP, KEY_RIGHT, KEY_DOWN, KEY_LEFT };
+    return KEYS[index & 3];
+}
+
+static void addBoardBenchmarks(std::vector<Benchmark>& benches, BenchWorld& world) {
+    Board& board = world.board;
+    const int width = board.getWidth();
+    const int height = board.getHeight();
+
+    benches.push_back({ "board/isWall", nullptr, [&board, width, height](int rounds) {
+        uint64_t walls = 0;
+        for (int r = 0; r < rounds; r++) {
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) walls += board.isWall(x, y);
+            }
+        }
+        sink += walls;
+        return static_cast<long long>(rounds) * width * height;
+    }, false, false });
+
+    // Inclui a moldura de fora do tabuleiro, que o movimento tambm consulta
+    benches.push_back({ "board/isValidPosition", nullptr, [&board, width, height](int rounds) {
+        uint64_t valid = 0;
+        for (int r = 0; r < rounds; r++) {
+            for (int y = -1; y <= height; y++) {
+                for (int x = -1; x <= width; x++) valid += board.isValidPosition(x, y);
+            }
+        }
+        sink += valid;
+        return static_cast<long long>(rounds) * (width + 2) * (height + 2);
+    }, false, false });
+
+    benches.push_back({ "board/removePellet", [&board]() { board.resetBoard(); }, [&world](int) {
+        for (const auto& cell : world.pelletCells) {
+            world.board.removePellet(cell.first, cell.second);
+        }
+        sink += static_cast<uint64_t>(world.board.getRemainingPellets());
+        return static_cast<long long>(world.pelletCells.size());
+    }, true, false });
+
+    benches.push_back({ "board/resetBoard", nullptr, [&board](int rounds) {
+        for (int r = 0; r < rounds; r++) {
+            board.resetBoard();
+        }
+        sink += board.getHash();
+        return static_cast<long long>(rounds);
+    }, false, false });
+}
+
+static void addMovementBenchmarks(std::vector<Benchmark>& benches, BenchWorld& world) {
+    int spawnX = 0, spawnY = 0;
+    world.board.getSpawnPoint(spawnX, spawnY);
+    auto pacman = std::make_shared<Pacman>(world.entities, spawnX, spawnY);
+
+    // Um tick de movimento, mudando de direo de 8 em 8 ticks
+    benches.push_back({ "pacman/move", [&world, pacman]() {
+        world.board.resetBoard();
+        world.rng.reseed(1);
+        pacman->respawn();
+    }, [&world, pacman](int rounds) {
+        for (int r = 0; r < rounds; r++) {
+            if ((r & 7) == 0) {
+                static const int DIRECTIONS[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+                const int* direction = DIRECTIONS[world.rng.nextInt(4)];
+                pacman->changeDirection(direction[0], direction[1]);
+            }
+            pacman->move(world.board);
+        }
+        sink += static_cast<uint64_t>(pacman->getX() * 31 + pacman->getY());
+        return static_cast<long long>(rounds);
+    }, false, false });
+
+    // Cada tipo de fantasma em cada modo de movimento; o alvo (o Pacman)
+    // muda de casa livre em casa livre para a IA no estabilizar
+    const GhostType types[] = { GhostType::BLINKY, GhostType::PINKY, GhostType::INKY, GhostType::CLYDE };
+    const GhostState states[] = { GhostState::NORMAL, GhostState::VULNERABLE, GhostState::RETURNING };
+    for (GhostType type : types) {
+        for (GhostState state : states) {
+            auto ghost = std::make_shared<Ghost>(world.entities, 0, 13, 11, type);
+            GhostSnapshot start;
+            ghost->saveState(start);
+            start.state = static_cast<uint8_t>(state);
+            start.active = 1;
+            if (state == GhostState::RETURNING) {
+                // Longe do spawn, para haver caminho a fazer
+                start.x = static_cast<int16_t>(world.openCells.front().first);
+                start.y = static_cast<int16_t>(world.openCells.front().second);
+            }
+
+            const std::string name = std::string("ghost/move/") + ghostTypeName(type) + "/" +
+                ghostStateName(state);
+            benches.push_back({ name, [&world, ghost, start]() {
+                world.rng.reseed(1);
+                ghost->restoreState(start);
+            }, [&world, ghost, start, state](int rounds) {
+                const size_t cells = world.openCells.size();
+                for (int r = 0; r < rounds; r++) {
+                    const auto& target = world.openCells[(static_cast<size_t>(r) / 16 * 7919) % cells];
+                    ghost->move(target.first, target.second, world.board, world.rng);
+                    if (ghost->getState() != state) {
+                        ghost->restoreState(start);   // Chegou ao spawn: recomea o percurso
+                    }
+                }
+                sink += static_cast<uint64_t>(ghost->getX() * 31 + ghost->getY());
+                return static_cast<long long>(rounds);
+            }, false, false });
+        }
+    }
+}
+
+static void addGameBenchmarks(std::vector<Benchmark>& benches) {
+    auto game = std::make_shared<Game>(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT);
+    game->setSeed(1);
+
+    benches.push_back({ "game/checkCollisions", [game]() {
+        game->startGame();
+    }, [game](int rounds) {
+        for (int r = 0; r < rounds; r++) {
+            game->checkCollisions();
+        }
+        sink += static_cast<uint64_t>(game->getScore());
+        return static_cast<long long>(rounds);
+    }, false, false });
+
+    // Tick completo com uma tecla de 10 em 10 ticks. Uma amostra pode
+    // acabar a partida: o tick em GAME_OVER tambm conta, como no jogo,
+    // e o fim de jogo grava as pontuaes (aloca).
+    benches.push_back({ "game/updateGameState", [game]() {
+        game->startGame();
+    }, [game](int rounds) {
+        for (int r = 0; r < rounds; r++) {
+            if (r % 10 == 0) game->handleInput(directionKey(r / 10 * 3));
+            game->updateGameState();
+        }
+        sink += game->getStateHash();
+        return static_cast<long long>(rounds);
+    }, false, true });
+
+    // O mesmo s em regime: vidas que no acabam, para a partida nunca
+    // sair de PLAYING (perder uma vida repe o nvel, que tambm  verificado)
+    benches.push_back({ "game/updateGameState/playing", [game]() {
+        game->startGame();
+        GameSnapshot endless;
+        game->saveSnapshot(endless);
+        endless.lives = INT16_MAX;
+        game->restoreSnapshot(endless);
+    }, [game](int rounds) {
+        for (int r = 0; r < rounds; r++) {
+            if (r % 10 == 0) game->handleInput(directionKey(r / 10 * 3));
+            game->updateGameState();
+        }
+        sink += game->getStateHash();
+        return static_cast<long long>(rounds);
+    }, false, false });
+}
+
+static void addRenderBenchmarks(std::vector<Benchmark>& benches, BenchWorld& world) {
+    const int width = PacmanUI::WINDOW_WIDTH;
+    const int height = PacmanUI::WINDOW_HEIGHT;
+    auto screen = std::make_shared<FrameRenderer>(width, height,
+        std::unique_ptr<ScreenBackend>(new NullBackend()));
+
+    // S composio: o tabuleiro inteiro na grelha em memria
+    benches.push_back({ "ui/drawBoard", nullptr, [&world, screen](int rounds) {
+        for (int r = 0; r < rounds; r++) {
+            PacmanUI::drawBoard(*screen, world.board);
+        }
+        sink += screen->at(1, 1).glyph;
+        return static_cast<long long>(rounds);
+    }, false, false });
+
+    // Composio + diferena num ecr que j mostra o frame anterior:
+    // alterna dois tabuleiros para haver sempre casas a enviar
+    auto eaten = std::make_shared<Board>(PacmanUI::BOARD_WIDTH, PacmanUI::BOARD_HEIGHT);
+    for (size_t i = 0; i < world.pelletCells.size(); i += 2) {
+        eaten->removePellet(world.pelletCells[i].first, world.pelletCells[i].second);
+    }
+    benches.push_back({ "ui/drawBoard+present", [&world, screen]() {
+        world.board.resetBoard();
+        screen->invalidate();
+        PacmanUI::drawBoard(*screen, world.board);
+        screen->present();
+    }, [&world, screen, eaten](int rounds) {
+        for (int r = 0; r < rounds; r++) {
+            PacmanUI::drawBoard(*screen, (r & 1) ? world.board : *eaten);
+            screen->present(static_cast<uint32_t>(r));
+        }
+        sink += static_cast<uint64_t>(screen->getStats().cells);
+        return static_cast<long long>(rounds);
+    }, false, false });
+}
+
+// --- JSON -------------------------------------------------------------------
+
+static void writeJson(std::FILE* out, const std::vector<BenchResult>& results) {
+    std::fprintf(out, "{\n  \"schema\": 1,\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"median\": %.3f, \"min\": %.3f, \"p90\": %.3f, "
+            "\"operations\": %lld, \"samples\": %d, \"allocations\": %lld}%s\n",
+            result.name.c_str(), result.medianNs, result.minNs, result.p90Ns,
+            result.operations, result.samples, result.allocations, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+// L s o que writeJson escreve: nome e mediana de cada benchmark
+static std::vector<BenchResult> readBaseline(const char* path) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        throw std::runtime_error(std::string("No foi possvel abrir ") + path);
+    }
+    std::string text;
+    char chunk[4096];
+    size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, count);
+    }
+    std::fclose(file);
+
+    std::vector<BenchResult> results;
+    size_t pos = 0;
+    while ((pos = text.find("\"name\": \"", pos)) != std::string::npos) {
+        pos += 9;
+        const size_t end = text.find('"', pos);
+        const size_t median = text.find("\"median\": ", end);
+        if (end == std::string::npos || median == std::string::npos) {
+            throw std::runtime_error(std::string("Baseline invlida: ") + path);
+        }
+        BenchResult result = BenchResult();
+        result.name = text.substr(pos, end - pos);
+        result.medianNs = std::strtod(text.c_str() + median + 10, nullptr);
+        results.push_back(result);
+        pos = median;
+    }
+    return results;
+}
+
+// Devolve o nmero de regresses
+static int compareWithBaseline(const std::vector<BenchResult>& results,
+    const std::vector<BenchResult>& baseline, double thresholdPercent) {
+    int regressions = 0;
+    std::fprintf(stderr, "%-36s %12s %12s %9s\n", "benchmark", "base ns/op", "ns/op", "delta");
+    for (const auto& result : results) {
+        const BenchResult* before = nullptr;
+        for (const auto& candidate : baseline) {
+            if (candidate.name == result.name) before = &candidate;
+        }
+        if (!before || before->medianNs <= 0) {
+            std::fprintf(stderr, "%-36s %12s %12.1f %9s\n", result.name.c_str(), "-", result.medianNs, "novo");
+            continue;
+        }
+        const double delta = 100.0 * (result.medianNs - before->medianNs) / before->medianNs;
+        const bool regressed = delta > thresholdPercent;
+        if (regressed) regressions++;
+        std::fprintf(stderr, "%-36s %12.1f %12.1f %+8.1f%%%s\n", result.name.c_str(),
+            before->medianNs, result.medianNs, delta, regressed ? "  REGRESSAO" : "");
+    }
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) config.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) config.jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) config.baselinePath = argv[++i];
+        else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) config.thresholdPercent = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) config.minTimeMs = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--list") == 0) config.list = true;
+        else {
+            std::fprintf(stderr, "Uso: %s [--filter TEXTO] [--json CAMINHO] [--baseline CAMINHO]"
+                " [--threshold PERCENTAGEM] [--min-time-ms MS] [--list]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    int allocating = 0;   // Benchmarks de regime que alocaram
+    try {
+        BenchWorld world;
+        std::vector<Benchmark> benches;
+        addBoardBenchmarks(benches, world);
+        addMovementBenchmarks(benches, world);
+        addGameBenchmarks(benches);
+        addRenderBenchmarks(benches, world);
+
+        for (const auto& bench : benches) {
+            if (config.filter && bench.name.find(config.filter) == std::string::npos) continue;
+            if (config.list) {
+                std::printf("%s\n", bench.name.c_str());
+                continue;
+            }
+            results.push_back(measure(bench, config.minTimeMs));
+            const BenchResult& result = results.back();
+            std::fprintf(stderr, "%-36s %10.1f ns/op (min %.1f, p90 %.1f, %d amostras)\n",
+                result.name.c_str(), result.medianNs, result.minNs, result.p90Ns, result.samples);
+            if (result.allocations > 0) {
+                std::fprintf(stderr, "%-36s %lld alocaes%s\n", "", result.allocations,
+                    bench.mayAllocate ? "" : "  ALOCOU");
+                if (!bench.mayAllocate) allocating++;
+            }
+        }
+        if (config.list) return 0;
+
+        std::FILE* out = config.jsonPath ? std::fopen(config.jsonPath, "wb") : stdout;
+        if (!out) {
+            throw std::runtime_error(std::string("No foi possvel criar ") + config.jsonPath);
+        }
+        writeJson(out, results);
+        if (out != stdout) std::fclose(out);
+
+        if (config.baselinePath) {
+            regressions = compareWithBaseline(results, readBaseline(config.baselinePath),
+                config.thresholdPercent);
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+
+    if (regressions > 0) {
+        std::fprintf(stderr, "%d benchmark(s) acima de +%.0f%% da baseline\n",
+            regressions, config.thresholdPercent);
+    }
+    if (allocating > 0) {
+        std::fprintf(stderr, "%d benchmark(s) alocaram no heap\n", allocating);
+    }
+    return regressions > 0 || allocating > 0 ? 1 : 0;
+}
@@ -0,0 +1,477 @@
+#include "netplay.h"
+#include "game.h"
+#include "replay.h"
+#include <curses.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    const uint8_t PACKET_HELLO = 1;
+    const uint8_t PACKET_WELCOME = 2;
+    const uint8_t PACKET_INPUT = 3;
+    const uint8_t PACKET_BYE = 4;
+
+    const size_t HELLO_SIZE = 2 + 1 + 1 + 8;
+    const size_t INPUT_HEADER_SIZE = 2 + 1 + 1 + 4 * 4;
+
+    // Entrada de um tick: 0 = nenhuma tecla ainda, seno 1 + ReplayCode da direo
+    const uint8_t INPUT_NONE = 0;
+
+    void put32(uint8_t* p, uint32_t value) {
+        for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint32_t get32(const uint8_t* p) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(p[i]) << (8 * i);
+        return value;
+    }
+
+    void put64(uint8_t* p, uint64_t value) {
+        for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint64_t get64(const uint8_t* p) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(p[i]) << (8 * i);
+        return value;
+    }
+
+    uint8_t inputForKey(int key) {
+        ReplayCode code = replayCodeForKey(key);
+        return code <= ReplayCode::RIGHT ? static_cast<uint8_t>(1 + static_cast<uint8_t>(code))
+            : INPUT_NONE;
+    }
+
+    int keyForInput(uint8_t input) {
+        return replayKeyForCode(static_cast<ReplayCode>(input - 1));
+    }
+
+    void makeNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            throw std::runtime_error("Nao foi possivel configurar o socket");
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// NetSocket
+
+NetSocket::NetSocket()
+    : fd(-1), remoteLength(0), latency(Clock::duration::zero()),
+    delayedHead(0), delayedCount(0) {
+    std::memset(&remoteAddress, 0, sizeof(remoteAddress));
+}
+
+NetSocket::~NetSocket() {
+    close();
+}
+
+void NetSocket::openUdp(int localPort, const std::string& remoteHost, int remotePort) {
+    close();
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    const std::string port = std::to_string(remotePort);
+    if (getaddrinfo(remoteHost.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+        throw std::runtime_error("Endereco invalido: " + remoteHost);
+    }
+    std::memcpy(&remoteAddress, result->ai_addr, result->ai_addrlen);
+    remoteLength = result->ai_addrlen;
+    freeaddrinfo(result);
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Nao foi possivel criar o socket UDP");
+    }
+
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(static_cast<uint16_t>(localPort));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+        close();
+        throw std::runtime_error("Porta UDP ocupada: " + std::to_string(localPort));
+    }
+    makeNonBlocking(fd);
+}
+
+void NetSocket::openUnix(const std::string& localPath, const std::string& remotePath) {
+    close();
+
+    sockaddr_un local;
+    sockaddr_un remote;
+    if (localPath.size() >= sizeof(local.sun_path) || remotePath.size() >= sizeof(remote.sun_path)) {
+        throw std::runtime_error("Caminho de socket Unix demasiado longo");
+    }
+
+    fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Nao foi possivel criar o socket Unix");
+    }
+
+    std::memset(&local, 0, sizeof(local));
+    local.sun_family = AF_UNIX;
+    std::memcpy(local.sun_path, localPath.c_str(), localPath.size());
+    unlink(localPath.c_str());   // Resto de uma sesso anterior
+    if (bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+        close();
+        throw std::runtime_error("Nao foi possivel usar o socket " + localPath);
+    }
+    boundPath = localPath;
+    makeNonBlocking(fd);
+
+    std::memset(&remote, 0, sizeof(remote));
+    remote.sun_family = AF_UNIX;
+    std::memcpy(remote.sun_path, remotePath.c_str(), remotePath.size());
+    std::memcpy(&remoteAddress, &remote, sizeof(remote));
+    remoteLength = sizeof(remote);
+}
+
+void NetSocket::close() {
+    if (fd >= 0) {
+        // O que ainda estava em atraso (ex.: o BYE final) sai j
+        while (delayedCount > 0) {
+            sendNow(delayed[delayedHead].data, delayed[delayedHead].size);
+            delayedHead = (delayedHead + 1) % DELAY_SLOTS;
+            delayedCount--;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    if (!boundPath.empty()) {
+        unlink(boundPath.c_str());
+        boundPath.clear();
+    }
+    delayedHead = 0;
+    delayedCount = 0;
+}
+
+void NetSocket::setSimulatedLatency(int milliseconds) {
+    latency = std::chrono::milliseconds(milliseconds > 0 ? milliseconds : 0);
+    if (milliseconds > 0 && delayed.empty()) {
+        delayed.resize(DELAY_SLOTS);
+    }
+}
+
+void NetSocket::send(const uint8_t* data, size_t size) {
+    if (fd < 0 || size > MAX_PACKET) return;
+
+    flushDelayed();
+    if (latency == Clock::duration::zero()) {
+        sendNow(data, size);
+        return;
+    }
+
+    // Fila cheia: o datagrama perde-se, como numa rede congestionada
+    if (delayedCount == DELAY_SLOTS) return;
+    DelayedPacket& packet = delayed[(delayedHead + delayedCount) % DELAY_SLOTS];
+    packet.due = Clock::now() + latency;
+    packet.size = size;
+    std::memcpy(packet.data, data, size);
+    delayedCount++;
+}
+
+size_t NetSocket::receive(uint8_t* data, size_t capacity) {
+    if (fd < 0) return 0;
+
+    flushDelayed();
+    for (;;) {
+        ssize_t received = recv(fd, data, capacity, 0);
+        if (received > 0) return static_cast<size_t>(received);
+        // ECONNREFUSED: um envio anterior no tinha ningum do outro lado
+        if (received < 0 && (errno == EINTR || errno == ECONNREFUSED)) continue;
+        return 0;
+    }
+}
+
+void NetSocket::sendNow(const uint8_t* data, size_t size) {
+    // Falhas de envio (peer ainda no aberto, buffer cheio) contam como perda:
+    // o protocolo repete as entradas at serem confirmadas
+    sendto(fd, data, size, 0, reinterpret_cast<const sockaddr*>(&remoteAddress), remoteLength);
+}
+
+void NetSocket::flushDelayed() {
+    const Clock::time_point now = Clock::now();
+    while (delayedCount > 0 && delayed[delayedHead].due <= now) {
+        sendNow(delayed[delayedHead].data, delayed[delayedHead].size);
+        delayedHead = (delayedHead + 1) % DELAY_SLOTS;
+        delayedCount--;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RollbackSession
+
+RollbackSession::RollbackSession(Game& game, NetSocket& socket, VersusRole role, int maxRollback)
+    : game(game), socket(socket), role(role),
+    maxRollback(std::max(1, std::min(maxRollback, static_cast<int>(MAX_ROLLBACK)))),
+    sessionSeed(0), frame(0), localInput(INPUT_NONE),
+    remoteConfirmed(0), remoteFrame(0), remoteAck(0), firstMispredicted(NONE),
+    pendingHashTick(0), pendingHash(0) {
+    std::memset(localInputs, 0, sizeof(localInputs));
+    std::memset(remoteInputs, 0, sizeof(remoteInputs));
+    std::memset(usedRemote, 0, sizeof(usedRemote));
+}
+
+void RollbackSession::connect(uint64_t seed, int timeoutMs) {
+    sessionSeed = seed;
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    Clock::time_point nextHello = Clock::now();
+    bool agreed = false;
+
+    while (!agreed) {
+        const Clock::time_point now = Clock::now();
+        if (now > deadline) {
+            throw std::runtime_error("O outro jogador nao respondeu");
+        }
+        if (role == VersusRole::PACMAN && now >= nextHello) {
+            sendHello(PACKET_HELLO);
+            nextHello = now + std::chrono::milliseconds(100);
+        }
+
+        size_t size;
+        while (!agreed && (size = socket.receive(incoming, sizeof(incoming))) > 0) {
+            if (size < 3 || incoming[0] != 'P' || incoming[1] != 'V') continue;
+            const uint8_t type = incoming[2];
+
+            if ((type == PACKET_HELLO || type == PACKET_WELCOME) && size >= HELLO_SIZE &&
+                incoming[3] == static_cast<uint8_t>(role)) {
+                throw std::runtime_error("Os dois jogadores escolheram o mesmo papel");
+            }
+            if (role == VersusRole::GHOST && type == PACKET_HELLO && size >= HELLO_SIZE) {
+                sessionSeed = get64(incoming + 4);
+                sendHello(PACKET_WELCOME);
+                agreed = true;
+            }
+            else if (role == VersusRole::PACMAN &&
+                ((type == PACKET_WELCOME && size >= HELLO_SIZE && get64(incoming + 4) == sessionSeed) ||
+                 type == PACKET_INPUT)) {
+                // Um INPUT tambm prova que o WELCOME foi enviado; as entradas
+                // que trazia voltam a vir no prximo pacote
+                agreed = true;
+            }
+        }
+        if (!agreed) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    // Os dois lados comeam do mesmo estado, sem efeitos externos: qualquer
+    // tick pode vir a ser re-simulado
+    game.setSeed(sessionSeed);
+    game.setGhostPlayer(0);
+    game.setSpeculative(true);
+    game.startGame();
+}
+
+void RollbackSession::handleInput(int input) {
+    if (input == 'q' || input == 'Q') {
+        sendBye();
+        game.requestQuit();
+        return;
+    }
+    const uint8_t code = inputForKey(input);
+    if (code != INPUT_NONE) {
+        localInput = code;
+    }
+}
+
+void RollbackSession::tick() {
+    advance();
+    // Se ficmos para trs do peer (ex.: depois de esperar por ele), um tick
+    // extra por passo recupera a diferena sem saltos
+    if (remoteFrame > frame + 1) {
+        advance();
+    }
+}
+
+bool RollbackSession::advance() {
+    poll();
+    if (firstMispredicted != NONE) {
+        rollback();
+    }
+    checkDesync();
+
+    // Sem entradas do peer h demasiado tempo: esperar em vez de prever mais
+    if (frame >= remoteConfirmed + static_cast<uint32_t>(maxRollback) ||
+        frame >= remoteAck + static_cast<uint32_t>(INPUT_WINDOW)) {
+        stats.stalls++;
+        sendInputs();
+        return false;
+    }
+
+    localInputs[frame % INPUT_WINDOW] = localInput;
+    simulate(frame);
+    frame++;
+    stats.ticks++;
+    sendInputs();
+    return true;
+}
+
+void RollbackSession::simulate(uint32_t tick) {
+    game.saveSnapshot(snapshots[tick % SNAPSHOTS]);
+
+    const uint8_t remote = tick < remoteConfirmed ? remoteInputs[tick % INPUT_WINDOW]
+        : predictRemote();
+    usedRemote[tick % INPUT_WINDOW] = remote;
+
+    const uint8_t local = localInputs[tick % INPUT_WINDOW];
+    const uint8_t pacmanInput = role == VersusRole::PACMAN ? local : remote;
+    const uint8_t ghostInput = role == VersusRole::PACMAN ? remote : local;
+    if (pacmanInput != INPUT_NONE) {
+        game.handleInput(keyForInput(pacmanInput));
+    }
+    if (ghostInput != INPUT_NONE) {
+        game.handleGhostInput(keyForInput(ghostInput));
+    }
+    game.updateGameState();
+}
+
+uint8_t RollbackSession::predictRemote() const {
+    // A entrada  a direo escolhida, que raramente muda de um tick para o outro
+    return remoteConfirmed > 0 ? remoteInputs[(remoteConfirmed - 1) % INPUT_WINDOW] : INPUT_NONE;
+}
+
+void RollbackSession::rollback() {
+    const uint32_t from = firstMispredicted;
+    firstMispredicted = NONE;
+
+    const Clock::time_point start = Clock::now();
+    game.restoreSnapshot(snapshots[from % SNAPSHOTS]);
+    for (uint32_t tick = from; tick < frame; tick++) {
+        simulate(tick);
+    }
+    const double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    const int depth = static_cast<int>(frame - from);
+    stats.rollbacks++;
+    stats.resimulatedTicks += depth;
+    if (depth > stats.maxRollbackDepth) stats.maxRollbackDepth = depth;
+    if (elapsedMs > stats.maxResimulationMs) stats.maxResimulationMs = elapsedMs;
+}
+
+void RollbackSession::poll() {
+    size_t size;
+    while ((size = socket.receive(incoming, sizeof(incoming))) > 0) {
+        if (size >= 3 && incoming[0] == 'P' && incoming[1] == 'V') {
+            stats.packetsReceived++;
+            readPacket(size);
+        }
+    }
+}
+
+void RollbackSession::readPacket(size_t size) {
+    switch (incoming[2]) {
+    case PACKET_HELLO:
+        // O nosso WELCOME perdeu-se: o Pac-Man continua a pedir
+        if (role == VersusRole::GHOST) sendHello(PACKET_WELCOME);
+        return;
+    case PACKET_BYE:
+        game.requestQuit();
+        return;
+    case PACKET_INPUT:
+        break;
+    default:
+        return;
+    }
+
+    if (size < INPUT_HEADER_SIZE) return;
+    const uint32_t count = incoming[3];
+    const uint32_t first = get32(incoming + 4);
+    const uint32_t ack = get32(incoming + 8);
+    if (size < INPUT_HEADER_SIZE + count) return;
+
+    // Um pacote antigo entregue fora de ordem no faz o ack andar para trs
+    if (ack > remoteAck && ack <= frame) remoteAck = ack;
+    if (first + count > remoteFrame) remoteFrame = first + count;
+
+    const uint32_t hashTick = get32(incoming + 12);
+    if (hashTick > pendingHashTick) {
+        pendingHashTick = hashTick;
+        pendingHash = get32(incoming + 16);
+    }
+
+    // Buraco (pacotes perdidos pelo meio): as entradas em falta viro repetidas
+    if (first > remoteConfirmed) return;
+
+    const uint8_t* inputs = incoming + INPUT_HEADER_SIZE;
+    for (uint32_t i = remoteConfirmed - first; i < count; i++) {
+        const uint32_t tick = first + i;
+        remoteInputs[tick % INPUT_WINDOW] = inputs[i];
+        if (tick < frame && usedRemote[tick % INPUT_WINDOW] != inputs[i] &&
+            (firstMispredicted == NONE || tick < firstMispredicted)) {
+            firstMispredicted = tick;
+        }
+        remoteConfirmed = tick + 1;
+    }
+}
+
+void RollbackSession::checkDesync() {
+    // S se compara um tick que os dois lados j simularam com as entradas reais
+    const uint32_t confirmed = std::min(frame, remoteConfirmed);
+    if (pendingHashTick == 0 || pendingHashTick > confirmed || firstMispredicted != NONE) return;
+
+    uint64_t hash;
+    if (game.getTickHash(pendingHashTick, hash) && static_cast<uint32_t>(hash) != pendingHash) {
+        if (stats.desyncs == 0) stats.firstDesyncTick = pendingHashTick;
+        stats.desyncs++;
+    }
+    pendingHashTick = 0;
+}
+
+void RollbackSession::sendHello(uint8_t type) {
+    outgoing[0] = 'P';
+    outgoing[1] = 'V';
+    outgoing[2] = type;
+    outgoing[3] = static_cast<uint8_t>(role);
+    put64(outgoing + 4, sessionSeed);
+    socket.send(outgoing, HELLO_SIZE);
+    stats.packetsSent++;
+}
+
+void RollbackSession::sendInputs() {
+    // Tudo o que o peer ainda no confirmou (limitado pela janela de stall)
+    const uint32_t first = remoteAck;
+    const uint32_t count = std::min<uint32_t>(frame - first, 255);
+
+    // O tick mais recente j simulado com as entradas reais dos dois lados
+    const uint32_t hashTick = std::min(frame, remoteConfirmed);
+    uint64_t hash = 0;
+    const bool hasHash = hashTick > 0 && game.getTickHash(hashTick, hash);
+
+    outgoing[0] = 'P';
+    outgoing[1] = 'V';
+    outgoing[2] = PACKET_INPUT;
+    outgoing[3] = static_cast<uint8_t>(count);
+    put32(outgoing + 4, first);
+    put32(outgoing + 8, remoteConfirmed);
+    put32(outgoing + 12, hasHash ? hashTick : 0);
+    put32(outgoing + 16, static_cast<uint32_t>(hash));
+    for (uint32_t i = 0; i < count; i++) {
+        outgoing[INPUT_HEADER_SIZE + i] = localInputs[(first + i) % INPUT_WINDOW];
+    }
+    socket.send(outgoing, INPUT_HEADER_SIZE + count);
+    stats.packetsSent++;
+}
+
+void RollbackSession::sendBye() {
+    outgoing[0] = 'P';
+    outgoing[1] = 'V';
+    outgoing[2] = PACKET_BYE;
+    socket.send(outgoing, 3);
+    stats.packetsSent++;
+}
@@ -1,153 +1,178 @@
 #include "pacman.h"
-#include <curses.h>
+#include "state_hash.h"
 
 // Construtor
-Pacman::Pacman(int startX, int startY)
-    : GameObject(startX, startY, 1, 1, 1),  // Tamanho 1x1, velocidade 1
-    direction_x(0), direction_y(0),        // Comea parado
+Pacman::Pacman(EntityWorld& entityWorld, int startX, int startY)
+    : world(&entityWorld),
+    entity(entityWorld.create(COMPONENT_POSITION | COMPONENT_VELOCITY |
+        COMPONENT_RENDERABLE | COMPONENT_COLLIDER)),
+    pendingDirectionX(0), pendingDirectionY(0),
+    pendingTicks(0),
+    turnBufferTicks(0),
     spawn_x(startX), spawn_y(startY),      // Guarda posio inicial
-    lives(3),                              // Comea com 3 vidas
-    score(0),                              // Comea com 0 pontos
-    isPowered(false),                      // Comea sem power pellet
-    powerTimer(0),                         // Timer do poder zerado
-    pacmanChar('C')                        // Caractere 'C' representa o Pacman
+    isPowered(false)                       // Comea sem power pellet
 {
+    world->getPosition(entity) = Position{ static_cast<int16_t>(startX), static_cast<int16_t>(startY) };
+    world->getVelocity(entity).speed = 1;                  // Comea parado, uma casa por passo
+    world->getRenderable(entity) = Renderable{ 'C', 1, 0 };  // 'C' amarelo (ver PacmanUI)
+    world->getCollider(entity).layer = LAYER_PLAYER;
 }
 
-// Movimento do Pacman
+Pacman::~Pacman() {
+    world->destroy(entity);
+}
+
+// Movimento do Pacman num tick: getSpeed() passos de uma casa, parando na
+// primeira parede. O Game faz o mesmo com step(), comendo os pellets das
+// casas por onde passa.
 void Pacman::move(Board& board) {
-    // Calcula nova posio baseada na direo
-    int newX = x + (direction_x * speed);
-    int newY = y + (direction_y * speed);
-
-    // S move se a nova posio for vlida
-    if (canMoveTo(newX, newY, board)) {
-        x = newX;
-        y = newY;
+    const int speed = getSpeed();
+    for (int i = 0; i < speed; i++) {
+        if (!step(board)) break;
     }
+    endMove();
+}
 
-    // Atualiza estado do power pellet
-    updatePowerState();
+// Um passo: a viragem pendente  tentada em cada casa, e o sistema de
+// movimento s avana se a casa seguinte for legal
+bool Pacman::step(const Board& board) {
+    applyBufferedTurn(board);
+    return world->step(entity, board);
 }
 
-// Verifica se pode mover para uma posio
-bool Pacman::canMoveTo(int newX, int newY, Board& board) {
-    // Checa se a posio est dentro do tabuleiro e no  parede
-    return board.isValidPosition(newX, newY) && !board.isWall(newX, newY);
+// A janela de pr-viragem conta ticks, no passos
+void Pacman::endMove() {
+    if (pendingTicks > 0) {
+        pendingTicks--;   // Ainda bloqueada: continua na direo atual
+    }
 }
 
-// Muda a direo do movimento
+// Muda a direo do movimento. Com janela de pr-viragem a mudana s
+// acontece no prximo move(), numa casa onde a nova direo seja legal:
+// o jogador pode carregar antes da esquina em vez de acertar na casa exata
 void Pacman::changeDirection(int dx, int dy) {
-    direction_x = dx;
-    direction_y = dy;
+    if (turnBufferTicks <= 0) {
+        Velocity& velocity = world->getVelocity(entity);
+        velocity.dx = static_cast<int8_t>(dx);
+        velocity.dy = static_cast<int8_t>(dy);
+        return;
+    }
+    pendingDirectionX = dx;
+    pendingDirectionY = dy;
+    pendingTicks = turnBufferTicks;
 }
 
-// Coleta pellet normal
-void Pacman::collectPellet(int points) {
-    score += points;
+void Pacman::setTurnBuffer(int ticks) {
+    turnBufferTicks = ticks > 0 ? ticks : 0;
+    if (turnBufferTicks == 0) {
+        pendingTicks = 0;
+    }
 }
 
-// Coleta power pellet
-void Pacman::collectPowerPellet() {
-    isPowered = true;
-    powerTimer = 300;  // ~10 segundos de poder
-    score += 50;       // Power pellets valem mais pontos
+void Pacman::setSpeed(int speed) {
+    world->getVelocity(entity).speed = static_cast<uint8_t>(speed);
 }
 
-// Perde uma vida
-void Pacman::loseLife() {
-    if (lives > 0) {
-        lives--;
-        respawn();  // Volta para posio inicial
+void Pacman::applyBufferedTurn(const Board& board) {
+    if (pendingTicks <= 0) return;
+
+    const Position& position = world->getPosition(entity);
+    if (board.canMove(position.x, position.y, pendingDirectionX, pendingDirectionY)) {
+        Velocity& velocity = world->getVelocity(entity);
+        velocity.dx = static_cast<int8_t>(pendingDirectionX);
+        velocity.dy = static_cast<int8_t>(pendingDirectionY);
+        pendingTicks = 0;
     }
 }
 
 // Volta para posio inicial
 void Pacman::respawn() {
     // Reseta posio
-    x = spawn_x;
-    y = spawn_y;
+    world->getPosition(entity) = Position{ static_cast<int16_t>(spawn_x), static_cast<int16_t>(spawn_y) };
 
     // Reseta direo
-    direction_x = 0;
-    direction_y = 0;
+    Velocity& velocity = world->getVelocity(entity);
+    velocity.dx = 0;
+    velocity.dy = 0;
+    pendingTicks = 0;
 
     // Reseta poder
     isPowered = false;
-    powerTimer = 0;
 }
 
 // Verifica se power pellet est ativo
 bool Pacman::isPowerPelletActive() const {
-    return isPowered && powerTimer > 0;
-}
-
-// Atualiza estado do power pellet
-void Pacman::updatePowerState() {
-    if (isPowered) {
-        if (--powerTimer <= 0) {
-            isPowered = false;  // Poder acabou
-        }
+    return isPowered;
+}
+
+void Pacman::setPowered(bool powered) {
+    isPowered = powered;
+}
+
+// Hash do estado: posio, direo, poder e velocidade (as vidas so do Game)
+uint64_t Pacman::getHash() const {
+    const Position& position = world->getPosition(entity);
+    const Velocity& velocity = world->getVelocity(entity);
+    int directionCode = velocity.dy < 0 ? 1 : velocity.dy > 0 ? 2 :
+        velocity.dx < 0 ? 3 : velocity.dx > 0 ? 4 : 0;
+    uint64_t counters = static_cast<uint64_t>(velocity.speed) << 48;
+    uint64_t hash = StateHash::position(0, position.x, position.y) ^
+        StateHash::entityState(0, directionCode * 2 + (isPowered ? 1 : 0)) ^
+        StateHash::mix(counters);
+    // Sem pedido pendente o hash fica igual ao de antes da pr-viragem
+    if (pendingTicks > 0) {
+        int pendingCode = pendingDirectionY < 0 ? 1 : pendingDirectionY > 0 ? 2 :
+            pendingDirectionX < 0 ? 3 : pendingDirectionX > 0 ? 4 : 0;
+        hash ^= StateHash::mix(0x200000000ULL + (static_cast<uint64_t>(pendingCode) << 8) +
+            static_cast<uint64_t>(pendingTicks & 0xFF));
     }
+    return hash;
+}
+
+// Snapshots
+void Pacman::saveState(PacmanSnapshot& out) const {
+    const Position& position = world->getPosition(entity);
+    const Velocity& velocity = world->getVelocity(entity);
+    out.x = position.x;
+    out.y = position.y;
+    out.powerTimer = 0;   // O Game preenche com o timer da roda
+    out.directionX = velocity.dx;
+    out.directionY = velocity.dy;
+    out.powered = isPowered ? 1 : 0;
+    out.speed = velocity.speed;
+    out.pendingDirectionX = static_cast<int8_t>(pendingDirectionX);
+    out.pendingDirectionY = static_cast<int8_t>(pendingDirectionY);
+    out.pendingTicks = static_cast<uint8_t>(pendingTicks);
+    out.turnBufferTicks = static_cast<uint8_t>(turnBufferTicks);
+}
+
+void Pacman::restoreState(const PacmanSnapshot& in) {
+    world->getPosition(entity) = Position{ in.x, in.y };
+    world->getVelocity(entity) = Velocity{ in.directionX, in.directionY, in.speed };
+    isPowered = in.powered != 0;
+    pendingDirectionX = in.pendingDirectionX;
+    pendingDirectionY = in.pendingDirectionY;
+    pendingTicks = in.pendingTicks;
+    turnBufferTicks = in.turnBufferTicks;
 }
 
-//Verifica as colissoes do pacman com as paredes
-void Pacman::move(Board& board) {
-    // Calcula nova posio baseada na direo atual
-    int newX = x + (direction_x * speed);
-    int newY = y + (direction_y * speed);
-
-    // S move se no houver parede
-    if (canwalk(novoX, newY, board)) {
-        x = newX;
-        y = newY;
-
-        // Verifica se pegou pastilha
-        if (board.isPellet(x, y)) {
-            collectPellet(10);
-            board.removePellet(x, y);
-        }
-        // Verifica se pegou power pellet
-        else if (board.isPowerPellet(x, y)) {
-            collectPowerPellet();
-            board.removePellet(x, y);
-        }
-    }
-}
-
-bool Pacman::canwalk(int newX, int newY, const Board& board) {
-    // Verifica limites do tabuleiro
-    if (newX < 0 || newX >= board.getWidth() ||
-        newY < 0 || newY >= board.getHeight()) {
-        return false;
-    }
-
-    // Verifica se tem parede
-    return !board.isWall(newX, newY);
-}
-
-
-
-// Desenha o Pacman
-void Pacman::draw() {
-    attron(COLOR_PAIR(1));  // Usa cor amarela (definida na PacmanUI)
-    mvaddch(y, x, pacmanChar);
-    attroff(COLOR_PAIR(1));
+// Getters
+int Pacman::getX() const {
+    return world->getPosition(entity).x;
 }
 
-// Getters
-int Pacman::getLives() const {
-    return lives;
+int Pacman::getY() const {
+    return world->getPosition(entity).y;
 }
 
-int Pacman::getScore() const {
-    return score;
+int Pacman::getSpeed() const {
+    return world->getVelocity(entity).speed;
 }
 
 int Pacman::getDirectionX() const {
-    return direction_x;
+    return world->getVelocity(entity).dx;
 }
 
 int Pacman::getDirectionY() const {
-    return direction_y;
+    return world->getVelocity(entity).dy;
 }
\ No newline at end of file
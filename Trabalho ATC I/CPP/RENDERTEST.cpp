@@ -0,0 +1,308 @@
+// Teste do renderer ANSI sem terminal: compe frames aleatrios (texto,
+// UTF-8, molduras, cores, estilos, ecrs limpos), envia-os pelo AnsiBackend
+// para um ficheiro temporrio e interpreta os bytes num modelo de terminal
+// VT (CUP, CUU/CUD/CUF/CUB, CR/LF, SGR, ED, DEC Special Graphics). Depois de
+// cada present() o modelo tem de mostrar exatamente a grelha composta e o
+// frame tem de ter sado num nico write().
+//
+// Uso: pacman_render_test [--frames N] [--seed N] [--width N] [--height N]
+#include "frame_renderer.h"
+#include "game_random.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    // Os mesmos de FRAMERENDERER.cpp (o teste verifica o que vai para o terminal)
+    const int PAIR_FOREGROUND[] = { 39, 33, 31, 35, 36, 32, 37, 34 };
+    const int PAIR_COUNT = sizeof(PAIR_FOREGROUND) / sizeof(PAIR_FOREGROUND[0]);
+    const char DEC_LINE_CHARS[] = { 'x', 'q', 'l', 'k', 'm', 'j' };   // Pela ordem de LineGlyph
+
+    // Em escapes UTF-8, para no depender da codificao deste ficheiro
+    const char* const TEXTS[] = { "Pac-Man", "N\xC3\xADvel", "Pontos: 1200", "\xC2\xB7", "GAME OVER",
+        "\xC3\xA7\xC3\xA3o" };
+
+    // Terminal VT mnimo: s o que o AnsiBackend envia. Qualquer outra
+    // sequncia  um erro do teste.
+    class VtModel {
+    public:
+        VtModel(int width, int height)
+            : width(width), height(height),
+            cells(static_cast<size_t>(width) * height, blank()),
+            x(0), y(0), color(0), style(STYLE_NONE), lineCharset(false) {}
+
+        void feed(const char* bytes, size_t count) {
+            size_t i = 0;
+            while (i < count) {
+                const unsigned char byte = static_cast<unsigned char>(bytes[i]);
+                if (byte == 0x1b) {
+                    i = escape(bytes, count, i);
+                }
+                else if (byte == '\r') {
+                    x = 0;
+                    i++;
+                }
+                else if (byte == '\n') {
+                    if (y < height - 1) y++;
+                    i++;
+                }
+                else {
+                    i = printable(bytes, count, i);
+                }
+            }
+        }
+
+        const ScreenCell& at(int column, int row) const { return cells[row * width + column]; }
+
+    private:
+        int width;
+        int height;
+        std::vector<ScreenCell> cells;
+        int x, y;
+        uint8_t color;
+        uint8_t style;
+        bool lineCharset;
+
+        static ScreenCell blank() {
+            ScreenCell cell = { ' ', 0, STYLE_NONE, 0 };
+            return cell;
+        }
+
+        size_t escape(const char* bytes, size_t count, size_t i) {
+            if (i + 2 >= count) {
+                throw std::runtime_error("Sequncia de escape cortada");
+            }
+            if (bytes[i + 1] == '(') {
+                if (bytes[i + 2] == '0') lineCharset = true;
+                else if (bytes[i + 2] == 'B') lineCharset = false;
+                else throw std::runtime_error("Charset desconhecido");
+                return i + 3;
+            }
+            if (bytes[i + 1] != '[') {
+                throw std::runtime_error("Escape desconhecido");
+            }
+
+            int params[8];
+            int paramCount = 0;
+            int value = -1;
+            size_t j = i + 2;
+            for (; j < count; j++) {
+                const char c = bytes[j];
+                if (c >= '0' && c <= '9') {
+                    value = (value < 0 ? 0 : value * 10) + (c - '0');
+                }
+                else if (c == ';') {
+                    if (paramCount == 8) throw std::runtime_error("Parmetros a mais");
+                    params[paramCount++] = value;
+                    value = -1;
+                }
+                else {
+                    break;
+                }
+            }
+            if (j == count) {
+                throw std::runtime_error("Sequncia CSI cortada");
+            }
+            if (paramCount == 8) throw std::runtime_error("Parmetros a mais");
+            params[paramCount++] = value;
+
+            const int first = params[0] < 0 ? 1 : params[0];
+            switch (bytes[j]) {
+            case 'H':
+                y = first - 1;
+                x = (paramCount > 1 && params[1] >= 0 ? params[1] : 1) - 1;
+                break;
+            case 'A': y -= first; break;
+            case 'B': y += first; break;
+            case 'C': x += first; break;
+            case 'D': x -= first; break;
+            case 'J':
+                if (params[0] != 2) throw std::runtime_error("ED sem ser do ecr todo");
+                for (ScreenCell& cell : cells) cell = blank();
+                break;
+            case 'm':
+                for (int p = 0; p < paramCount; p++) sgr(params[p] < 0 ? 0 : params[p]);
+                break;
+            default:
+                throw std::runtime_error(std::string("CSI desconhecido: ") + bytes[j]);
+            }
+            if (x < 0 || y < 0 || x >= width || y >= height) {
+                throw std::runtime_error("Cursor fora do ecr");
+            }
+            return j + 1;
+        }
+
+        void sgr(int code) {
+            if (code == 0) {
+                color = 0;
+                style = STYLE_NONE;
+            }
+            else if (code == 1) style |= STYLE_BOLD;
+            else if (code == 7) style |= STYLE_REVERSE;
+            else if (code == 40) {
+                // Fundo preto: o de todos os pares
+            }
+            else {
+                for (int pair = 1; pair < PAIR_COUNT; pair++) {
+                    if (PAIR_FOREGROUND[pair] == code) {
+                        color = static_cast<uint8_t>(pair);
+                        return;
+                    }
+                }
+                throw std::runtime_error("SGR desconhecido: " + std::to_string(code));
+            }
+        }
+
+        size_t printable(const char* bytes, size_t count, size_t i) {
+            if (x >= width) {
+                throw std::runtime_error("Escrita depois da ltima coluna");
+            }
+            ScreenCell cell = { 0, color, style, 0 };
+            const unsigned char byte = static_cast<unsigned char>(bytes[i]);
+            int length = 1;
+            if (lineCharset) {
+                const char* found = static_cast<const char*>(std::memchr(DEC_LINE_CHARS, byte, sizeof(DEC_LINE_CHARS)));
+                if (!found) throw std::runtime_error("Carcter de moldura desconhecido");
+                cell.glyph = static_cast<uint32_t>(found - DEC_LINE_CHARS);
+                cell.style |= STYLE_LINE;
+            }
+            else {
+                // Como o charLength do FrameRenderer: um byte que no comea
+                // uma sequncia UTF-8 vlida  um carcter (latin1)
+                if ((byte & 0xE0) == 0xC0) length = 2;
+                else if ((byte & 0xF0) == 0xE0) length = 3;
+                else if ((byte & 0xF8) == 0xF0) length = 4;
+                for (int k = 1; k < length; k++) {
+                    if (i + k >= count || (static_cast<unsigned char>(bytes[i + k]) & 0xC0) != 0x80) {
+                        length = 1;
+                        break;
+                    }
+                }
+                for (int k = 0; k < length; k++) {
+                    cell.glyph |= static_cast<uint32_t>(static_cast<unsigned char>(bytes[i + k])) << (8 * k);
+                }
+            }
+            cells[y * width + x] = cell;
+            x++;   // Na ltima coluna fica  espera de mudar de linha
+            return i + length;
+        }
+    };
+
+    int parseNumber(const char* text, const char* option) {
+        char* end = nullptr;
+        long value = std::strtol(text, &end, 10);
+        if (!end || *end != '\0' || value <= 0) {
+            throw std::runtime_error(std::string("Valor invlido para ") + option);
+        }
+        return static_cast<int>(value);
+    }
+
+    void composeRandomFrame(FrameRenderer& screen, GameRandom& rng) {
+        const int width = screen.getWidth();
+        const int height = screen.getHeight();
+        static const uint8_t STYLES[] = { STYLE_NONE, STYLE_BOLD, STYLE_REVERSE, STYLE_BOLD | STYLE_REVERSE };
+
+        // De vez em quando um ecr novo (redesenho completo)
+        if (rng.nextInt(50) == 0) {
+            screen.clear();
+        }
+        const int changes = rng.nextInt(60);
+        for (int i = 0; i < changes; i++) {
+            const int x = rng.nextInt(width);
+            const int y = rng.nextInt(height);
+            const uint8_t color = static_cast<uint8_t>(rng.nextInt(PAIR_COUNT));
+            switch (rng.nextInt(4)) {
+            case 0:
+                screen.putLine(x, y, static_cast<LineGlyph>(rng.nextInt(6)), color);
+                break;
+            case 1:
+                screen.print(x, y, TEXTS[rng.nextInt(sizeof(TEXTS) / sizeof(TEXTS[0]))], color,
+                    STYLES[rng.nextInt(4)]);
+                break;
+            default:
+                screen.put(x, y, static_cast<uint32_t>(' ' + rng.nextInt(95)), color, STYLES[rng.nextInt(4)]);
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        int frames = 3000;
+        uint64_t seed = 1;
+        int width = 80;
+        int height = 24;
+        for (int i = 1; i < argc; i++) {
+            const std::string option = argv[i];
+            if (i + 1 >= argc) throw std::runtime_error("Falta o valor de " + option);
+            if (option == "--frames") frames = parseNumber(argv[++i], "--frames");
+            else if (option == "--seed") seed = static_cast<uint64_t>(parseNumber(argv[++i], "--seed"));
+            else if (option == "--width") width = parseNumber(argv[++i], "--width");
+            else if (option == "--height") height = parseNumber(argv[++i], "--height");
+            else throw std::runtime_error("Opo desconhecida: " + option);
+        }
+
+        // O backend escreve num ficheiro; o modelo l o que cada frame acrescentou
+        std::FILE* output = std::tmpfile();
+        if (!output) throw std::runtime_error("No foi possvel criar o ficheiro temporrio");
+        const int fd = fileno(output);
+
+        AnsiBackend* backend = new AnsiBackend(fd, width, height);
+        FrameRenderer screen(width, height, std::unique_ptr<ScreenBackend>(backend));
+        VtModel terminal(width, height);
+        GameRandom rng(seed);
+
+        off_t readOffset = 0;
+        std::vector<char> bytes;
+        long long totalBytes = 0;
+        for (int frame = 0; frame < frames; frame++) {
+            composeRandomFrame(screen, rng);
+            const long long writesBefore = backend->getWrites();
+            screen.present(static_cast<uint32_t>(frame));
+
+            const off_t end = lseek(fd, 0, SEEK_END);
+            bytes.resize(static_cast<size_t>(end - readOffset));
+            if (!bytes.empty() && pread(fd, bytes.data(), bytes.size(), readOffset) != static_cast<ssize_t>(bytes.size())) {
+                throw std::runtime_error("Erro ao ler o ficheiro temporrio");
+            }
+            readOffset = end;
+            totalBytes += static_cast<long long>(bytes.size());
+
+            const long long writes = backend->getWrites() - writesBefore;
+            if (writes != (bytes.empty() ? 0 : 1)) {
+                std::fprintf(stderr, "Frame %d: %lld write() para %zu bytes\n", frame, writes, bytes.size());
+                return 1;
+            }
+            terminal.feed(bytes.data(), bytes.size());
+
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    const ScreenCell& expected = screen.at(x, y);
+                    const ScreenCell& shown = terminal.at(x, y);
+                    if (expected != shown) {
+                        std::fprintf(stderr, "Frame %d, casa (%d, %d): esperado %08x/%d/%d, terminal %08x/%d/%d\n",
+                            frame, x, y, expected.glyph, expected.color, expected.style,
+                            shown.glyph, shown.color, shown.style);
+                        return 1;
+                    }
+                }
+            }
+        }
+
+        std::printf("%d frames iguais ao modelo VT, %.1f bytes por frame\n", frames,
+            frames > 0 ? static_cast<double>(totalBytes) / frames : 0.0);
+        return 0;   // O ficheiro temporrio desaparece com o processo
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "Erro: %s\n", error.what());
+        return 1;
+    }
+}
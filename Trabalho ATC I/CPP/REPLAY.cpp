@@ -0,0 +1,269 @@
+#include "replay.h"
+#include <curses.h>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+
+namespace {
+    const char REPLAY_MAGIC[4] = { 'P', 'M', 'R', 'P' };
+    const uint8_t REPLAY_VERSION = 3;
+    const uint8_t REPLAY_VERSION_NO_TURN_BUFFER = 2;
+    const uint8_t REPLAY_VERSION_NO_CHECKSUMS = 1;
+}
+
+ReplayCode replayCodeForKey(int key) {
+    switch (key) {
+    case KEY_UP:    return ReplayCode::UP;
+    case KEY_DOWN:  return ReplayCode::DOWN;
+    case KEY_LEFT:  return ReplayCode::LEFT;
+    case KEY_RIGHT: return ReplayCode::RIGHT;
+    case 'p':
+    case 'P':       return ReplayCode::PAUSE;
+    default:        return ReplayCode::RAW;
+    }
+}
+
+int replayKeyForCode(ReplayCode code) {
+    switch (code) {
+    case ReplayCode::UP:    return KEY_UP;
+    case ReplayCode::DOWN:  return KEY_DOWN;
+    case ReplayCode::LEFT:  return KEY_LEFT;
+    case ReplayCode::RIGHT: return KEY_RIGHT;
+    case ReplayCode::PAUSE: return 'p';
+    default:                return ERR;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ReplayRecorder
+
+ReplayRecorder::ReplayRecorder(const std::string& filePath, uint32_t checksumInterval)
+    : path(filePath), checksumInterval(checksumInterval), lastTick(0), recording(false) {
+}
+
+void ReplayRecorder::beginSession(uint64_t seed, int mazeId,
+    const std::vector<Game::LevelConfig>& configs) {
+    buffer.clear();
+    buffer.reserve(INITIAL_CAPACITY);   // O tick no cresce o vetor
+    for (int i = 0; i < 4; i++) {
+        buffer.push_back(REPLAY_MAGIC[i]);
+    }
+    buffer.push_back(REPLAY_VERSION);
+    writeVarint(static_cast<uint64_t>(mazeId));
+
+    // Seed em 8 bytes fixos (em varint ocuparia at 10)
+    for (int i = 0; i < 8; i++) {
+        buffer.push_back(static_cast<uint8_t>(seed >> (8 * i)));
+    }
+
+    writeVarint(configs.size());
+    for (const auto& config : configs) {
+        writeVarint(static_cast<uint64_t>(config.ghostSpeed));
+        writeVarint(static_cast<uint64_t>(config.pacmanSpeed));
+        writeVarint(static_cast<uint64_t>(config.powerPelletDuration));
+        writeVarint(static_cast<uint64_t>(config.bonusPoints));
+        writeVarint(static_cast<uint64_t>(config.turnBufferTicks));
+    }
+    writeVarint(checksumInterval);
+
+    lastTick = 0;
+    recording = true;
+}
+
+void ReplayRecorder::recordInput(uint32_t tick, int key) {
+    if (!recording) return;
+
+    ReplayCode code = replayCodeForKey(key);
+    writeEvent(tick, code);
+    if (code == ReplayCode::RAW) {
+        writeVarint(static_cast<uint32_t>(key));
+    }
+}
+
+void ReplayRecorder::recordChecksum(uint32_t tick, uint64_t hash) {
+    if (!recording || checksumInterval == 0 || tick % checksumInterval != 0) return;
+
+    writeEvent(tick, ReplayCode::CHECKSUM);
+    for (int i = 0; i < 4; i++) {
+        buffer.push_back(static_cast<uint8_t>(hash >> (8 * i)));
+    }
+}
+
+void ReplayRecorder::endSession(uint32_t tick, int score, int lives, int level) {
+    if (!recording) return;
+
+    writeEvent(tick, ReplayCode::END);
+    writeVarint(static_cast<uint64_t>(score));
+    writeVarint(static_cast<uint64_t>(lives < 0 ? 0 : lives));
+    writeVarint(static_cast<uint64_t>(level));
+    recording = false;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Nao foi possivel gravar o replay: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+}
+
+void ReplayRecorder::writeEvent(uint32_t tick, ReplayCode code) {
+    // Run-length: s guardamos quantos ticks passaram desde o ltimo evento
+    uint64_t delta = tick - lastTick;
+    writeVarint((delta << 3) | static_cast<uint8_t>(code));
+    lastTick = tick;
+}
+
+void ReplayRecorder::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+// ---------------------------------------------------------------------------
+// ReplayPlayer
+
+void ReplayPlayer::load(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Replay nao encontrado: " + filePath);
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (data.size() < 5 || !std::equal(REPLAY_MAGIC, REPLAY_MAGIC + 4, data.begin())) {
+        throw std::runtime_error("Ficheiro de replay invalido: " + filePath);
+    }
+    if (data[4] < REPLAY_VERSION_NO_CHECKSUMS || data[4] > REPLAY_VERSION) {
+        throw std::runtime_error("Versao de replay nao suportada");
+    }
+
+    size_t pos = 5;
+    header = ReplayHeader();
+    header.mazeId = static_cast<int>(readVarint(data, pos));
+    if (pos + 8 > data.size()) {
+        throw std::runtime_error("Replay truncado");
+    }
+    for (int i = 0; i < 8; i++) {
+        header.seed |= static_cast<uint64_t>(data[pos++]) << (8 * i);
+    }
+
+    uint64_t configCount = readVarint(data, pos);
+    for (uint64_t i = 0; i < configCount; i++) {
+        Game::LevelConfig config;
+        config.ghostSpeed = static_cast<int>(readVarint(data, pos));
+        config.pacmanSpeed = static_cast<int>(readVarint(data, pos));
+        config.powerPelletDuration = static_cast<int>(readVarint(data, pos));
+        config.bonusPoints = static_cast<int>(readVarint(data, pos));
+        // Gravados antes da pr-viragem: a direo mudava logo
+        config.turnBufferTicks = data[4] > REPLAY_VERSION_NO_TURN_BUFFER
+            ? static_cast<int>(readVarint(data, pos)) : 0;
+        header.levelConfigs.push_back(config);
+    }
+    if (data[4] > REPLAY_VERSION_NO_CHECKSUMS) {
+        header.checksumInterval = static_cast<uint32_t>(readVarint(data, pos));
+    }
+    eventsStart = pos;
+
+    // Percorre os eventos uma vez para validar e ler o resumo final
+    uint32_t tick = 0;
+    for (;;) {
+        uint64_t event = readVarint(data, pos);
+        tick += static_cast<uint32_t>(event >> 3);
+        ReplayCode code = static_cast<ReplayCode>(event & 7);
+        if (code == ReplayCode::RAW) {
+            readVarint(data, pos);
+        }
+        else if (code == ReplayCode::CHECKSUM) {
+            if (pos + 4 > data.size()) {
+                throw std::runtime_error("Replay truncado");
+            }
+            pos += 4;
+        }
+        else if (code == ReplayCode::END) {
+            recorded.totalTicks = tick;
+            recorded.score = static_cast<int>(readVarint(data, pos));
+            recorded.lives = static_cast<int>(readVarint(data, pos));
+            recorded.level = static_cast<int>(readVarint(data, pos));
+            break;
+        }
+    }
+}
+
+ReplayResult ReplayPlayer::play(Game& game) const {
+    if (game.getMazeId() != header.mazeId) {
+        throw std::runtime_error("Replay gravado noutro labirinto");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    game.setRecorder(nullptr);
+    game.setLevelConfigs(header.levelConfigs);
+    game.setSeed(header.seed);
+    game.startGame();
+
+    ReplayResult result;
+
+    // Os eventos j foram validados em load()
+    size_t pos = eventsStart;
+    uint32_t tick = 0;
+    for (;;) {
+        uint64_t event = readVarint(data, pos);
+        uint32_t target = tick + static_cast<uint32_t>(event >> 3);
+        while (tick < target) {
+            game.updateGameState();
+            tick++;
+        }
+
+        ReplayCode code = static_cast<ReplayCode>(event & 7);
+        if (code == ReplayCode::END) {
+            break;
+        }
+        if (code == ReplayCode::CHECKSUM) {
+            uint32_t expected = 0;
+            for (int i = 0; i < 4; i++) {
+                expected |= static_cast<uint32_t>(data[pos++]) << (8 * i);
+            }
+            if (static_cast<uint32_t>(game.getStateHash()) == expected) {
+                result.checksumsVerified++;
+            }
+            else if (result.divergedAtTick == 0) {
+                result.divergedAtTick = tick;
+            }
+            continue;
+        }
+        int key = code == ReplayCode::RAW ? static_cast<int>(readVarint(data, pos))
+            : replayKeyForCode(code);
+        game.handleInput(key);
+    }
+
+    result.summary.totalTicks = game.getTickCount();
+    result.summary.score = game.getScore();
+    result.summary.lives = game.getLives() < 0 ? 0 : game.getLives();
+    result.summary.level = game.getLevel();
+    result.matchesRecording =
+        result.summary.totalTicks == recorded.totalTicks &&
+        result.summary.score == recorded.score &&
+        result.summary.lives == recorded.lives &&
+        result.summary.level == recorded.level &&
+        result.divergedAtTick == 0;
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+uint64_t ReplayPlayer::readVarint(const std::vector<uint8_t>& bytes, size_t& pos) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= bytes.size()) {
+            throw std::runtime_error("Replay truncado");
+        }
+        uint8_t byte = bytes[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Varint invalido no replay");
+}
@@ -0,0 +1,277 @@
+#include "replay_stream.h"
+#include "snapshot_delta.h"
+#include "game.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    const char STREAM_MAGIC[4] = { 'P', 'M', 'R', 'S' };
+    const char INDEX_MAGIC[4] = { 'P', 'M', 'R', 'I' };
+    const uint8_t STREAM_VERSION = 5;   // 5: GameSnapshot v5
+    const size_t TRAILER_SIZE = 8 + 4 + 4;
+
+    // Marcadores de registo (os deltas tm sempre flags < 0x80)
+    const uint8_t RECORD_KEYFRAME = 0x80;
+    const uint8_t RECORD_END = 0xFF;
+
+    void putLE(uint8_t* out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    uint64_t getLE(const uint8_t* in, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ReplayStreamWriter
+
+ReplayStreamWriter::ReplayStreamWriter(const std::string& path, int keyframeInterval)
+    : file(nullptr),
+    buffer(nullptr),
+    used(0),
+    fileOffset(0),
+    keyframeInterval(keyframeInterval > 0 ? keyframeInterval : DEFAULT_KEYFRAME_INTERVAL),
+    frameCount(0),
+    framesSinceKeyframe(0),
+    hasPrevious(false)
+{
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Nao foi possivel criar o stream de replay: " + path);
+    }
+    buffer = new uint8_t[BUFFER_SIZE];
+    index.reserve(INDEX_CAPACITY);
+
+    putBytes(STREAM_MAGIC, 4);
+    putByte(STREAM_VERSION);
+    putVarint(static_cast<uint64_t>(this->keyframeInterval));
+}
+
+ReplayStreamWriter::~ReplayStreamWriter() {
+    if (file) {
+        try {
+            finish();
+        }
+        catch (...) {
+            // Um destrutor no pode propagar excees
+        }
+    }
+    delete[] buffer;
+}
+
+void ReplayStreamWriter::captureTick(const Game& game) {
+    game.saveSnapshot(current);
+    captureSnapshot(current);
+}
+
+void ReplayStreamWriter::captureSnapshot(const GameSnapshot& snapshot) {
+    if (!file) return;
+
+    if (&snapshot != &current) {
+        std::memcpy(&current, &snapshot, sizeof(current));
+    }
+
+    ensureSpace(MAX_RECORD_SIZE);
+    if (needsKeyframe()) {
+        writeKeyframe();
+        framesSinceKeyframe = 1;
+    }
+    else {
+        writeDelta();
+        framesSinceKeyframe++;
+    }
+
+    std::memcpy(&previous, &current, sizeof(previous));
+    hasPrevious = true;
+    frameCount++;
+}
+
+bool ReplayStreamWriter::needsKeyframe() const {
+    return !hasPrevious ||
+        framesSinceKeyframe >= static_cast<uint32_t>(keyframeInterval) ||
+        needsSnapshotKeyframe(previous, current);
+}
+
+void ReplayStreamWriter::writeKeyframe() {
+    ReplayIndexEntry entry;
+    entry.frame = frameCount;
+    entry.offset = fileOffset + used;
+    index.push_back(entry);
+
+    putByte(RECORD_KEYFRAME);
+    putBytes(&current, sizeof(current));
+}
+
+void ReplayStreamWriter::writeDelta() {
+    used += encodeSnapshotDelta(previous, current, buffer + used);
+}
+
+void ReplayStreamWriter::finish() {
+    if (!file) return;
+
+    ensureSpace(1);
+    putByte(RECORD_END);
+
+    const uint64_t indexOffset = fileOffset + used;
+    ensureSpace(10);
+    putVarint(index.size());
+    for (const auto& entry : index) {
+        ensureSpace(12);
+        putLE(buffer + used, entry.frame, 4);
+        putLE(buffer + used + 4, entry.offset, 8);
+        used += 12;
+    }
+
+    ensureSpace(TRAILER_SIZE);
+    putLE(buffer + used, indexOffset, 8);
+    putLE(buffer + used + 8, frameCount ? frameCount - 1 : 0, 4);
+    used += 12;
+    putBytes(INDEX_MAGIC, 4);
+
+    flushBuffer();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void ReplayStreamWriter::ensureSpace(size_t bytes) {
+    if (used + bytes > BUFFER_SIZE) {
+        flushBuffer();
+    }
+}
+
+void ReplayStreamWriter::flushBuffer() {
+    if (used == 0) return;
+    if (std::fwrite(buffer, 1, used, file) != used) {
+        throw std::runtime_error("Erro ao escrever o stream de replay");
+    }
+    fileOffset += used;
+    used = 0;
+}
+
+void ReplayStreamWriter::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        putByte(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    putByte(static_cast<uint8_t>(value));
+}
+
+void ReplayStreamWriter::putBytes(const void* bytes, size_t count) {
+    std::memcpy(buffer + used, bytes, count);
+    used += count;
+}
+
+// ---------------------------------------------------------------------------
+// ReplayStreamReader
+
+void ReplayStreamReader::open(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Stream de replay nao encontrado: " + path);
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (data.size() < 5 + TRAILER_SIZE ||
+        !std::equal(STREAM_MAGIC, STREAM_MAGIC + 4, data.begin()) ||
+        !std::equal(INDEX_MAGIC, INDEX_MAGIC + 4, data.end() - 4)) {
+        throw std::runtime_error("Stream de replay invalido: " + path);
+    }
+    if (data[4] != STREAM_VERSION) {
+        throw std::runtime_error("Versao de stream nao suportada");
+    }
+
+    size_t pos = 5;
+    keyframeInterval = static_cast<int>(readVarint(pos));
+    recordsStart = pos;
+
+    const uint8_t* trailer = data.data() + data.size() - TRAILER_SIZE;
+    uint64_t indexOffset = getLE(trailer, 8);
+    lastFrame = static_cast<uint32_t>(getLE(trailer + 8, 4));
+    if (indexOffset >= data.size() - TRAILER_SIZE) {
+        throw std::runtime_error("Indice do stream invalido");
+    }
+
+    pos = static_cast<size_t>(indexOffset);
+    uint64_t count = readVarint(pos);
+    if (pos + count * 12 > data.size() - TRAILER_SIZE) {
+        throw std::runtime_error("Indice do stream truncado");
+    }
+    index.clear();
+    index.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; i++, pos += 12) {
+        ReplayIndexEntry entry;
+        entry.frame = static_cast<uint32_t>(getLE(&data[pos], 4));
+        entry.offset = getLE(&data[pos + 4], 8);
+        index.push_back(entry);
+    }
+}
+
+void ReplayStreamReader::seek(uint32_t frame, GameSnapshot& out) const {
+    if (index.empty() || frame > lastFrame) {
+        throw std::out_of_range("Frame fora do stream");
+    }
+
+    // ltimo keyframe com frame <= pedido
+    auto it = std::upper_bound(index.begin(), index.end(), frame,
+        [](uint32_t value, const ReplayIndexEntry& entry) { return value < entry.frame; });
+    if (it == index.begin()) {
+        throw std::out_of_range("Frame antes do primeiro keyframe");
+    }
+    --it;
+
+    size_t pos = static_cast<size_t>(it->offset);
+    for (uint32_t f = it->frame; ; f++) {
+        if (!applyRecord(pos, out)) {
+            throw std::runtime_error("Stream terminou antes do frame pedido");
+        }
+        if (f == frame) break;
+    }
+}
+
+bool ReplayStreamReader::applyRecord(size_t& pos, GameSnapshot& state) const {
+    if (pos >= data.size()) {
+        throw std::runtime_error("Stream de replay truncado");
+    }
+    uint8_t flags = data[pos++];
+
+    if (flags == RECORD_END) {
+        return false;
+    }
+    if (flags == RECORD_KEYFRAME) {
+        if (pos + sizeof(GameSnapshot) > data.size()) {
+            throw std::runtime_error("Keyframe truncado");
+        }
+        std::memcpy(&state, &data[pos], sizeof(GameSnapshot));
+        pos += sizeof(GameSnapshot);
+        return true;
+    }
+
+    pos--;   // As flags fazem parte do delta
+    pos += applySnapshotDelta(&data[pos], data.size() - pos, state);
+    return true;
+}
+
+uint64_t ReplayStreamReader::readVarint(size_t& pos) const {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= data.size()) {
+            throw std::runtime_error("Stream de replay truncado");
+        }
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Varint invalido no stream");
+}
@@ -0,0 +1,148 @@
+// Servidor de jogo sem interface: muitas partidas em paralelo, em event loops epoll.
+// Uso: pacman_server [--port N] [--unix CAMINHO] [--threads N] [--tick-rate N]
+//                    [--max-sessions N] [--report SEGUNDOS]
+//                    [--metrics-port N] [--metrics-file CAMINHO]
+// As mtricas (formato Prometheus) ficam em http://127.0.0.1:N/metrics e/ou
+// num ficheiro reescrito a cada 5 s, para o textfile collector do node_exporter.
+#include "game_server.h"
+#include "metrics.h"
+#include <sys/resource.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+
+static GameServer* activeServer = nullptr;
+
+static void onSignal(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+// Cada sesso  um descritor: sobe o limite suave at ao mximo permitido
+static void raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static void printStats(const GameServerStats& now, const GameServerStats& before,
+    double seconds, int ticksPerSecond) {
+    // Frames enviados (com os dos espectadores), no os codificados
+    const long long frames = now.framesSent;
+    const long long framesBefore = before.framesSent;
+    const double framesPerSecond = (frames - framesBefore) / seconds;
+    const double bytesPerSecond = (now.bytesSent - before.bytesSent) / seconds;
+    std::printf("sessoes %lld (%lld espectadores)  ticks/s %.0f  frames/s %.0f  %.1f bytes/frame  "
+        "%.2f MB/s  tick max %.2f ms (orcamento %.2f ms)  descartados %lld  resyncs %lld  "
+        "atrasados %lld\n",
+        now.sessions, now.spectators, (now.ticks - before.ticks) / seconds, framesPerSecond,
+        frames > framesBefore ? bytesPerSecond / framesPerSecond : 0.0,
+        bytesPerSecond / (1024.0 * 1024.0), now.maxTickMs, 1000.0 / ticksPerSecond,
+        now.droppedFrames, now.resyncs, now.lateTicks);
+    std::fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    GameServerConfig config;
+    int port = 0;
+    const char* unixPath = nullptr;
+    int reportSeconds = 5;
+    int metricsPort = 0;
+    std::string metricsFile;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+            unixPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            config.ticksPerSecond = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--max-sessions") == 0 && i + 1 < argc) {
+            config.maxSessions = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            reportSeconds = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metricsPort = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            metricsFile = argv[++i];
+        }
+    }
+    if (config.ticksPerSecond <= 0) config.ticksPerSecond = 60;
+    if (!port && !unixPath) port = 7777;
+
+    raiseFileLimit();
+
+    try {
+        GameServer server(config);
+        if (port) server.listenTcp(port);
+        if (unixPath) server.listenUnix(unixPath);
+        MetricsExporter metrics;
+        if (metricsPort > 0 || !metricsFile.empty()) {
+            metrics.start(metricsPort, metricsFile);
+        }
+
+        activeServer = &server;
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        std::printf("servidor: %d loops, %d ticks/s, ate %d sessoes", server.getThreadCount(),
+            config.ticksPerSecond, config.maxSessions);
+        if (port) std::printf(", tcp %d", port);
+        if (unixPath) std::printf(", unix %s", unixPath);
+        if (metricsPort > 0) std::printf(", metricas em http://127.0.0.1:%d/metrics", metricsPort);
+        std::printf("\n");
+        std::fflush(stdout);
+
+        // Relatrio peridico numa thread  parte; os loops no param para isso
+        std::atomic<bool> finished(false);
+        std::thread reporter([&]() {
+            GameServerStats before = server.getStats();
+            auto last = std::chrono::steady_clock::now();
+            while (!finished) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                auto now = std::chrono::steady_clock::now();
+                double seconds = std::chrono::duration<double>(now - last).count();
+                if (reportSeconds > 0 && seconds >= reportSeconds) {
+                    GameServerStats stats = server.getStats();
+                    printStats(stats, before, seconds, config.ticksPerSecond);
+                    before = stats;
+                    last = now;
+                }
+            }
+        });
+
+        server.run();
+        finished = true;
+        reporter.join();
+        activeServer = nullptr;
+
+        GameServerStats stats = server.getStats();
+        std::printf("total: %lld ligacoes (%lld recusadas), %lld ticks, %lld keyframes, "
+            "%lld deltas, %lld frames enviados, %lld bytes\n", stats.accepted, stats.rejected,
+            stats.ticks, stats.keyframes, stats.deltas, stats.framesSent, stats.bytesSent);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+#include "snapshot_delta.h"
+#include "game_random.h"
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+    // Seces de um delta
+    const uint8_t DELTA_MOVES = 0x01;    // Cdigos de movimento de 3 bits por entidade
+    const uint8_t DELTA_PELLETS = 0x02;  // Casas cujo bit de pellet mudou
+    const uint8_t DELTA_FIELDS = 0x04;   // Outros campos que mudaram
+    const uint8_t DELTA_RNG = 0x08;      // Nmeros aleatrios gerados no tick
+
+    // Acima disto (ex.: reset do nvel) sai mais barato um keyframe
+    const int MAX_PELLET_CHANGES = 32;
+
+    // Pac-Man + fantasmas, 3 bits cada num u16
+    const int MAX_ENTITIES = 1 + GameSnapshot::MAX_GHOSTS;
+
+    // Campos escalares do snapshot comparados nos deltas. seed, ghostCount e
+    // tickCount ficam de fora: mudam s com keyframe ou so implcitos.
+    struct SnapshotField {
+        uint16_t offset;
+        uint8_t size;
+        bool isSigned;
+    };
+
+#define SNAPSHOT_FIELD(member) { \
+        static_cast<uint16_t>(offsetof(GameSnapshot, member)), \
+        static_cast<uint8_t>(sizeof(static_cast<GameSnapshot*>(nullptr)->member)), \
+        std::is_signed<decltype(static_cast<GameSnapshot*>(nullptr)->member)>::value }
+
+#define GHOST_FIELDS(i) \
+        SNAPSHOT_FIELD(ghosts[i].x), SNAPSHOT_FIELD(ghosts[i].y), \
+        SNAPSHOT_FIELD(ghosts[i].stateTimer), SNAPSHOT_FIELD(ghosts[i].state), \
+        SNAPSHOT_FIELD(ghosts[i].active), SNAPSHOT_FIELD(ghosts[i].speed)
+
+    // Acrescentados no fim para os ndices dos campos antigos no mudarem
+#define GHOST_CONTROL_FIELDS(i) \
+        SNAPSHOT_FIELD(ghosts[i].directionX), SNAPSHOT_FIELD(ghosts[i].directionY), \
+        SNAPSHOT_FIELD(ghosts[i].controlled)
+
+    const SnapshotField SNAPSHOT_FIELDS[] = {
+        SNAPSHOT_FIELD(score), SNAPSHOT_FIELD(lives), SNAPSHOT_FIELD(level),
+        SNAPSHOT_FIELD(transitionTimer), SNAPSHOT_FIELD(state), SNAPSHOT_FIELD(isGameOver),
+        SNAPSHOT_FIELD(remainingPellets),
+        SNAPSHOT_FIELD(pacman.x), SNAPSHOT_FIELD(pacman.y),
+        SNAPSHOT_FIELD(pacman.powerTimer),
+        SNAPSHOT_FIELD(pacman.directionX), SNAPSHOT_FIELD(pacman.directionY),
+        SNAPSHOT_FIELD(pacman.powered), SNAPSHOT_FIELD(pacman.speed),
+        GHOST_FIELDS(0), GHOST_FIELDS(1), GHOST_FIELDS(2), GHOST_FIELDS(3),
+        GHOST_CONTROL_FIELDS(0), GHOST_CONTROL_FIELDS(1),
+        GHOST_CONTROL_FIELDS(2), GHOST_CONTROL_FIELDS(3),
+        SNAPSHOT_FIELD(pacman.pendingDirectionX), SNAPSHOT_FIELD(pacman.pendingDirectionY),
+        SNAPSHOT_FIELD(pacman.pendingTicks), SNAPSHOT_FIELD(pacman.turnBufferTicks)
+    };
+    const int FIELD_COUNT = sizeof(SNAPSHOT_FIELDS) / sizeof(SNAPSHOT_FIELDS[0]);
+
+#undef GHOST_CONTROL_FIELDS
+#undef GHOST_FIELDS
+#undef SNAPSHOT_FIELD
+
+    int64_t readField(const GameSnapshot& snapshot, const SnapshotField& field) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&snapshot) + field.offset;
+        switch (field.size) {
+        case 1: {
+            uint8_t v; std::memcpy(&v, p, 1);
+            return field.isSigned ? static_cast<int8_t>(v) : v;
+        }
+        case 2: {
+            uint16_t v; std::memcpy(&v, p, 2);
+            return field.isSigned ? static_cast<int16_t>(v) : v;
+        }
+        case 4: {
+            uint32_t v; std::memcpy(&v, p, 4);
+            return field.isSigned ? static_cast<int32_t>(v) : static_cast<int64_t>(v);
+        }
+        default: {
+            uint64_t v; std::memcpy(&v, p, 8);
+            return static_cast<int64_t>(v);
+        }
+        }
+    }
+
+    void writeField(GameSnapshot& snapshot, const SnapshotField& field, int64_t value) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(&snapshot) + field.offset;
+        uint64_t v = static_cast<uint64_t>(value);
+        switch (field.size) {
+        case 1: { uint8_t b = static_cast<uint8_t>(v); std::memcpy(p, &b, 1); break; }
+        case 2: { uint16_t b = static_cast<uint16_t>(v); std::memcpy(p, &b, 2); break; }
+        case 4: { uint32_t b = static_cast<uint32_t>(v); std::memcpy(p, &b, 4); break; }
+        default: std::memcpy(p, &v, 8); break;
+        }
+    }
+
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Posio da entidade e (0 = Pac-Man, 1.. = fantasmas)
+    int16_t* entityX(GameSnapshot& s, int e) { return e == 0 ? &s.pacman.x : &s.ghosts[e - 1].x; }
+    int16_t* entityY(GameSnapshot& s, int e) { return e == 0 ? &s.pacman.y : &s.ghosts[e - 1].y; }
+    int16_t getEntityX(const GameSnapshot& s, int e) { return e == 0 ? s.pacman.x : s.ghosts[e - 1].x; }
+    int16_t getEntityY(const GameSnapshot& s, int e) { return e == 0 ? s.pacman.y : s.ghosts[e - 1].y; }
+
+    // Movimentos de uma casa: 0 = nenhum/outro, 1..4 = cima, baixo, esquerda, direita
+    const int MOVE_DX[5] = { 0, 0, 0, -1, 1 };
+    const int MOVE_DY[5] = { 0, -1, 1, 0, 0 };
+
+    int moveCode(int dx, int dy) {
+        for (int code = 1; code < 5; code++) {
+            if (MOVE_DX[code] == dx && MOVE_DY[code] == dy) return code;
+        }
+        return 0;
+    }
+
+    int countBits(uint8_t value) {
+        int count = 0;
+        for (; value; value &= value - 1) count++;
+        return count;
+    }
+
+    bool hasDirtyList(const SnapshotDirtyCells& dirty) {
+        return dirty.cells != nullptr && dirty.count >= 0;
+    }
+
+    // Bits (0 = pellet, 1 = power pellet) da casa que diferem entre a e b
+    int cellChanges(const GameSnapshot& a, const GameSnapshot& b, int cell) {
+        const int i = cell >> 3;
+        const uint8_t bit = static_cast<uint8_t>(1u << (cell & 7));
+        return (((a.pelletPlane[i] ^ b.pelletPlane[i]) & bit) ? 1 : 0) |
+            (((a.powerPelletPlane[i] ^ b.powerPelletPlane[i]) & bit) ? 2 : 0);
+    }
+
+    int countPelletChanges(const GameSnapshot& a, const GameSnapshot& b,
+        const SnapshotDirtyCells& dirty) {
+        int changes = 0;
+        if (hasDirtyList(dirty)) {
+            for (int i = 0; i < dirty.count; i++) {
+                changes += countBits(static_cast<uint8_t>(cellChanges(a, b, dirty.cells[i])));
+            }
+            return changes;
+        }
+        for (int i = 0; i < GameSnapshot::PLANE_BYTES; i++) {
+            changes += countBits(a.pelletPlane[i] ^ b.pelletPlane[i]);
+            changes += countBits(a.powerPelletPlane[i] ^ b.powerPelletPlane[i]);
+        }
+        return changes;
+    }
+
+    size_t putVarint(uint8_t* out, uint64_t value) {
+        size_t n = 0;
+        while (value >= 0x80) {
+            out[n++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        out[n++] = static_cast<uint8_t>(value);
+        return n;
+    }
+
+    uint64_t readVarint(const uint8_t* data, size_t size, size_t& pos) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= size) {
+                throw std::runtime_error("Delta truncado");
+            }
+            uint8_t byte = data[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Varint invalido no delta");
+    }
+}
+
+bool needsSnapshotKeyframe(const GameSnapshot& previous, const GameSnapshot& current,
+    const SnapshotDirtyCells& dirty) {
+    return current.tickCount != previous.tickCount + 1 ||   // Novo jogo ou restore
+        current.seed != previous.seed ||
+        current.rngDraws < previous.rngDraws ||
+        current.ghostCount != previous.ghostCount ||
+        countPelletChanges(previous, current, dirty) > MAX_PELLET_CHANGES;
+}
+
+size_t encodeSnapshotDelta(const GameSnapshot& previous, const GameSnapshot& current, uint8_t* out,
+    const SnapshotDirtyCells& dirty) {
+    // scratch comea no estado anterior e recebe cada seco j escrita;
+    // no fim s os campos que ainda diferem vo na seco de campos
+    GameSnapshot scratch;
+    std::memcpy(&scratch, &previous, sizeof(scratch));
+
+    size_t used = 0;
+    uint8_t flags = 0;
+    out[used++] = 0;
+
+    // Movimentos de uma casa: 3 bits por entidade
+    const int entities = 1 + current.ghostCount;
+    uint16_t moves = 0;
+    for (int e = 0; e < entities && e < MAX_ENTITIES; e++) {
+        int dx = getEntityX(current, e) - getEntityX(scratch, e);
+        int dy = getEntityY(current, e) - getEntityY(scratch, e);
+        int code = moveCode(dx, dy);
+        if (code) {
+            *entityX(scratch, e) = getEntityX(current, e);
+            *entityY(scratch, e) = getEntityY(current, e);
+            moves |= static_cast<uint16_t>(code << (3 * e));
+        }
+    }
+    if (moves) {
+        flags |= DELTA_MOVES;
+        out[used++] = static_cast<uint8_t>(moves);
+        out[used++] = static_cast<uint8_t>(moves >> 8);
+    }
+
+    // Pellets: posies (casa * 2 + plano) que mudaram, em gaps crescentes
+    int pelletChanges = countPelletChanges(previous, current, dirty);
+    if (pelletChanges > 0 && hasDirtyList(dirty)) {
+        flags |= DELTA_PELLETS;
+        used += putVarint(out + used, static_cast<uint64_t>(pelletChanges));
+        uint32_t lastCode = 0;
+        for (int i = 0; i < dirty.count; i++) {
+            const int changes = cellChanges(previous, current, dirty.cells[i]);
+            for (int plane = 0; plane < 2; plane++) {
+                if (changes & (1 << plane)) {
+                    uint32_t code = static_cast<uint32_t>(dirty.cells[i]) * 2 + plane;
+                    used += putVarint(out + used, code - lastCode);
+                    lastCode = code;
+                }
+            }
+        }
+    }
+    else if (pelletChanges > 0) {
+        flags |= DELTA_PELLETS;
+        used += putVarint(out + used, static_cast<uint64_t>(pelletChanges));
+        uint32_t lastCode = 0;
+        for (int i = 0; i < GameSnapshot::PLANE_BYTES; i++) {
+            uint8_t pelletDiff = previous.pelletPlane[i] ^ current.pelletPlane[i];
+            uint8_t powerDiff = previous.powerPelletPlane[i] ^ current.powerPelletPlane[i];
+            if (!(pelletDiff | powerDiff)) continue;
+            for (int bit = 0; bit < 8; bit++) {
+                uint32_t cell = static_cast<uint32_t>(i * 8 + bit);
+                for (int plane = 0; plane < 2; plane++) {
+                    uint8_t diff = plane == 0 ? pelletDiff : powerDiff;
+                    if (diff & (1u << bit)) {
+                        uint32_t code = cell * 2 + plane;
+                        used += putVarint(out + used, code - lastCode);
+                        lastCode = code;
+                    }
+                }
+            }
+        }
+    }
+
+    // Restantes campos: (gap no ndice do campo, diferena em zigzag)
+    const size_t countPos = used;
+    uint8_t fieldCount = 0;
+    out[used++] = 0;
+    int lastField = -1;
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        int64_t before = readField(scratch, SNAPSHOT_FIELDS[i]);
+        int64_t after = readField(current, SNAPSHOT_FIELDS[i]);
+        if (before != after) {
+            used += putVarint(out + used, static_cast<uint64_t>(i - lastField - 1));
+            used += putVarint(out + used, zigzag(static_cast<int64_t>(
+                static_cast<uint64_t>(after) - static_cast<uint64_t>(before))));
+            lastField = i;
+            fieldCount++;
+        }
+    }
+    if (fieldCount) {
+        flags |= DELTA_FIELDS;
+        out[countPos] = fieldCount;   // FIELD_COUNT < 128: cabe num byte
+    }
+    else {
+        used = countPos;
+    }
+
+    // Gerador: basta o nmero de valores gerados, o leitor avana o seu
+    if (current.rngDraws != previous.rngDraws) {
+        flags |= DELTA_RNG;
+        used += putVarint(out + used, current.rngDraws - previous.rngDraws);
+    }
+
+    out[0] = flags;
+    return used;
+}
+
+size_t applySnapshotDelta(const uint8_t* data, size_t size, GameSnapshot& state) {
+    size_t pos = 0;
+    if (size == 0) {
+        throw std::runtime_error("Delta truncado");
+    }
+    const uint8_t flags = data[pos++];
+    if (flags & ~(DELTA_MOVES | DELTA_PELLETS | DELTA_FIELDS | DELTA_RNG)) {
+        throw std::runtime_error("Delta invalido");
+    }
+
+    state.tickCount++;
+
+    if (flags & DELTA_MOVES) {
+        if (pos + 2 > size) {
+            throw std::runtime_error("Delta truncado");
+        }
+        uint16_t moves = static_cast<uint16_t>(data[pos] | (data[pos + 1] << 8));
+        pos += 2;
+        for (int e = 0; e < MAX_ENTITIES; e++) {
+            int code = (moves >> (3 * e)) & 7;
+            if (code >= 1 && code <= 4) {
+                *entityX(state, e) = static_cast<int16_t>(*entityX(state, e) + MOVE_DX[code]);
+                *entityY(state, e) = static_cast<int16_t>(*entityY(state, e) + MOVE_DY[code]);
+            }
+        }
+    }
+
+    if (flags & DELTA_PELLETS) {
+        uint64_t count = readVarint(data, size, pos);
+        uint64_t code = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            code += readVarint(data, size, pos);
+            uint64_t cell = code / 2;
+            if (cell >= static_cast<uint64_t>(GameSnapshot::MAX_CELLS)) {
+                throw std::runtime_error("Casa invalida no delta");
+            }
+            uint8_t* plane = (code & 1) ? state.powerPelletPlane : state.pelletPlane;
+            plane[cell >> 3] ^= static_cast<uint8_t>(1u << (cell & 7));
+        }
+    }
+
+    if (flags & DELTA_FIELDS) {
+        uint64_t count = readVarint(data, size, pos);
+        int field = -1;
+        for (uint64_t i = 0; i < count; i++) {
+            field += static_cast<int>(readVarint(data, size, pos)) + 1;
+            if (field >= FIELD_COUNT) {
+                throw std::runtime_error("Campo invalido no delta");
+            }
+            int64_t delta = unzigzag(readVarint(data, size, pos));
+            const SnapshotField& f = SNAPSHOT_FIELDS[field];
+            writeField(state, f, static_cast<int64_t>(
+                static_cast<uint64_t>(readField(state, f)) + static_cast<uint64_t>(delta)));
+        }
+    }
+
+    if (flags & DELTA_RNG) {
+        uint64_t draws = readVarint(data, size, pos);
+        GameRandom rng;
+        rng.restore(state.seed, state.rngState, state.rngDraws);
+        for (uint64_t i = 0; i < draws; i++) {
+            rng.next();
+        }
+        state.rngState = rng.getState();
+        state.rngDraws = rng.getDraws();
+    }
+
+    return pos;
+}
@@ -0,0 +1,60 @@
+#include "state_hash.h"
+
+namespace {
+    // splitmix64: gera as chaves a partir de uma seed fixa
+    uint64_t nextKey(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    const uint64_t ZOBRIST_SEED = 0x5041434D414E3031ULL; // "PACMAN01"
+}
+
+StateHash::Table::Table() {
+    uint64_t state = ZOBRIST_SEED;
+    for (int cell = 0; cell < MAX_CELLS; cell++) {
+        for (int type = 0; type < TILE_TYPES; type++) {
+            tiles[cell][type] = nextKey(state);
+        }
+    }
+    for (int entity = 0; entity < ENTITIES; entity++) {
+        for (int cell = 0; cell < MAX_CELLS; cell++) {
+            positions[entity][cell] = nextKey(state);
+        }
+        for (int s = 0; s < ENTITY_STATES; s++) {
+            states[entity][s] = nextKey(state);
+        }
+    }
+}
+
+const StateHash::Table& StateHash::table() {
+    // Construda uma vez, no primeiro uso (thread-safe desde C++11)
+    static const Table instance;
+    return instance;
+}
+
+int StateHash::cellIndex(int x, int y) {
+    // Fora do tabuleiro no deve acontecer; o mdulo s evita ler fora da tabela
+    unsigned cell = static_cast<unsigned>(y) * BOARD_WIDTH + static_cast<unsigned>(x);
+    return static_cast<int>(cell % MAX_CELLS);
+}
+
+uint64_t StateHash::tile(int x, int y, int squareType) {
+    return table().tiles[cellIndex(x, y)][static_cast<unsigned>(squareType) % TILE_TYPES];
+}
+
+uint64_t StateHash::position(int entity, int x, int y) {
+    return table().positions[static_cast<unsigned>(entity) % ENTITIES][cellIndex(x, y)];
+}
+
+uint64_t StateHash::entityState(int entity, int state) {
+    return table().states[static_cast<unsigned>(entity) % ENTITIES]
+        [static_cast<unsigned>(state) % ENTITY_STATES];
+}
+
+uint64_t StateHash::mix(uint64_t value) {
+    uint64_t state = value;
+    return nextKey(state);
+}
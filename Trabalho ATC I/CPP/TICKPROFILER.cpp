@@ -0,0 +1,84 @@
+#include "tick_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+TickProfiler::TickProfiler() : current(0), committed(0), currentHasTick(false),
+    cyclesPerUs(1000.0), tickPeriodUs(100000.0) {
+    std::memset(rows, 0, sizeof(rows));
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Frequncia do TSC contra o relgio do sistema (invariante nos
+    // processadores atuais: no muda com a frequncia do ncleo)
+    const auto wallStart = std::chrono::steady_clock::now();
+    const uint64_t cycleStart = readCycles();
+    while (std::chrono::steady_clock::now() - wallStart < std::chrono::milliseconds(5)) {
+    }
+    const double elapsedUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - wallStart).count();
+    const uint64_t cycles = readCycles() - cycleStart;
+    if (elapsedUs > 0 && cycles > 0) {
+        cyclesPerUs = cycles / elapsedUs;
+    }
+#endif
+}
+
+void TickProfiler::reset() {
+    std::memset(rows, 0, sizeof(rows));
+    current = 0;
+    committed = 0;
+    currentHasTick = false;
+}
+
+void TickProfiler::commitTick() {
+    current = (current + 1) % HISTORY;
+    std::memset(rows[current], 0, sizeof(rows[current]));
+    if (committed < HISTORY) committed++;
+    currentHasTick = false;
+}
+
+static double percentileOf(uint64_t* values, int count, double fraction) {
+    if (count <= 0) return 0;
+    const int index = std::min(count - 1, static_cast<int>(fraction * (count - 1) + 0.5));
+    std::nth_element(values, values + index, values + count);
+    return static_cast<double>(values[index]);
+}
+
+ProfileSummary TickProfiler::summarize() const {
+    ProfileSummary summary = ProfileSummary();
+    // Linhas completas: as committed anteriores  linha em curso
+    const int count = std::min(committed, HISTORY - 1);
+    summary.ticks = count;
+    if (count == 0) return summary;
+
+    uint64_t values[HISTORY];
+    uint64_t totals[HISTORY];
+    for (int i = 0; i < count; i++) totals[i] = 0;
+
+    for (int phase = 0; phase < PHASES; phase++) {
+        for (int i = 0; i < count; i++) {
+            const uint64_t cycles = rows[(current - 1 - i + HISTORY) % HISTORY][phase];
+            values[i] = cycles;
+            totals[i] += cycles;
+        }
+        summary.phases[phase].p50Us = percentileOf(values, count, 0.50) / cyclesPerUs;
+        summary.phases[phase].p99Us = percentileOf(values, count, 0.99) / cyclesPerUs;
+    }
+    summary.total.p50Us = percentileOf(totals, count, 0.50) / cyclesPerUs;
+    summary.total.p99Us = percentileOf(totals, count, 0.99) / cyclesPerUs;
+    summary.budgetUsed = tickPeriodUs > 0 ? summary.total.p99Us / tickPeriodUs : 0;
+    return summary;
+}
+
+const char* TickProfiler::phaseName(TickPhase phase) {
+    switch (phase) {
+    case TickPhase::INPUT: return "entrada";
+    case TickPhase::PACMAN: return "pacman";
+    case TickPhase::GHOSTS: return "fantasmas";
+    case TickPhase::COLLISIONS: return "colises";
+    case TickPhase::VICTORY: return "vitria";
+    case TickPhase::RENDER: return "render";
+    case TickPhase::COUNT: break;
+    }
+    return "?";
+}
@@ -0,0 +1,143 @@
+#include "timer_wheel.h"
+#include <stdexcept>
+#include <string>
+
+TimerWheel::TimerWheel() : now(0), pendingCount(0), freeCount(0) {
+    for (int i = 0; i < CAPACITY; i++) {
+        nodes[i].generation = 0;
+        nodes[i].bucket = NONE;
+    }
+    clear();
+}
+
+TimerHandle TimerWheel::schedule(uint32_t delay, TimerAction action, int target) {
+    if (delay == 0 || delay > MAX_DELAY) {
+        throw std::runtime_error("Timer com prazo fora da roda: " + std::to_string(delay) + " ticks");
+    }
+    if (freeCount == 0) {
+        throw std::runtime_error("Roda de timers cheia");
+    }
+
+    const uint16_t index = freeNodes[--freeCount];
+    Node& node = nodes[index];
+    node.deadline = now + delay;
+    node.event.action = action;
+    node.event.target = target;
+    insert(index);
+    pendingCount++;
+    return TimerHandle(index, node.generation);
+}
+
+bool TimerWheel::cancel(TimerHandle& handle) {
+    const int index = indexOf(handle);
+    handle = TimerHandle();
+    if (index < 0) return false;
+    unlink(static_cast<uint16_t>(index));
+    release(static_cast<uint16_t>(index));
+    return true;
+}
+
+void TimerWheel::clear() {
+    for (int i = 0; i < CAPACITY; i++) {
+        if (nodes[i].bucket != NONE) nodes[i].generation++;
+        nodes[i].bucket = NONE;
+    }
+    for (int i = 0; i < LEVELS * SLOTS; i++) {
+        buckets[i] = NONE;
+    }
+    // O n 0 sai primeiro
+    freeCount = CAPACITY;
+    for (int i = 0; i < CAPACITY; i++) {
+        freeNodes[i] = static_cast<uint16_t>(CAPACITY - 1 - i);
+    }
+    pendingCount = 0;
+}
+
+bool TimerWheel::isPending(TimerHandle handle) const {
+    return indexOf(handle) >= 0;
+}
+
+uint32_t TimerWheel::getRemaining(TimerHandle handle) const {
+    const int index = indexOf(handle);
+    return index < 0 ? 0 : nodes[index].deadline - now;
+}
+
+int TimerWheel::advance(TimerEvent* expired) {
+    now++;
+
+    // Ao dar a volta a um nvel, a casa atual do nvel acima desce
+    // (de cima para baixo: o nvel 2 pode encher a casa do nvel 1)
+    if ((now & (SLOTS - 1)) == 0) {
+        if (((now >> SLOT_BITS) & (SLOTS - 1)) == 0) {
+            cascade(2);
+        }
+        cascade(1);
+    }
+
+    int count = 0;
+    uint16_t index = buckets[now & (SLOTS - 1)];
+    buckets[now & (SLOTS - 1)] = NONE;
+    while (index != NONE) {
+        const uint16_t next = nodes[index].next;
+        // Insero ordenada: so poucos e a ordem fica determinstica
+        const TimerEvent event = nodes[index].event;
+        int at = count++;
+        while (at > 0 && (expired[at - 1].action > event.action ||
+            (expired[at - 1].action == event.action && expired[at - 1].target > event.target))) {
+            expired[at] = expired[at - 1];
+            at--;
+        }
+        expired[at] = event;
+        release(index);
+        index = next;
+    }
+    return count;
+}
+
+void TimerWheel::insert(uint16_t index) {
+    Node& node = nodes[index];
+    const uint32_t delay = node.deadline - now;
+    int level = 0;
+    while (level < LEVELS - 1 && delay >= (1u << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    const uint16_t bucket = static_cast<uint16_t>(
+        level * SLOTS + ((node.deadline >> (SLOT_BITS * level)) & (SLOTS - 1)));
+
+    node.bucket = bucket;
+    node.prev = NONE;
+    node.next = buckets[bucket];
+    if (node.next != NONE) nodes[node.next].prev = index;
+    buckets[bucket] = index;
+}
+
+void TimerWheel::unlink(uint16_t index) {
+    Node& node = nodes[index];
+    if (node.prev != NONE) nodes[node.prev].next = node.next;
+    else buckets[node.bucket] = node.next;
+    if (node.next != NONE) nodes[node.next].prev = node.prev;
+}
+
+void TimerWheel::release(uint16_t index) {
+    nodes[index].bucket = NONE;
+    nodes[index].generation++;
+    freeNodes[freeCount++] = index;
+    pendingCount--;
+}
+
+void TimerWheel::cascade(int level) {
+    const int bucket = level * SLOTS + ((now >> (SLOT_BITS * level)) & (SLOTS - 1));
+    uint16_t index = buckets[bucket];
+    buckets[bucket] = NONE;
+    while (index != NONE) {
+        const uint16_t next = nodes[index].next;
+        insert(index);   // Prazo a menos de 64^level ticks: desce pelo menos um nvel
+        index = next;
+    }
+}
+
+int TimerWheel::indexOf(TimerHandle handle) const {
+    if (handle.slot >= CAPACITY) return -1;
+    const Node& node = nodes[handle.slot];
+    return node.bucket == NONE || node.generation != handle.generation ? -1 : handle.slot;
+}
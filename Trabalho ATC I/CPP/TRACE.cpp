@@ -0,0 +1,200 @@
+#include "trace.h"
+#include <signal.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+std::atomic<bool> Tracer::enabled(false);
+std::atomic<bool> Tracer::flushRequested(false);
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    enum class TraceEventType : uint8_t {
+        COMPLETE,   // "X": incio + durao
+        COUNTER     // "C": valor num instante
+    };
+
+    struct TraceEvent {
+        const char* name;
+        uint64_t timestampNs;
+        int64_t value;          // Durao (ns) ou valor do contador
+        TraceEventType type;
+    };
+
+    // Anel de uma thread: ela escreve, quem despeja (sob fileMutex) l
+    struct TraceBuffer {
+        static const size_t CAPACITY = 1 << 16;   // Potncia de 2
+
+        TraceEvent events[CAPACITY];
+        alignas(64) std::atomic<size_t> head;    // Prximo a despejar
+        alignas(64) std::atomic<size_t> tail;    // Prximo a escrever
+        std::atomic<long long> dropped;
+        int threadId;
+        char threadName[32];                     // Protegido por registryMutex
+        bool nameWritten;                        // Protegido por fileMutex
+
+        explicit TraceBuffer(int id) : head(0), tail(0), dropped(0), threadId(id), nameWritten(false) {
+            std::snprintf(threadName, sizeof(threadName), "thread %d", id);
+        }
+
+        void push(const TraceEvent& event) {
+            const size_t position = tail.load(std::memory_order_relaxed);
+            const size_t used = position - head.load(std::memory_order_acquire);
+            if (used == CAPACITY) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            events[position & (CAPACITY - 1)] = event;
+            tail.store(position + 1, std::memory_order_release);
+            if (used + 1 == CAPACITY * 3 / 4) {
+                Tracer::requestFlush();   // O prximo service() esvazia-o
+            }
+        }
+    };
+
+    std::mutex registryMutex;                          // S ao criar anis e dar nomes
+    std::vector<std::unique_ptr<TraceBuffer>> buffers; // Vivem at ao fim do processo
+    std::mutex fileMutex;                              // Um despejo de cada vez
+    std::FILE* traceFile = nullptr;
+    Clock::time_point origin;
+
+    thread_local TraceBuffer* threadBuffer = nullptr;
+
+    TraceBuffer& currentBuffer() {
+        if (!threadBuffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(static_cast<int>(buffers.size()) + 1)));
+            threadBuffer = buffers.back().get();
+        }
+        return *threadBuffer;
+    }
+
+    void onFlushSignal(int) {
+        Tracer::requestFlush();
+    }
+
+    // Escreve os eventos pendentes de todos os anis; chamado com fileMutex
+    void drainBuffers() {
+        std::vector<TraceBuffer*> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const auto& buffer : buffers) {
+                snapshot.push_back(buffer.get());
+                if (!buffer->nameWritten && traceFile) {
+                    std::fprintf(traceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                        "\"args\":{\"name\":\"%s\"}},\n", buffer->threadId, buffer->threadName);
+                    buffer->nameWritten = true;
+                }
+            }
+        }
+
+        for (TraceBuffer* buffer : snapshot) {
+            size_t position = buffer->head.load(std::memory_order_relaxed);
+            const size_t end = buffer->tail.load(std::memory_order_acquire);
+            for (; position != end; position++) {
+                const TraceEvent& event = buffer->events[position & (TraceBuffer::CAPACITY - 1)];
+                if (!traceFile) continue;
+                if (event.type == TraceEventType::COMPLETE) {
+                    std::fprintf(traceFile, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                        "\"pid\":1,\"tid\":%d},\n", event.name, event.timestampNs / 1000.0,
+                        event.value / 1000.0, buffer->threadId);
+                }
+                else {
+                    std::fprintf(traceFile, "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,"
+                        "\"tid\":%d,\"args\":{\"value\":%lld}},\n", event.name, event.timestampNs / 1000.0,
+                        buffer->threadId, static_cast<long long>(event.value));
+                }
+            }
+            buffer->head.store(end, std::memory_order_release);
+        }
+        if (traceFile) std::fflush(traceFile);
+    }
+}
+
+void Tracer::start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (traceFile) {
+        throw std::runtime_error("O trao j est ativo");
+    }
+    traceFile = std::fopen(path.c_str(), "wb");
+    if (!traceFile) {
+        throw std::runtime_error("No foi possvel criar " + path);
+    }
+    // Array sem fecho tambm  aceite pelos visualizadores: um despejo a
+    // meio (SIGUSR1) j d um ficheiro que se abre
+    std::fputs("[\n", traceFile);
+    origin = Clock::now();
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onFlushSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+
+    enabled.store(true, std::memory_order_release);
+    setThreadName("main");
+}
+
+void Tracer::stop() {
+    enabled.store(false, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (!traceFile) return;
+    drainBuffers();
+    std::fprintf(traceFile, "{\"name\":\"dropped_events\",\"ph\":\"M\",\"pid\":1,\"args\":{\"count\":%lld}}\n]\n",
+        getDroppedEvents());
+    std::fclose(traceFile);
+    traceFile = nullptr;
+    signal(SIGUSR1, SIG_DFL);
+}
+
+void Tracer::flush() {
+    flushRequested.store(false, std::memory_order_relaxed);
+    TRACE_SCOPE("trace flush");
+    std::lock_guard<std::mutex> lock(fileMutex);
+    drainBuffers();
+}
+
+void Tracer::setThreadName(const char* name) {
+    TraceBuffer& buffer = currentBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::snprintf(buffer.threadName, sizeof(buffer.threadName), "%s", name);
+}
+
+uint64_t Tracer::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - origin).count());
+}
+
+void Tracer::complete(const char* name, uint64_t startNs, uint64_t endNs) {
+    TraceEvent event;
+    event.name = name;
+    event.timestampNs = startNs;
+    event.value = static_cast<int64_t>(endNs - startNs);
+    event.type = TraceEventType::COMPLETE;
+    currentBuffer().push(event);
+}
+
+void Tracer::counter(const char* name, int64_t value) {
+    TraceEvent event;
+    event.name = name;
+    event.timestampNs = now();
+    event.value = value;
+    event.type = TraceEventType::COUNTER;
+    currentBuffer().push(event);
+}
+
+long long Tracer::getDroppedEvents() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    long long dropped = 0;
+    for (const auto& buffer : buffers) {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
@@ -0,0 +1,38 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <cstdint>
+
+// Contagem de alocaes no heap, para garantir que um tick em PLAYING (e o
+// desenho desse frame) no aloca nada.
+//
+// S existe quando se compila com -DPACMAN_ALLOC_CHECK: nesse caso
+// ALLOCATIONTRACKER.cpp substitui o operator new/delete globais e conta, por
+// thread, cada new. O GameLoop lana uma exceo se um tick que comea e
+// acaba em PLAYING alocar, e o pacman_bench falha os benchmarks que alocam.
+// Sem o flag no h substituio e a contagem  sempre 0.
+//
+// No v malloc() chamado diretamente (ex.: dentro da libc ou do curses).
+
+class AllocationTracker {
+public:
+#ifdef PACMAN_ALLOC_CHECK
+    static bool isEnabled() { return true; }
+    static uint64_t getThreadAllocations();   // new feitos nesta thread desde o arranque
+#else
+    static bool isEnabled() { return false; }
+    static uint64_t getThreadAllocations() { return 0; }
+#endif
+};
+
+// Alocaes feitas nesta thread desde a construo
+class AllocationScope {
+public:
+    AllocationScope() : start(AllocationTracker::getThreadAllocations()) {}
+    uint64_t getAllocations() const { return AllocationTracker::getThreadAllocations() - start; }
+
+private:
+    uint64_t start;
+};
+
+#endif
@@ -2,10 +2,13 @@
 #define BOARD_H
 
 #include <vector>
+#include <cstdint>
 #include <random>
 #include <chrono>
 #include <curses.h>
 
+class FrameRenderer;
+
 class Board {
 public:
     enum class SquareType {
@@ -21,13 +24,12 @@ public:
         SquareType type;
         int points;
         bool powerActive;
-        int powerDuration;
         bool isTunnel;
         int tunnelDestX;
         int tunnelDestY;
 
         Square() : type(SquareType::EMPTY), points(0), powerActive(false),
-            powerDuration(0), isTunnel(false), tunnelDestX(-1), tunnelDestY(-1) {}
+            isTunnel(false), tunnelDestX(-1), tunnelDestY(-1) {}
     };
 
     // Construtor e Destrutor
@@ -41,6 +43,8 @@ public:
     Square& getSquare(int x, int y);
     int getWidth() const { return width; }
     int getHeight() const { return height; }
+    int getMazeId() const { return mazeId; } // Identifica o layout (para replays)
+    uint64_t getHash() const { return hash; }  // Hash Zobrist das casas, incremental
 
     // Mtodos de estado do jogo
     void initializeBoard();
@@ -52,6 +56,18 @@ public:
     bool isTunnel(int x, int y) const;
     bool isCompleted() const;
 
+    // Movimentos legais: por casa, as direes cujo vizinho est dentro do
+    // tabuleiro e no  parede. Mantido ao mudar paredes, consultado em O(1).
+    static const uint8_t EXIT_UP = 1;
+    static const uint8_t EXIT_DOWN = 2;
+    static const uint8_t EXIT_LEFT = 4;
+    static const uint8_t EXIT_RIGHT = 8;
+    static uint8_t exitFor(int dx, int dy);   // 0 se no for uma das quatro direes
+    uint8_t getExits(int x, int y) const { return exits[y * width + x]; }
+    bool canMove(int x, int y, int dx, int dy) const {
+        return isPositionInBounds(x, y) && (getExits(x, y) & exitFor(dx, dy)) != 0;
+    }
+
     // Mtodos de tnel
     void setTunnel(int x1, int y1, int x2, int y2);
     void getTunnelDestination(int x, int y, int& destX, int& destY) const;
@@ -62,6 +78,24 @@ public:
     void setGhostSpawn(int ghostIndex, int x, int y);
     void getSpawnPoint(int& x, int& y, bool isGhost = false, int ghostIndex = 0) const;
 
+    // Snapshots: um bit por casa (y * largura + x) para pellets e power pellets
+    void savePellets(uint8_t* pelletPlane, uint8_t* powerPlane, int planeBytes) const;
+    void restorePellets(const uint8_t* pelletPlane, const uint8_t* powerPlane, int planeBytes);
+    // Como savePellets, mas s reescreve as casas alteradas (planos do snapshot anterior)
+    void updatePellets(uint8_t* pelletPlane, uint8_t* powerPlane, int planeBytes) const;
+
+    // Casas cujo tipo mudou desde o ltimo clearDirtyCells(), por ordem de ndice
+    // (y * largura + x). Quem s quer o que mudou (deltas, desenho) no percorre
+    // o tabuleiro todo. -1 = mudou demasiado (reset, restore): tratar tudo.
+    static const int MAX_DIRTY_CELLS = 64;
+    int getDirtyCount() const { return dirtyCount; }
+    const uint16_t* getDirtyCells() const { return dirtyCells; }
+    void clearDirtyCells() { dirtyCount = 0; }
+
+    // Desenho no frame: o tabuleiro todo ou uma casa (ex.: as alteradas)
+    void draw(FrameRenderer& screen) const;
+    void drawCell(FrameRenderer& screen, int x, int y) const;
+
     // Mtodos de contagem
     int getRemainingPellets() const { return remainingPellets; }
     int getTotalPellets() const { return totalPellets; }
@@ -72,10 +106,15 @@ public:
 private:
     int width;
     int height;
+    int mazeId;
+    uint64_t hash;
     std::vector<std::vector<Square>> squares;
     int totalPellets;
     int remainingPellets;
     bool fruitActive;
+    uint16_t dirtyCells[MAX_DIRTY_CELLS];   // Ordenadas e sem repeties
+    int dirtyCount;
+    std::vector<uint8_t> exits;             // EXIT_* por casa (y * largura + x)
 
     struct SpawnPoint {
         int x, y;
@@ -88,6 +127,12 @@ private:
 
     // Mtodos privados
     void validatePosition(int x, int y) const;
+    void changeType(int x, int y, SquareType type); // Muda o tipo e atualiza o hash
+    void rehash();                                  // Recalcula o hash do zero
+    void markDirty(int x, int y);
+    uint8_t computeExits(int x, int y) const;
+    void updateExits(int x, int y);                 // A casa e os quatro vizinhos
+    void rebuildExits();
     void updatePelletCount();
     bool isPositionInBounds(int x, int y) const;
     void clearBoard();
@@ -19,7 +19,6 @@ public:
         SquareType type;  // Que tipo de quadrado  (parede, vazio, etc)
         int points;       // Quantos pontos vale (se for uma pastilha)
         bool powerActive; // Se a pastilha de poder est ativa
-        int powerDuration;// Quanto tempo dura o poder
 
         Square();  // Construtor no cpp inicializa os valores quando cria um novo quadrado
     };
@@ -0,0 +1,146 @@
+#ifndef ENTITY_POOL_H
+#define ENTITY_POOL_H
+
+#include "level_arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Referncia a uma entidade de um EntityPool: slot + gerao. Quando a
+// entidade  destruda (ou o pool recomea noutro nvel) a gerao do slot
+// muda e o handle antigo deixa de resolver, em vez de apontar para a
+// entidade que reutilizou o slot. Copiar um handle no mexe em contadores.
+template <typename T>
+struct PoolHandle {
+    static const uint16_t INVALID_SLOT = 0xFFFF;
+
+    uint16_t slot;
+    uint16_t generation;
+
+    PoolHandle() : slot(INVALID_SLOT), generation(0) {}
+    PoolHandle(uint16_t slot, uint16_t generation) : slot(slot), generation(generation) {}
+
+    bool isValid() const { return slot != INVALID_SLOT; }
+    bool operator==(const PoolHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const PoolHandle& other) const { return !(*this == other); }
+};
+
+// Pool de capacidade fixa de um tipo de entidade.
+//
+// As entidades vivas esto contguas em [begin(), end()): iterar  percorrer
+// um array, sem ponteiros nem slots vazios. destroy() move a ltima para o
+// buraco (a ordem muda), por isso quem guarda referncias usa handles.
+// Os slots libertados vo para uma lista livre e so reutilizados sem
+// alocar. A memria das entidades vem da arena do nvel (reset()); as
+// geraes ficam no pool, para sobreviverem  mudana de nvel.
+//
+// S para tipos trivialmente destrutveis, como a LevelArena.
+template <typename T, int Capacity>
+class EntityPool {
+    static_assert(std::is_trivially_destructible<T>::value, "EntityPool no chama destrutores");
+    static_assert(Capacity > 0 && Capacity < PoolHandle<T>::INVALID_SLOT, "Capacidade invlida");
+
+public:
+    typedef PoolHandle<T> Handle;
+
+    EntityPool() : items(nullptr), count(0), freeCount(0) {
+        for (int slot = 0; slot < Capacity; slot++) {
+            generations[slot] = 0;
+            denseOf[slot] = NO_ENTITY;
+        }
+    }
+
+    EntityPool(const EntityPool&) = delete;
+    EntityPool& operator=(const EntityPool&) = delete;
+
+    // Recomea com memria nova da arena (normalmente acabada de limpar).
+    // Os handles das entidades que estavam vivas deixam de resolver.
+    void reset(LevelArena& arena) {
+        items = static_cast<T*>(arena.allocate(sizeof(T) * Capacity, alignof(T)));
+        for (int i = 0; i < count; i++) {
+            generations[slotOf[i]]++;
+            denseOf[slotOf[i]] = NO_ENTITY;
+        }
+        count = 0;
+        // O slot 0 sai primeiro: entidades criadas por ordem ficam nos slots 0, 1, ...
+        freeCount = Capacity;
+        for (int i = 0; i < Capacity; i++) {
+            freeSlots[i] = static_cast<uint16_t>(Capacity - 1 - i);
+        }
+    }
+
+    // Handle invlido se o pool estiver cheio (ou sem memria: falta reset())
+    template <typename... Args>
+    Handle create(Args&&... args) {
+        if (!items || freeCount == 0) return Handle();
+        const uint16_t slot = freeSlots[--freeCount];
+        new (items + count) T(std::forward<Args>(args)...);
+        denseOf[slot] = static_cast<uint16_t>(count);
+        slotOf[count] = slot;
+        count++;
+        return Handle(slot, generations[slot]);
+    }
+
+    // false se o handle j no resolve
+    bool destroy(Handle handle) {
+        const int index = indexOf(handle);
+        if (index < 0) return false;
+
+        const int last = count - 1;
+        if (index != last) {
+            new (items + index) T(std::move(items[last]));
+            slotOf[index] = slotOf[last];
+            denseOf[slotOf[index]] = static_cast<uint16_t>(index);
+        }
+        count--;
+        denseOf[handle.slot] = NO_ENTITY;
+        generations[handle.slot]++;
+        freeSlots[freeCount++] = handle.slot;
+        return true;
+    }
+
+    // nullptr se o handle j no resolve
+    T* get(Handle handle) {
+        const int index = indexOf(handle);
+        return index < 0 ? nullptr : items + index;
+    }
+    const T* get(Handle handle) const {
+        const int index = indexOf(handle);
+        return index < 0 ? nullptr : items + index;
+    }
+
+    // Handle da entidade na posio index do array denso
+    Handle handleAt(int index) const { return Handle(slotOf[index], generations[slotOf[index]]); }
+
+    // Iterao sobre as entidades vivas (array denso)
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    static int capacity() { return Capacity; }
+    T& operator[](int index) { return items[index]; }
+    const T& operator[](int index) const { return items[index]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    static const uint16_t NO_ENTITY = 0xFFFF;
+
+    T* items;                         // Capacity entidades, as primeiras count vivas
+    int count;
+    int freeCount;
+    uint16_t generations[Capacity];   // Por slot
+    uint16_t denseOf[Capacity];       // Slot -> posio no array denso
+    uint16_t slotOf[Capacity];        // Posio no array denso -> slot
+    uint16_t freeSlots[Capacity];     // Pilha de slots livres
+
+    int indexOf(Handle handle) const {
+        if (handle.slot >= Capacity || generations[handle.slot] != handle.generation) return -1;
+        const uint16_t index = denseOf[handle.slot];
+        return index == NO_ENTITY ? -1 : index;
+    }
+};
+
+#endif
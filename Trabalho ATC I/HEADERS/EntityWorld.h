@@ -0,0 +1,136 @@
+#ifndef ENTITY_WORLD_H
+#define ENTITY_WORLD_H
+
+#include "entity_pool.h"
+#include "timer_wheel.h"
+#include <cstdint>
+
+class Board;
+class FrameRenderer;
+class EntityWorld;
+
+// Componentes: s dados. O que uma entidade  (Pac-Man, fantasma, fruta)
+// resulta dos componentes que tem, no de uma hierarquia de classes.
+struct Position {
+    int16_t x, y;
+};
+
+struct Velocity {
+    int8_t dx, dy;      // Direo atual (-1, 0 ou 1 em cada eixo)
+    uint8_t speed;      // Casas por tick (cada step() avana uma)
+};
+
+struct Renderable {
+    uint32_t glyph;
+    uint8_t color;      // Par de cores (ver PacmanUI)
+    uint8_t style;      // CellStyle
+};
+
+enum ColliderLayer : uint8_t {
+    LAYER_PLAYER = 1,
+    LAYER_GHOST = 2,
+    LAYER_PICKUP = 4
+};
+
+struct Collider {
+    uint8_t layer;      // ColliderLayer
+};
+
+struct AIController {
+    uint8_t ghost;              // ndice do comportamento (fantasma) no Game
+    uint8_t playerControlled;   // 1 = o 2 jogador escolhe a direo (modo versus)
+};
+
+struct Timer {
+    TimerHandle handle;         // Timer da roda do Game ligado  entidade
+};
+
+enum ComponentBit : uint8_t {
+    COMPONENT_POSITION = 1,
+    COMPONENT_VELOCITY = 2,
+    COMPONENT_AI = 4,
+    COMPONENT_TIMER = 8,
+    COMPONENT_RENDERABLE = 16,
+    COMPONENT_COLLIDER = 32
+};
+
+typedef PoolHandle<EntityWorld> EntityHandle;
+
+// Entidades do jogo em arrays densos, um por componente (estrutura de
+// arrays): os sistemas percorrem s o array e a mscara de que precisam,
+// sem chamadas virtuais. destroy() traz a ltima entidade para o buraco em
+// todos os arrays, por isso fora dos sistemas guarda-se um EntityHandle.
+// A ordem s muda ao destruir, e de forma determinstica.
+//
+// Capacidade fixa e guardada no prprio objeto: criar entidades no aloca.
+class EntityWorld {
+public:
+    static const int CAPACITY = 32;
+
+    EntityWorld();
+    EntityWorld(const EntityWorld&) = delete;
+    EntityWorld& operator=(const EntityWorld&) = delete;
+
+    // Componentes em components ficam a zero. Lana std::runtime_error se o mundo estiver cheio.
+    EntityHandle create(uint8_t components);
+    bool destroy(EntityHandle entity);   // false se j no existia
+    bool isAlive(EntityHandle entity) const { return indexOf(entity) >= 0; }
+
+    // Componentes de uma entidade viva (std::runtime_error se o handle no resolver)
+    Position& getPosition(EntityHandle entity) { return positions[require(entity)]; }
+    Velocity& getVelocity(EntityHandle entity) { return velocities[require(entity)]; }
+    Renderable& getRenderable(EntityHandle entity) { return renderables[require(entity)]; }
+    Collider& getCollider(EntityHandle entity) { return colliders[require(entity)]; }
+    AIController& getAI(EntityHandle entity) { return controllers[require(entity)]; }
+    Timer& getTimer(EntityHandle entity) { return timers[require(entity)]; }
+    const Position& getPosition(EntityHandle entity) const { return positions[require(entity)]; }
+    const Velocity& getVelocity(EntityHandle entity) const { return velocities[require(entity)]; }
+    const AIController& getAI(EntityHandle entity) const { return controllers[require(entity)]; }
+    const Timer& getTimer(EntityHandle entity) const { return timers[require(entity)]; }
+
+    // Arrays densos, para os sistemas: [0, size())
+    int size() const { return count; }
+    uint8_t getComponents(int index) const { return masks[index]; }
+    EntityHandle handleAt(int index) const { return EntityHandle(slotOf[index], generations[slotOf[index]]); }
+    const AIController* getControllers() const { return controllers; }
+
+    // Sistemas
+
+    // Movimento: avana uma casa na direo da Velocity se o destino for
+    // legal no tabuleiro (sem parede). true se mexeu. A velocidade no entra
+    // aqui: quem move speed casas chama step() speed vezes, e assim nenhuma
+    // casa (parede ou pellet) fica por ver.
+    bool step(EntityHandle entity, const Board& board);
+
+    // Colises: entidades de uma das camadas na casa (x, y), pela ordem
+    // dos arrays; escreve at capacity handles e devolve quantas encontrou
+    int findAt(int x, int y, uint8_t layers, EntityHandle* out, int capacity) const;
+
+    // Desenho: todas as Renderable, pela ordem dos arrays (as ltimas por
+    // cima). Escreve em drawn as casas desenhadas (at CAPACITY) e devolve quantas.
+    int render(FrameRenderer& screen, Position* drawn) const;
+
+private:
+    static const uint16_t NO_ENTITY = 0xFFFF;
+
+    int count;
+    uint8_t masks[CAPACITY];
+    Position positions[CAPACITY];
+    Velocity velocities[CAPACITY];
+    Renderable renderables[CAPACITY];
+    Collider colliders[CAPACITY];
+    AIController controllers[CAPACITY];
+    Timer timers[CAPACITY];
+
+    // Handles: slot -> posio nos arrays, e gerao por slot
+    uint16_t generations[CAPACITY];
+    uint16_t denseOf[CAPACITY];
+    uint16_t slotOf[CAPACITY];
+    uint16_t freeSlots[CAPACITY];
+    int freeCount;
+
+    int indexOf(EntityHandle entity) const;
+    int require(EntityHandle entity) const;
+};
+
+#endif
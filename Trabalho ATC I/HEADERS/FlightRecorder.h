@@ -0,0 +1,113 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include "game_snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class Game;
+
+// Gravador de voo: os ltimos segundos de ticks num anel de tamanho fixo
+// em memria (teclas, posies, estado, durao do tick, hash do estado).
+// No aloca depois do construtor e cada tick custa uma cpia de 64 bytes.
+// O anel  despejado para um ficheiro .pmfr:
+//   - quando o processo rebenta (SIGSEGV, SIGABRT, ...): "<base>-crash.pmfr",
+//     escrito s com write() dentro do handler;
+//   - quando um tick lana uma exceo (ex.: std::out_of_range do Board);
+//   - com a tecla DUMP_KEY (Ctrl+D) ou quando um tick passa do oramento.
+// pacman --flight-dump FICHEIRO mostra o contedo.
+
+struct FlightRecord {
+    static const int MAX_GHOSTS = GameSnapshot::MAX_GHOSTS;
+    static const int MAX_INPUTS = 4;
+
+    uint64_t stateHash;
+    uint32_t tick;
+    uint32_t tickMicros;          // Durao da simulao do tick
+    int32_t score;
+    int16_t pacmanX, pacmanY;
+    int16_t ghostX[MAX_GHOSTS];
+    int16_t ghostY[MAX_GHOSTS];
+    uint8_t ghostState[MAX_GHOSTS];   // GhostState
+    uint8_t gameState;            // GameState
+    uint8_t lives;
+    uint8_t level;
+    uint8_t inputCount;           // Teclas aplicadas antes do tick (pode passar de MAX_INPUTS)
+    int16_t inputs[MAX_INPUTS];   // As primeiras
+    int8_t pacmanDirectionX, pacmanDirectionY;
+    uint16_t events;              // Um bit por GameEventType ocorrido no tick
+    uint16_t reserved[2];
+};
+
+static_assert(std::is_trivially_copyable<FlightRecord>::value && sizeof(FlightRecord) == 64,
+    "FlightRecord mudou: aumente FlightDumpHeader::VERSION");
+
+// Cabealho do ficheiro; seguem-se recordCount registos, do mais antigo ao mais recente
+struct FlightDumpHeader {
+    static const uint32_t VERSION = 1;
+
+    char magic[4];              // "PMFR"
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t recordCount;
+    uint32_t ticksPerSecond;
+    uint32_t reserved;
+    uint64_t seed;
+    char reason[16];            // crash, exception, hotkey, budget
+    char detail[112];           // Sinal ou mensagem da exceo
+};
+
+class FlightRecorder {
+public:
+    static const int DEFAULT_SECONDS = 30;
+    static const int DUMP_KEY = 4;   // Ctrl+D: em modo cbreak chega como tecla
+
+    // Lana std::runtime_error se ticksPerSecond ou seconds forem invlidos
+    FlightRecorder(const std::string& basePath, int ticksPerSecond, int seconds = DEFAULT_SECONDS);
+    ~FlightRecorder();
+
+    // Oramento de um tick (0 = desligado): acima dele o anel  despejado,
+    // no mximo uma vez por volta do anel, para os despejos no se sobreporem
+    void setBudgetMs(double ms) { budgetMicros = ms > 0 ? static_cast<uint32_t>(ms * 1000) : 0; }
+
+    void recordInput(int key);    // Antes do tick a que pertence
+    void recordTick(const Game& game, uint32_t tickMicros);
+
+    // Escreve "<base>-<tick>-<reason>.pmfr"; devolve o caminho ou "" se falhar
+    // (no lana:  chamado quando algo j correu mal)
+    std::string dump(const char* reason, const char* detail = "");
+
+    // Um s gravador pode estar instalado de cada vez
+    void installCrashHandlers();
+
+    long long getDumps() const { return dumps; }
+    const std::string& getLastDumpPath() const { return lastDumpPath; }
+
+    // L um despejo; lana std::runtime_error se no for vlido
+    static void readDump(const std::string& path, FlightDumpHeader& header, std::vector<FlightRecord>& records);
+
+private:
+    std::string basePath;
+    char crashPath[512];              // Pronto antes de qualquer sinal
+    std::vector<FlightRecord> ring;   // Tamanho fixo
+    size_t next;                      // Prxima posio a escrever
+    size_t count;                     // Registos vlidos (at ring.size())
+    FlightRecord pending;             // Teclas do tick em curso
+    uint32_t ticksPerSecond;
+    uint64_t seed;
+    uint32_t budgetMicros;
+    uint32_t lastBudgetDumpTick;
+    bool hasBudgetDump;
+    long long dumps;
+    std::string lastDumpPath;
+    bool handlersInstalled;
+
+    // S write(): seguro dentro de um handler de sinal
+    bool writeDump(int fd, const char* reason, const char* detail) const;
+    static void onCrashSignal(int signalNumber);
+};
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef FRAME_RENDERER_H
+#define FRAME_RENDERER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Renderizao diferencial: o jogo compe o frame numa grelha de clulas
+// em memria e present() s envia ao terminal as clulas que mudaram desde
+// o ltimo frame, agrupadas em sequncias com os mesmos atributos. Nada
+// limpa o ecr inteiro: numa sesso SSH um tick normal custa dezenas de
+// bytes em vez de redesenhar o tabuleiro todo.
+
+// Estilos de uma clula (combinveis)
+enum CellStyle : uint8_t {
+    STYLE_NONE = 0,
+    STYLE_BOLD = 1,
+    STYLE_REVERSE = 2,
+    STYLE_LINE = 4      // glyph  um LineGlyph (molduras), no texto
+};
+
+// Caracteres de moldura, desenhados com o que o terminal tiver
+enum class LineGlyph : uint32_t {
+    VERTICAL,
+    HORIZONTAL,
+    UPPER_LEFT,
+    UPPER_RIGHT,
+    LOWER_LEFT,
+    LOWER_RIGHT
+};
+
+// Uma posio do ecr. O carcter guarda os bytes tal como vm do texto
+// (ASCII, uma sequncia UTF-8 ou um byte latin1), o primeiro no byte baixo.
+struct ScreenCell {
+    uint32_t glyph;
+    uint8_t color;      // Par de cores (PacmanUI::initializeColors); 0 = padro
+    uint8_t style;      // CellStyle
+    uint16_t reserved;  // Sempre 0, para comparar clulas inteiras
+
+    bool sameAttributes(const ScreenCell& other) const {
+        return color == other.color && style == other.style;
+    }
+    bool operator==(const ScreenCell& other) const {
+        return glyph == other.glyph && sameAttributes(other);
+    }
+    bool operator!=(const ScreenCell& other) const { return !(*this == other); }
+};
+
+// Destino dos frames: recebe s as sequncias que mudaram
+class ScreenBackend {
+public:
+    virtual ~ScreenBackend() {}
+    virtual void beginFrame() {}
+    // count clulas contguas a partir de (x, y), todas com os mesmos atributos
+    virtual void drawRun(int x, int y, const ScreenCell* cells, int count) = 0;
+    virtual void endFrame() = 0;             // Envia o frame ao terminal
+    virtual void clearTerminal() {}          // Antes de um redesenho completo
+    virtual size_t getLastFrameBytes() const { return 0; }  // 0 = desconhecido
+};
+
+// Backend curses: as sequncias viram mvaddnstr/mvaddch e um refresh()
+class CursesBackend : public ScreenBackend {
+public:
+    void drawRun(int x, int y, const ScreenCell* cells, int count) override;
+    void endFrame() override;
+    void clearTerminal() override;
+};
+
+// Backend ANSI: compe o frame inteiro num buffer alocado uma vez, com o
+// mnimo de movimentos de cursor e mudanas de SGR, e envia-o num nico
+// write(). O curses continua a tratar do teclado e do modo do terminal,
+// mas nunca mais desenha (stdscr fica intocado e o getch() no o refresca).
+class AnsiBackend : public ScreenBackend {
+public:
+    AnsiBackend(int fd, int width, int height);
+    ~AnsiBackend() override;
+
+    void drawRun(int x, int y, const ScreenCell* cells, int count) override;
+    void endFrame() override;
+    void clearTerminal() override;
+    size_t getLastFrameBytes() const override { return lastFrameBytes; }
+
+    long long getWrites() const { return writes; }
+
+private:
+    // Pior caso por clula: cursor + SGR + troca de charset + 4 bytes do glyph
+    static const size_t MAX_CELL_BYTES = 40;
+
+    int fd;
+    int width;
+    int height;
+    std::vector<char> buffer;   // Capacidade fixa para um ecr inteiro
+    size_t used;
+    size_t lastFrameBytes;
+    long long writes;
+
+    // O que o terminal tem neste momento (-1 = desconhecido)
+    int cursorX, cursorY;
+    int currentColor, currentStyle;
+    bool lineCharset;           // G0 em DEC Special Graphics
+
+    void moveCursor(int x, int y);
+    void setAttributes(uint8_t color, uint8_t style);
+    void append(const char* bytes, size_t count);
+    void appendNumber(int value);
+    void flush();
+};
+
+// Backend escolhido no arranque (--renderer)
+enum class RendererKind {
+    CURSES_LIB,   // CursesBackend
+    RAW_ANSI      // AnsiBackend no stdout
+};
+
+// Lana std::runtime_error se o backend no puder ser criado
+std::unique_ptr<ScreenBackend> createScreenBackend(RendererKind kind, int width, int height);
+
+struct RenderStats {
+    long long frames;        // present() com alguma mudana
+    long long idleFrames;    // present() sem nada para enviar
+    long long cells;         // Clulas enviadas (incluindo as que ligam sequncias)
+    long long runs;          // Sequncias enviadas
+    long long bytes;         // Bytes enviados ao terminal (se o backend souber)
+    int lastCells;
+    int lastRuns;
+
+    // S com a thread de render
+    long long published;     // Frames entregues pela simulao
+    long long dropped;       // Substitudos por um mais recente antes de serem desenhados
+    uint32_t lastLagTicks;   // Ticks entre o ltimo frame publicado e o desenhado
+    uint32_t maxLagTicks;
+    double meanLagMs;        // Da publicao at o frame chegar ao terminal
+    double maxLagMs;
+
+    RenderStats() : frames(0), idleFrames(0), cells(0), runs(0), bytes(0), lastCells(0), lastRuns(0),
+        published(0), dropped(0), lastLagTicks(0), maxLagTicks(0), meanLagMs(0), maxLagMs(0) {}
+};
+
+// Com startThread(), present() s publica o frame num triple buffer sem
+// locks e uma thread prpria envia-o ao terminal: um terminal lento ou um
+// write() bloqueado atrasam os frames, nunca os ticks da simulao. Se a
+// simulao publicar mais depressa do que o terminal aguenta, os frames
+// intermdios so descartados e o prximo desenhado inclui as suas mudanas.
+class FrameRenderer {
+public:
+    FrameRenderer(int width, int height, std::unique_ptr<ScreenBackend> backend);
+    ~FrameRenderer();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Composio: s mexe na grelha em memria. Fora do ecr  ignorado.
+    void clear();                                             // Frame todo em branco
+    void clearArea(int x, int y, int areaWidth, int areaHeight);
+    void put(int x, int y, uint32_t glyph, uint8_t color = 0, uint8_t style = STYLE_NONE);
+    void putLine(int x, int y, LineGlyph glyph, uint8_t color = 0);
+    // Escreve texto (UTF-8 ou latin1) e devolve as colunas ocupadas
+    int print(int x, int y, const char* text, uint8_t color = 0, uint8_t style = STYLE_NONE);
+    int printf(int x, int y, uint8_t color, uint8_t style, const char* format, ...);
+
+    // Envia ao backend s o que difere do frame anterior; tick identifica o
+    // estado da simulao para medir o atraso do render.
+    // Com a thread, relana aqui um erro que o backend tenha lanado l.
+    void present(uint32_t tick = 0);
+    void invalidate();   // O terminal foi mexido por fora: o prximo present() redesenha tudo
+
+    // O backend passa a ser usado s pela thread (no pode usar o curses,
+    // que partilha estado com o getch() da thread principal)
+    void startThread();
+    void stopThread();   // Desenha o ltimo frame publicado e espera pela thread
+    bool isThreaded() const { return threaded; }
+
+    const ScreenCell& at(int x, int y) const { return next[y * width + x]; }
+    RenderStats getStats() const;
+
+private:
+    // Sequncias de clulas iguais mais curtas do que isto so reenviadas em
+    // vez de saltar o cursor por cima delas (um salto custa ~6-8 bytes)
+    static const int MAX_BRIDGE = 4;
+
+    int width;
+    int height;
+    std::unique_ptr<ScreenBackend> backend;
+    std::vector<ScreenCell> next;     // Frame em composio
+    std::vector<ScreenCell> shown;    // O que o terminal mostra
+    std::vector<int> dirtyMin;        // Por linha: colunas tocadas desde o ltimo present()
+    std::vector<int> dirtyMax;        // (min > max = linha limpa)
+    bool fullRedraw;
+    mutable std::mutex statsMutex;    // Nunca fica preso durante o envio ao terminal
+    RenderStats stats;
+
+    // Triple buffer: a simulao escreve em backSlot, a thread l frontSlot
+    // e middleSlot troca de dono com uma troca atmica
+    struct FrameSlot {
+        std::vector<ScreenCell> cells;
+        std::vector<int> dirtyMin;
+        std::vector<int> dirtyMax;
+        bool fullRedraw;
+        uint32_t tick;
+        std::chrono::steady_clock::time_point publishedAt;
+    };
+    static const int SLOT_MASK = 3;
+    static const int FRESH_SLOT = 4;  // middleSlot tem um frame ainda no desenhado
+
+    bool threaded;
+    FrameSlot slots[3];
+    int backSlot;
+    int frontSlot;
+    std::atomic<int> middleSlot;
+    std::atomic<uint32_t> latestTick;
+    // Mudanas de frames publicados que a thread ainda pode no ter visto
+    std::vector<int> carryMin;
+    std::vector<int> carryMax;
+    bool carryFullRedraw;
+
+    std::thread renderThread;
+    bool stopRequested;               // Protegido por wakeMutex
+    std::mutex wakeMutex;             // S para a thread dormir sem perder avisos
+    std::condition_variable wakeCondition;
+    std::exception_ptr renderError;   // Protegido por statsMutex
+
+    void publish(uint32_t tick);
+    void renderLoop();
+    // Diferena entre cells e shown nas linhas marcadas; limpa as marcas
+    void presentCells(const ScreenCell* cells, int* rowMin, int* rowMax, bool clearFirst);
+    void touch(int x, int y);
+    void markAllDirty();
+};
+
+#endif
@@ -7,8 +7,23 @@
 #include "pacman_ui.h"
 #include "game_menu.h"
 #include "highscore_manager.h"
+#include "game_random.h"
+#include "game_snapshot.h"
+#include "frame_renderer.h"
+#include "level_arena.h"
+#include "entity_pool.h"
+#include "entity_world.h"
+#include "timer_wheel.h"
+#include "game_events.h"
+#ifdef PACMAN_PROFILE
+#include "tick_profiler.h"
+#endif
 #include <vector>
 #include <memory>
+#include <cstdint>
+
+class ReplayRecorder;
+class ReplayStreamWriter;
 
 // Estados possveis do jogo
 enum class GameState {
@@ -21,68 +36,108 @@ enum class GameState {
 };
 
 class Game {
+public:
+    // Configuraes do nvel
+    struct LevelConfig {
+        int ghostSpeed;           // Velocidade dos fantasmas
+        int pacmanSpeed;          // Velocidade do Pacman
+        int powerPelletDuration; // Durao do power pellet
+        int bonusPoints;         // Pontos bnus do nvel
+        int turnBufferTicks;     // Janela de pr-viragem do Pacman (0 = desligada)
+    };
+
 private:
-    // Componentes principais do jogo
-    Board* board;                                // Tabuleiro
-    Pacman* pacman;                             // O Pacman
-    std::vector<std::shared_ptr<Ghost>> ghosts; // Lista de fantasmas
-    GameMenu* gameMenu;                         // Menu do jogo
-    HighScoreManager* highscoreManager;         // Gerenciador de pontuao
+    // Posio, movimento, desenho e coliso do Pacman e dos fantasmas, em
+    // arrays densos por componente (antes de quem cria entidades nele)
+    EntityWorld entities;
+
+    // Componentes principais do jogo (vivem tanto quanto o Game)
+    std::unique_ptr<Board> board;                       // Tabuleiro
+    std::unique_ptr<Pacman> pacman;                     // O Pacman
+    std::unique_ptr<GameMenu> gameMenu;                 // Menu do jogo
+    std::unique_ptr<HighScoreManager> highscoreManager; // Gerenciador de pontuao
+
+    // Pontos mostrados por uns ticks onde um fantasma foi comido (s visual:
+    // fora do hash e do snapshot)
+    struct ScorePopup {
+        int x, y;
+        int points;
+        int ticksLeft;
+    };
+    static const int MAX_POPUPS = 8;
+    static const int POPUP_TICKS = 30;
+
+    // O que s vive durante um nvel: recriado em bloco a cada resetLevel()
+    LevelArena levelArena;
+    EntityPool<Ghost, GameSnapshot::MAX_GHOSTS> ghosts;   // Na levelArena
+    EntityPool<ScorePopup, MAX_POPUPS> popups;           // Na levelArena
 
     // Estado e controle do jogo
     GameState state;         // Estado atual do jogo
     int currentLevel;        // Nvel atual
     int score;              // Pontuao
-    int addLevelBonus       // aumenta ao passar de nivel
     int lives;              // Vidas restantes
     bool isGameOver;        // Se o jogo acabou
-    int transitionTimer;    // Timer para telas de transio
+    bool renderDirty;       // Se algo visvel mudou desde o ltimo render
+    bool quitRequested;     // Se o jogador pediu para sair
+    bool showingHighScores; // Tabela de pontuaes aberta a partir do menu
+    uint32_t tickCount;     // Ticks simulados desde startGame()
+    int controlledGhost;    // Fantasma controlado pelo 2 jogador (-1 = nenhum)
+    bool speculative;       // Ticks que podem ser desfeitos (rollback): sem efeitos externos
+
+    // Timers da simulao: s correm em PLAYING e entre nveis. O que falta
+    // a cada um entra no hash e no snapshot; a roda em si no. A sada de
+    // cada fantasma da casa  o componente Timer da sua entidade.
+    TimerWheel timers;
+    TimerHandle powerTimer;                                 // Fim do power pellet
+    TimerHandle transitionTimer;                            // Fim do ecr entre nveis
+
+    // Eventos do tick atual (valem at ao incio do tick seguinte)
+    GameEventBuffer tickEvents;
+
+    // Determinismo e gravao
+    uint64_t seed;              // Seed usada em startGame()
+    GameRandom rng;             // nico gerador aleatrio da simulao
+    ReplayRecorder* recorder;   // Gravador da sesso (opcional, no  dono)
+    ReplayStreamWriter* streamWriter; // Stream de keyframes/deltas (opcional, no  dono)
 
-    // Configuraes do nvel
-    struct LevelConfig {
-        int ghostSpeed;           // Velocidade dos fantasmas
-        int pacmanSpeed;          // Velocidade do Pacman
-        int powerPelletDuration; // Durao do power pellet
-        int bonusPoints;         // Pontos bnus do nvel
-    };
     std::vector<LevelConfig> levelConfigs; // Configuraes de cada nvel
 
-    class Game {
-    private:
-        // Componentes principais do jogo
-        Board* board;
-        Pacman* pacman;
-        std::vector<std::shared_ptr<Ghost>> ghosts;
-        GameMenu* gameMenu;
-        HighScoreManager* highscoreManager;
-
-        // Estado e controle do jogo
-        GameState state;
-        int currentLevel;
-        int score;
-        int addLevelBonus;
-        int lives;
-        bool isGameOver;
-        int transitionTimer;
-
-        // Configuraes do nvel
-        struct LevelConfig {
-            int ghostSpeed;
-            int pacmanSpeed;
-            int powerPelletDuration;
-            int bonusPoints;
-        };
-        std::vector<LevelConfig> levelConfigs;
-
-        // Sistema de Colises
-        struct CollisionResult {
-            bool hitGhost;
-            bool ghostVulnerable;
-            bool hitPellet;
-            bool hitPowerPellet;
-        };
-        CollisionResult checkCollisionAt(int x, int y);
+    // Ecr: criado no primeiro render() (o servidor nunca desenha)
+    struct DrawnEntity {
+        int x, y;
+    };
+    std::unique_ptr<FrameRenderer> screen;   // Frame composto + o que o terminal mostra
+    RendererKind rendererKind;               // Backend usado ao criar o screen
+    bool renderThreaded;                     // Terminal alimentado por uma thread prpria
+    int shownScreen;                         // Ecr composto no frame (-1 = nenhum)
+    std::vector<DrawnEntity> drawnEntities;  // Onde as entidades e os popups foram desenhados
+
+    // Hash do estado nos ltimos ticks, para detetar dessincronizao
+    static const int HASH_HISTORY = 128;
+    struct TickHash {
+        uint32_t tick;
+        uint64_t hash;
+    };
+    TickHash hashHistory[HASH_HISTORY];
+
+#ifdef PACMAN_PROFILE
+    // Tempo de cada fase do tick e overlay com os percentis (tecla T)
+    TickProfiler profiler;
+    bool showProfiler;
+    uint32_t profileSummaryTick;    // Tick em que o resumo do overlay foi calculado
+    ProfileSummary profileSummary;
+#endif
+
+    // Sistema de Colises
+    struct CollisionResult {
+        bool hitGhost;
+        int ghost;              // ndice do fantasma atingido (-1 = nenhum)
+        bool ghostVulnerable;
+        bool hitPellet;
+        bool hitPowerPellet;
     };
+    CollisionResult checkCollisionAt(int x, int y);
 
 public:
     // Construtor e destrutor
@@ -91,8 +146,69 @@ public:
 
     // Controle principal do jogo
     void startGame();              // Inicia novo jogo
-    void updateGameState();        // Atualiza estado do jogo
+    void updateGameState();        // Avana um tick da simulao (no desenha)
     void handleInput(int input);   // Processa entrada do usurio
+    void handleGhostInput(int input); // Entrada do jogador que controla um fantasma
+    void render();                 // Desenha o estado atual e limpa o dirty flag
+
+    // Controle do loop principal
+    bool needsRender() const { return renderDirty; } // Algo mudou desde o ltimo render?
+    bool shouldQuit() const { return quitRequested; }
+    RenderStats getRenderStats() const { return screen ? screen->getStats() : RenderStats(); }
+    void setRendererKind(RendererKind kind) { rendererKind = kind; }   // Antes do primeiro render()
+    void setRenderThreaded(bool value) { renderThreaded = value; }     // S com RAW_ANSI
+    void requestQuit() { quitRequested = true; }
+#ifdef PACMAN_PROFILE
+    TickProfiler& getProfiler() { return profiler; }
+#endif
+
+    // Modo versus: um fantasma passa a ser controlado por um jogador
+    void setGhostPlayer(int ghostIndex);   // -1 devolve todos  IA
+    int getGhostPlayer() const { return controlledGhost; }
+
+    // Em modo especulativo, handleInput/updateGameState podem ser repetidos
+    // para os mesmos ticks (rollback): no gravam replays nem pontuaes
+    void setSpeculative(bool value) { speculative = value; }
+    bool isSpeculative() const { return speculative; }
+
+    // Determinismo e replays
+    void setSeed(uint64_t newSeed) { seed = newSeed; }   // Aplicada no prximo startGame()
+    uint64_t getSeed() const { return seed; }
+    void setRecorder(ReplayRecorder* newRecorder) { recorder = newRecorder; }
+    void setStreamWriter(ReplayStreamWriter* writer) { streamWriter = writer; }
+    const std::vector<LevelConfig>& getLevelConfigs() const { return levelConfigs; }
+    void setLevelConfigs(const std::vector<LevelConfig>& configs) { levelConfigs = configs; }
+
+    // Getters de estado
+    GameState getState() const { return state; }
+    uint32_t getTickCount() const { return tickCount; }
+    int getScore() const { return score; }
+    int getLives() const { return lives; }
+    int getLevel() const { return currentLevel; }
+    int getMazeId() const { return board->getMazeId(); }
+    const Pacman& getPacman() const { return *pacman; }
+    // O que aconteceu no ltimo tick (pellets, fantasmas comidos, ...)
+    const GameEventBuffer& getTickEvents() const { return tickEvents; }
+    // Vlidos at ao prximo resetLevel()/startGame() (vivem na arena do nvel)
+    const EntityPool<Ghost, GameSnapshot::MAX_GHOSTS>& getGhosts() const { return ghosts; }
+
+    // Checksum do estado (Zobrist): O(fantasmas), o tabuleiro  incremental
+    uint64_t getStateHash() const;
+    // Hash registado no fim de um tick recente; false se j saiu do histrico
+    bool getTickHash(uint32_t tick, uint64_t& hash) const;
+
+    // Snapshots: estado completo em bloco fixo, sem alocaes
+    void saveSnapshot(GameSnapshot& out) const;
+    void restoreSnapshot(const GameSnapshot& in);
+    // Atualiza um snapshot do mesmo jogo (ex.: o do tick anterior): os
+    // planos de pellets s so reescritos nas casas alteradas
+    void updateSnapshot(GameSnapshot& snapshot) const;
+
+    // Casas do tabuleiro alteradas desde o ltimo clearDirtyCells() (ver Board).
+    // Um s consumidor por jogo: o render() ou quem publica os snapshots.
+    int getDirtyCount() const { return board->getDirtyCount(); }
+    const uint16_t* getDirtyCells() const { return board->getDirtyCells(); }
+    void clearDirtyCells() { board->clearDirtyCells(); }
 
     // Controle de estados
     void pauseGame();             // Pausa o jogo
@@ -105,28 +221,50 @@ public:
     void checkVictoryCondition(); // Verifica se ganhou
     bool isLevelComplete();       // Verifica se completou nvel
 
-    // Sistema de pontuao
-    void incrementScore(int points);
-    void addLevelBonus();
-
-    // Sistema de vidas
-    void loseLife();
-    void addLife();
+    // Subscritores dos eventos do tick: o dispatchEvents() passa o array
+    // inteiro a cada um, por esta ordem, no fim do tick
+    void dispatchEvents();
+    void scoreEvents(const GameEvent* events, int count);     // Pontos e vidas
+    void hudEvents(const GameEvent* events, int count);       // Redesenho e popups de pontos
+    void telemetryEvents(const GameEvent* events, int count); // Mtricas
+    void outcomeEvents(const GameEvent* events, int count);   // Fim de jogo, recomeo, fim de nvel
 
     // Menus e telas
     void showMainMenu();
     void showPauseMenu();
     void showTransitionScreen();
     void showGameOver();
+    void showHighScore();
 
 private:
     // Mtodos auxiliares
+    void resetLevelEntities();        // Recria as entidades do nvel na arena
     void initializeLevelConfigs();    // Configura nveis
+    void setupMainMenu();             // Opes do menu principal
     void updateDifficulty();          // Atualiza dificuldade
     void resetGameState();            // Reseta estado do jogo
-    void spawnEntities();             // Posiciona entidades
-    void updateGhosts();              // Atualiza fantasmas
+    void finishGame();                // Fim de jogo: pontuao e fecho da gravao
+    void clearHashHistory();          // Esquece os checksums de ticks anteriores
+    void saveFields(GameSnapshot& out) const; // Tudo menos os planos de pellets
+    void spawnEntities();             // Nvel novo: arena limpa, Pacman e fantasmas no spawn
+    void movePacman();                // Pacman: speed passos, come os pellets pelo caminho
+    bool updateGhosts();              // Atualiza fantasmas (true se algum mexeu)
+    void collectPellet(int x, int y); // Pellet ou power pellet na casa (x, y), se houver
+    bool updatePopups();              // Conta os popups de pontos (true se havia algum)
+    void runTimers();                 // Avana a roda e despacha os que expiraram
+    void onTimer(const TimerEvent& event);
+    void startPower();                // Power pellet: Pacman com poder, fantasmas vulnerveis
+    void scheduleRelease(int ghostIndex, uint32_t delay);
+    TimerHandle& releaseTimer(int ghostIndex);   // Componente Timer do fantasma
+    void showScorePopup(int x, int y, int points);
+    void handlePlayingInput(int input);
+    void handlePausedInput(int input);
     void renderGame();                // Renderiza o jogo
+    void drawPlaying(bool fullBoard); // Tabuleiro: s as casas que mudaram
+    void drawHUD();                   // Desenha nvel, pontos e vidas
+#ifdef PACMAN_PROFILE
+    void drawProfiler();              // Overlay do perfil,  direita do tabuleiro
+#endif
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,74 @@
+#ifndef GAME_EVENTS_H
+#define GAME_EVENTS_H
+
+#include <cstdint>
+#include <stdexcept>
+
+// O que aconteceu num tick. A simulao s acrescenta eventos ao buffer do
+// tick; no fim do tick o Game passa o array inteiro a cada subscritor
+// (pontuao, HUD, telemetria, ...), um de cada vez, em vez de chamar um
+// callback por evento.
+enum class GameEventType : uint8_t {
+    PELLET_EATEN,
+    POWER_PELLET_EATEN,
+    GHOST_EATEN,
+    LIFE_LOST,
+    LEVEL_COMPLETE,
+    COUNT
+};
+
+struct GameEvent {
+    GameEventType type;
+    int8_t ghost;       // GHOST_EATEN: ndice do fantasma (-1 nos outros)
+    int16_t x, y;       // Onde aconteceu
+    int32_t points;     // Pontos ganhos (0 = nenhum)
+};
+
+// Buffer de um tick: capacidade fixa, sem alocaes
+class GameEventBuffer {
+public:
+    static const int CAPACITY = 32;
+
+    GameEventBuffer() : count(0) {}
+
+    // Mais de CAPACITY eventos num tick  um erro da simulao
+    void push(GameEventType type, int x, int y, int points, int ghost = -1) {
+        if (count == CAPACITY) {
+            throw std::runtime_error("Buffer de eventos do tick cheio");
+        }
+        GameEvent& event = events[count++];
+        event.type = type;
+        event.ghost = static_cast<int8_t>(ghost);
+        event.x = static_cast<int16_t>(x);
+        event.y = static_cast<int16_t>(y);
+        event.points = points;
+    }
+
+    void clear() { count = 0; }
+    bool contains(GameEventType type) const {
+        for (int i = 0; i < count; i++) {
+            if (events[i].type == type) return true;
+        }
+        return false;
+    }
+
+    // Um bit por GameEventType presente (gravador de voo)
+    uint16_t getTypeMask() const {
+        uint16_t mask = 0;
+        for (int i = 0; i < count; i++) {
+            mask |= static_cast<uint16_t>(1u << static_cast<int>(events[i].type));
+        }
+        return mask;
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const GameEvent* begin() const { return events; }
+    const GameEvent* end() const { return events + count; }
+
+private:
+    GameEvent events[CAPACITY];
+    int count;
+};
+
+#endif
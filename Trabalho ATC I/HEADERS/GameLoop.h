@@ -0,0 +1,95 @@
+#ifndef GAME_LOOP_H
+#define GAME_LOOP_H
+
+#include "input_thread.h"
+#include <chrono>
+#include <cstdint>
+
+class Game;
+class FlightRecorder;
+
+// Configurao do loop principal
+struct GameLoopConfig {
+    int ticksPerSecond;      // Ticks de simulao por segundo (fixo)
+    int maxFramesPerSecond;  // Limite de renders por segundo
+    int maxTicksPerFrame;    // Mximo de ticks recuperados num frame (evita "spiral of death")
+
+    GameLoopConfig() : ticksPerSecond(10), maxFramesPerSecond(60), maxTicksPerFrame(5) {}
+};
+
+// Estatsticas de tempo recolhidas pelo loop
+struct FrameTimingStats {
+    long long ticks;           // Ticks simulados
+    long long renders;         // Frames desenhados
+    long long skippedRenders;  // Frames em que nada mudou (render evitado)
+    long long droppedTicks;    // Ticks descartados por excederem maxTicksPerFrame
+    double meanTickIntervalMs; // Intervalo mdio real entre ticks
+    double jitterMs;           // Desvio padro do intervalo entre ticks
+    double maxJitterMs;        // Maior desvio absoluto em relao ao passo ideal
+
+    FrameTimingStats() : ticks(0), renders(0), skippedRenders(0), droppedTicks(0),
+        meanTickIntervalMs(0), jitterMs(0), maxJitterMs(0) {}
+};
+
+// Quem precisa de decidir o que acontece em cada tick (ex.: rollback em
+// rede, que pode re-simular vrios ticks de uma vez) substitui as chamadas
+// diretas a Game::handleInput e Game::updateGameState
+class TickDriver {
+public:
+    virtual ~TickDriver() {}
+    virtual void handleInput(int input) = 0;  // Tecla lida neste frame
+    virtual void tick() = 0;                  // Um passo do relgio do loop
+};
+
+// Loop de passo fixo: a simulao avana em ticks de durao constante,
+// medidos num relgio monotnico com acumulador. O render corre  parte,
+// limitado a maxFramesPerSecond, e s quando o jogo indica que algo mudou.
+// A entrada  lida sem bloquear, por isso o getch() j no dita a velocidade.
+class GameLoop {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    GameLoop(Game& game, const GameLoopConfig& config = GameLoopConfig());
+
+    void run();    // Corre at game.shouldQuit() ou stop()
+    void stop();   // Pede para terminar no fim do frame atual
+    void setDriver(TickDriver* newDriver) { driver = newDriver; }  // No  dono
+    // Com uma thread de entrada, as teclas so lidas da fila dela no incio
+    // de cada tick em vez do getch() (no  dono)
+    void setInputThread(InputThread* thread) { input = thread; }
+    // Cada tick (teclas, durao, estado) fica no gravador de voo (no  dono)
+    void setFlightRecorder(FlightRecorder* recorder) { flightRecorder = recorder; }
+
+    const FrameTimingStats& getStats() const { return stats; }
+    const GameLoopConfig& getConfig() const { return config; }
+    const InputLatencyHistogram& getInputLatency() const { return inputLatency; }
+
+private:
+    Game& game;
+    TickDriver* driver;          // Opcional: substitui a entrada e o tick do Game
+    InputThread* input;          // Opcional: fonte das teclas em vez do getch()
+    FlightRecorder* flightRecorder;  // Opcional
+    InputLatencyHistogram inputLatency;  // Chegada da tecla -> tick que a aplicou
+    GameLoopConfig config;
+    FrameTimingStats stats;
+    bool running;
+
+    Clock::duration tickStep;    // Durao de um tick
+    Clock::duration renderStep;  // Intervalo mnimo entre renders
+
+    // Acumuladores para o jitter (algoritmo de Welford)
+    Clock::time_point lastTickTime;
+    bool hasLastTick;
+    double intervalMean;
+    double intervalM2;
+
+    void pollInput();
+    void drainInput();           // Aplica as teclas chegadas at agora
+    void applyInput(int key);
+    void runTick();              // Um tick, medido e gravado se houver gravador
+    // Com -DPACMAN_ALLOC_CHECK: lana se um tick/render em PLAYING alocou
+    void checkAllocations(const char* phase, bool wasPlaying, uint64_t allocations) const;
+    void recordTickTiming(Clock::time_point now);
+};
+
+#endif
@@ -2,10 +2,11 @@
 #define GAME_MENU_H
 
 #include <string>
-#include <vector>
 #include <functional>
+#include <cstdint>
 #include <curses.h>
-#include "game_object.h"
+
+class FrameRenderer;
 
 // Define as direes possveis no menu
 enum class MenuNavigation {
@@ -15,22 +16,47 @@ enum class MenuNavigation {
     ESCAPE  // Tecla Esc
 };
 
-// Estrutura para representar cada opo do menu
+// O que uma opo faz: a navegao entre submenus  do prprio menu,
+// o resto passa s MenuActions do dono
+enum class MenuCommand : uint8_t {
+    NONE,             // Opo s informativa (ou ainda sem lgica)
+    NEW_GAME,
+    RESUME,
+    RESTART_LEVEL,
+    SHOW_HIGHSCORES,
+    QUIT,
+    MAIN_MENU,
+    CONFIG_MENU,
+    CONTROLS_MENU,
+    CONFIRM_EXIT
+};
+
+// Estrutura para representar cada opo do menu. Os menus so tabelas
+// estticas: mudar de menu s troca um ponteiro, sem construir strings
+// nem std::function a cada show*Menu()
 struct MenuItem {
-    std::string label;           // Texto da opo
-    std::string description;     // Descrio/explicao da opo
-    std::function<void()> action;// Funo a ser executada
+    const char* label;           // Texto da opo
+    const char* description;     // Descrio/explicao da opo
+    MenuCommand command;         // O que a opo faz
     bool isEnabled;              // Se a opo est habilitada
+};
 
-    MenuItem(const std::string& lbl, const std::string& desc,
-        std::function<void()> act, bool enabled = true)
-        : label(lbl), description(desc), action(act), isEnabled(enabled) {}
+// Aes que o dono do menu liga s opes. O menu no conhece o Game nem
+// termina o processo: "Sair" s avisa quem o criou.
+struct MenuActions {
+    std::function<void()> newGame;
+    std::function<void()> resume;
+    std::function<void()> restartLevel;
+    std::function<void()> showHighScores;
+    std::function<void()> quit;
 };
 
 class GameMenu {
 private:
     std::string title;                    // Ttulo do menu
-    std::vector<MenuItem> menuItems;      // Lista de opes do menu
+    const MenuItem* menuItems;            // Opes do menu atual (tabela esttica)
+    int itemCount;                        // Nmero de opes
+    MenuActions actions;                  // Ligadas pelo dono do menu
     int selectedOption;                   // ndice da opo selecionada
     bool isActive;                        // Se o menu est ativo
     bool showHelp;                        // Se mostra descries das opes
@@ -45,15 +71,11 @@ public:
     // Construtor: inicializa o menu
     GameMenu(const std::string& menuTitle);
 
-    // Adiciona uma nova opo ao menu
-    void addMenuItem(const std::string& label,
-        const std::string& description,
-        std::function<void()> action,
-        bool enabled = true);
+    void setActions(const MenuActions& newActions) { actions = newActions; }
 
     // Funes principais do menu
-    void display();                           // Mostra o menu na tela
-    void handleInput(int key);                // Processa entrada do usurio
+    void display(FrameRenderer& screen);      // Compe o menu no frame (s no render)
+    void handleInput(int key);                // Processa entrada do usurio (no desenha)
     void selectCurrentOption();               // Executa opo selecionada
 
     // Menus especficos
@@ -65,16 +87,18 @@ public:
 
 private:
     // Funes auxiliares de desenho
-    void drawFrame();                         // Desenha borda do menu
-    void drawTitle();                         // Desenha ttulo
-    void drawOptions();                       // Desenha opes
-    void drawDescription();                   // Desenha descrio da opo atual
-    void drawControls();                      // Desenha teclas de controle
-    void clearMenuArea();                     // Limpa rea do menu
+    void drawFrame(FrameRenderer& screen);    // Desenha borda do menu
+    void drawTitle(FrameRenderer& screen);    // Desenha ttulo
+    void drawOptions(FrameRenderer& screen);  // Desenha opes
+    void drawDescription(FrameRenderer& screen); // Desenha descrio da opo atual
+    void drawControls(FrameRenderer& screen); // Desenha teclas de controle
+    void clearMenuArea(FrameRenderer& screen); // Limpa rea do menu (no frame, no no terminal)
 
     // Funes de navegao
     void moveSelection(MenuNavigation dir);   // Move seleo
     void updateSelection();                   // Atualiza opo selecionada
+    void run(const std::function<void()>& action); // Executa uma ao, se ligada
+    void setItems(const MenuItem* items, int count); // Troca o menu atual
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef GAME_RANDOM_H
+#define GAME_RANDOM_H
+
+#include <cstdint>
+
+// Gerador pseudo-aleatrio determinstico (xorshift64*) de cada Game.
+// Substitui rand(): com a mesma seed a simulao repete-se bit a bit,
+// o que permite gravar e reproduzir partidas.
+class GameRandom {
+public:
+    explicit GameRandom(uint64_t seed = 1) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        seedValue = seed;
+        state = seed ? seed : 0x9E3779B97F4A7C15ULL; // xorshift no aceita estado 0
+        draws = 0;
+    }
+
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        draws++;
+        return static_cast<uint32_t>((state * 0x2545F4914F6CDD1DULL) >> 32);
+    }
+
+    // Inteiro em [0, n)
+    int nextInt(int n) { return n > 0 ? static_cast<int>(next() % static_cast<uint32_t>(n)) : 0; }
+
+    uint64_t getSeed() const { return seedValue; }
+    uint64_t getState() const { return state; }
+    uint64_t getDraws() const { return draws; }
+
+    // Repe um estado guardado anteriormente
+    void restore(uint64_t seed, uint64_t savedState, uint64_t savedDraws) {
+        seedValue = seed;
+        state = savedState;
+        draws = savedDraws;
+    }
+
+private:
+    uint64_t seedValue;  // Seed inicial
+    uint64_t state;      // Estado interno
+    uint64_t draws;      // Nmeros gerados desde a seed
+};
+
+#endif
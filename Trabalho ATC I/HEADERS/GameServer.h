@@ -0,0 +1,111 @@
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Servidor de jogo: milhares de Game no mesmo processo, sem interface.
+// Um event loop (epoll) por core; cada sesso pertence ao loop que a aceitou
+// e s essa thread lhe toca, por isso o Game no precisa de locks.
+//
+// Protocolo sobre TCP ou socket Unix (stream), little-endian:
+//   cliente -> servidor (tamanho fixo):
+//     JOIN:  tipo (u8) | seed (u64)            -> cria a sesso e comea o jogo
+//     INPUT: tipo (u8) | ReplayCode (u8)       -> direo ou pausa
+//     WATCH: tipo (u8) | id da sesso (u32)    -> passa a espectador dessa sesso
+//   servidor -> cliente: tamanho dos dados (u16) | tipo (u8) | dados
+//     WELCOME:  id da sesso (u32) | ticks por segundo (u16)
+//     KEYFRAME: GameSnapshot em bruto
+//     DELTA:    delta para o tick seguinte (snapshot_delta.h)
+//
+// Cada tick de uma sesso  codificado uma s vez num frame partilhado
+// (contagem de referncias), que vai para o jogador e para todos os
+// espectadores sem cpias; o delta usa as casas alteradas do tabuleiro.
+// Um espectador pode ligar-se a qualquer loop: a ligao passa para o loop
+// da sesso. Uma ligao lenta (mais de maxPendingBytes por enviar) deixa de
+// receber deltas e recebe um keyframe quando recupera; o jogo nunca espera.
+
+enum class ClientMessage : uint8_t {
+    JOIN = 1,
+    INPUT = 2,
+    WATCH = 3
+};
+
+enum class ServerMessage : uint8_t {
+    WELCOME = 1,
+    KEYFRAME = 2,
+    DELTA = 3
+};
+
+const size_t CLIENT_JOIN_SIZE = 1 + 8;
+const size_t CLIENT_INPUT_SIZE = 1 + 1;
+const size_t CLIENT_WATCH_SIZE = 1 + 4;
+const size_t SERVER_FRAME_HEADER_SIZE = 2 + 1;
+
+struct GameServerConfig {
+    int ticksPerSecond;       // Ticks de simulao por segundo em cada sesso
+    int threads;              // Event loops (0 = um por core)
+    int maxSessions;          // Ligaes (jogadores e espectadores); acima disto so recusadas
+    int maxTicksPerWake;      // Ticks recuperados de uma vez se um loop se atrasar
+    size_t maxPendingBytes;   // Bytes por enviar a partir dos quais se cortam deltas
+
+    GameServerConfig() : ticksPerSecond(60), threads(0), maxSessions(10000),
+        maxTicksPerWake(3), maxPendingBytes(16 * 1024) {}
+};
+
+// Totais de todos os loops
+struct GameServerStats {
+    long long sessions;        // Ligaes abertas agora
+    long long spectators;      // Das quais a ver a sesso de outro
+    long long accepted;        // Ligaes aceites desde o arranque
+    long long rejected;        // Recusadas por excesso de sesses
+    long long ticks;           // Ticks de sesso simulados
+    long long keyframes;       // Keyframes codificados
+    long long deltas;          // Deltas codificados (um por tick, partilhado)
+    long long framesSent;      // Frames postos em fila nas ligaes
+    long long resyncs;         // Keyframes extra para ligaes novas ou atrasadas
+    long long droppedFrames;   // Frames no enviados a ligaes lentas
+    long long lateTicks;       // Ticks descartados por atraso do loop
+    long long bytesSent;
+    double maxTickMs;          // Pior tempo de um tick de todas as sesses de um loop
+
+    GameServerStats() : sessions(0), spectators(0), accepted(0), rejected(0), ticks(0),
+        keyframes(0), deltas(0), framesSent(0), resyncs(0), droppedFrames(0), lateTicks(0),
+        bytesSent(0), maxTickMs(0) {}
+};
+
+class GameServer {
+public:
+    explicit GameServer(const GameServerConfig& config = GameServerConfig());
+    ~GameServer();
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // Lanam std::runtime_error se no for possvel escutar
+    void listenTcp(int port);
+    void listenUnix(const std::string& path);
+
+    void run();    // Corre os loops at stop()
+    void stop();   // Pode ser chamado de outra thread ou de um signal handler
+
+    GameServerStats getStats() const;   // Seguro a partir de outra thread
+    int getThreadCount() const { return static_cast<int>(loops.size()); }
+
+private:
+    class EventLoop;
+
+    GameServerConfig config;
+    std::vector<std::unique_ptr<EventLoop>> loops;
+    std::vector<std::thread> threads;
+    int tcpPort;                 // 0 = sem TCP
+    int unixListener;            // Partilhado pelos loops (EPOLLEXCLUSIVE)
+    std::string unixPath;
+    std::atomic<bool> running;
+};
+
+#endif
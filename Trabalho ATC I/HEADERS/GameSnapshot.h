@@ -0,0 +1,87 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+// Estado completo da simulao num bloco binrio de tamanho fixo.
+// S tipos de largura fixa, campos ordenados do maior para o menor e
+// tamanho total mltiplo de 8 (seno, com um campo de enchimento explcito),
+// para no haver padding: guardar e repor  um memcpy, sem alocaes, e
+// nenhum byte fica por inicializar.
+// Usado para save games, rollback em rede e bots que clonam o estado.
+
+// Estado do Pacman
+struct PacmanSnapshot {
+    int16_t x, y;
+    int16_t powerTimer;
+    int8_t directionX, directionY;
+    uint8_t powered;
+    uint8_t speed;
+    int8_t pendingDirectionX, pendingDirectionY;  // Pr-viragem
+    uint8_t pendingTicks;
+    uint8_t turnBufferTicks;
+};
+
+// Estado de um fantasma
+struct GhostSnapshot {
+    int16_t x, y;
+    int16_t stateTimer; // Ticks at sair de VULNERABLE ou WAITING (0 = nenhum)
+    uint8_t state;      // GhostState
+    uint8_t active;
+    uint8_t speed;
+    int8_t directionX, directionY;  // S usados se controlled
+    uint8_t controlled; // Controlado por um jogador (modo versus)
+};
+
+struct GameSnapshot {
+    static const uint32_t VERSION = 5;
+    static const int MAX_CELLS = 31 * 28;               // Tabuleiro padro
+    static const int PLANE_BYTES = (MAX_CELLS + 7) / 8; // Um bit por casa
+    static const int MAX_GHOSTS = 4;
+
+    // Cabealho
+    uint32_t version;
+    uint32_t tickCount;
+
+    // Gerador aleatrio
+    uint64_t seed;
+    uint64_t rngState;
+    uint64_t rngDraws;
+
+    // Jogo
+    int32_t score;
+    int16_t lives;
+    int16_t level;
+    int16_t transitionTimer;
+    uint8_t state;          // GameState
+    uint8_t isGameOver;
+
+    // Entidades
+    PacmanSnapshot pacman;
+    GhostSnapshot ghosts[MAX_GHOSTS];
+
+    // Tabuleiro: planos de bits indexados por y * largura + x
+    int16_t remainingPellets;
+    uint8_t ghostCount;
+    uint8_t reserved;
+    uint8_t pelletPlane[PLANE_BYTES];
+    uint8_t powerPelletPlane[PLANE_BYTES];
+};
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value,
+    "GameSnapshot tem de ser copivel com memcpy");
+static_assert(sizeof(PacmanSnapshot) == 14 && sizeof(GhostSnapshot) == 12 &&
+    sizeof(GameSnapshot) == 328,
+    "Layout dos snapshots mudou: aumente GameSnapshot::VERSION");
+static_assert(offsetof(GameSnapshot, powerPelletPlane) + GameSnapshot::PLANE_BYTES == sizeof(GameSnapshot),
+    "GameSnapshot com padding implcito no fim: acrescente um campo de enchimento");
+
+// Save games: gravao e leitura do bloco em disco.
+// Lanam std::runtime_error em caso de erro de I/O ou verso diferente.
+void writeSnapshotFile(const std::string& path, const GameSnapshot& snapshot);
+void readSnapshotFile(const std::string& path, GameSnapshot& snapshot);
+
+#endif
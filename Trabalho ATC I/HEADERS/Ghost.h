@@ -2,7 +2,9 @@
 #define GHOST_H
 
 #include "board.h"
-#include <curses.h>
+#include "entity_world.h"
+#include "game_random.h"
+#include "game_snapshot.h"
 
 enum class GhostState {
     NORMAL,         // Estado normal - perseguindo o Pacman
@@ -18,53 +20,71 @@ enum class GhostType {
     CLYDE    // Laranja - alterna entre perseguir e fugir
 };
 
+// Cada fantasma  uma entidade do EntityWorld: posio, velocidade (e a
+// direo do jogador no modo versus), aparncia, coliso, o controlador e o
+// timer de sada da casa so componentes. Aqui fica o comportamento.
+// Trivialmente destrutvel (vive num EntityPool): quem o cria destri a
+// entidade com o mundo.
 class Ghost {
 private:
-    int x, y;                  // Posio atual
+    EntityWorld* world;
+    EntityHandle entity;
     int spawnX, spawnY;        // Posio inicial/respawn
-    int speed;                 // Velocidade de movimento
     GhostState state;          // Estado atual
     GhostType type;           // Tipo do fantasma
-    int vulnerableTimer;       // Tempo restante de vulnerabilidade
     bool isActive;             // Se est em jogo
-    chtype ghostChar;          // Caractere para desenhar
-    int colorPair;             // Par de cores do PDCurses
 
 public:
-    // Construtor
-    Ghost(int startX, int startY, GhostType ghostType);
+    // Construtor: cria a entidade; index identifica o fantasma no AIController
+    Ghost(EntityWorld& entityWorld, int index, int startX, int startY, GhostType ghostType);
 
-    // Movimentao
-    void move(int pacmanX, int pacmanY, Board& board);
+    // Movimentao: uma casa; o Game chama move() speed vezes por tick
+    void move(int pacmanX, int pacmanY, Board& board, GameRandom& rng);
     void returnToSpawn();
 
+    // Modo versus: o jogador escolhe a direo em vez da IA
+    void setPlayerControlled(bool controlled);
+    bool isPlayerControlled() const { return world->getAI(entity).playerControlled != 0; }
+    void changeDirection(int dx, int dy);
+
     // Estados
     void makeVulnerable();
     void recover();
     bool isVulnerable() const;
 
-    // Respawn
+    // Respawn: fica na casa (WAITING) at o Game a libertar
     void respawn();
+    void release();
 
-    // Visualizao
-    void draw();
+    // Visualizao: letra e cor do Renderable conforme o tipo e o estado
     void updateDisplay();
 
     // Getters
-    int getX() const { return x; }
-    int getY() const { return y; }
+    EntityHandle getEntity() const { return entity; }
+    int getX() const { return world->getPosition(entity).x; }
+    int getY() const { return world->getPosition(entity).y; }
     GhostState getState() const { return state; }
     bool getIsActive() const { return isActive; }
+    int getSpeed() const { return world->getVelocity(entity).speed; }
 
     // Setters
     void setState(GhostState newState);
     void setPosition(int newX, int newY);
+    void setSpeed(int speed);       // Casas por tick (LevelConfig)
+
+    // Hash Zobrist da posio e do estado: O(1), calculado a pedido
+    uint64_t getHash() const;
+
+    // Snapshots (sem alocaes)
+    void saveState(GhostSnapshot& out) const;
+    void restoreState(const GhostSnapshot& in);
 
 private:
     //  movimento 
     void moveNormal(int pacmanX, int pacmanY, Board& board);
-    void moveVulnerable(int pacmanX, int pacmanY, Board& board);
+    void moveVulnerable(int pacmanX, int pacmanY, Board& board, GameRandom& rng);
     void moveReturning(Board& board);
+    void movePlayer(Board& board);
 
     void moveBlinky(int pacmanX, int pacmanY, Board& board);
     void movePinky(int pacmanX, int pacmanY, Board& board);
@@ -72,6 +92,7 @@ private:
     void moveClyde(int pacmanX, int pacmanY, Board& board);
 
     bool canMoveTo(int newX, int newY, Board& board);
+    void moveTo(int newX, int newY);
     void calculateNextMove(int targetX, int targetY, Board& board, int& nextX, int& nextY);
 };
 
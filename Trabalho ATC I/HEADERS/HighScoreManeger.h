@@ -35,7 +35,13 @@ private:
     // Permite manter as pontuaes mesmo depois de fechar o jogo
     const std::string HIGHSCORE_FILE = "highscores.txt";
 
+    // O ficheiro s  lido quando as pontuaes so usadas: um servidor com
+    // milhares de Game no toca no disco ao criar cada um
+    bool loaded;
+
 public:
+    static const size_t MAX_SCORES = 10;   // Pontuaes guardadas
+
     // Construtor padro
     // Pode ser usado para inicializar qualquer recurso necessrio
     HighScoreManager();
@@ -44,8 +50,9 @@ public:
     void addScore(const std::string& playerName, int score);
 
     // Obtm as melhores pontuaes
-    // @return Lista das melhores pontuaes (padro: top 10)
-    std::list<ScoreEntry> getTopScores(size_t count = 10);
+    // @return A prpria lista, j ordenada e com no mximo MAX_SCORES
+    //         entradas: desenhar as pontuaes no copia nada
+    const std::list<ScoreEntry>& getTopScores();
 
     // Salva as pontuaes em um arquivo
     // Permite preservar o histrico de pontuaes
@@ -62,7 +69,10 @@ private:
 
     // Limita o nmero mximo de pontuaes armazenadas
     // Evita que a lista cresa indefinidamente
-    void limitScores(size_t maxScores = 10);
+    void limitScores(size_t maxScores = MAX_SCORES);
+
+    // Carrega o ficheiro na primeira utilizao
+    void ensureLoaded();
 };
 
 #endif
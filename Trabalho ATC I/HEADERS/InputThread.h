@@ -0,0 +1,89 @@
+#ifndef INPUT_THREAD_H
+#define INPUT_THREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// Leitura do teclado numa thread prpria. Cada tecla  lida do terminal
+// assim que chega, marcada com a hora de chegada e posta numa fila SPSC
+// sem locks; o GameLoop esvazia a fila no incio de cada tick, por isso
+// uma tecla  aplicada no primeiro tick depois de chegar, sem esperar
+// que o loop volte a chamar o getch().
+//
+// A thread l os bytes do fd diretamente (o curses no  thread-safe) e
+// traduz as sequncias das setas para os mesmos KEY_* do getch().
+
+struct InputEvent {
+    int key;                                       // Como o getch() devolveria
+    std::chrono::steady_clock::time_point arrived; // Quando a thread a leu
+};
+
+// Fila de um produtor (thread de entrada) e um consumidor (simulao)
+class InputRing {
+public:
+    static const size_t CAPACITY = 256;   // Potncia de 2
+
+    InputRing() : head(0), tail(0) {}
+
+    bool push(const InputEvent& event);   // false se estiver cheia
+    bool pop(InputEvent& event);          // false se estiver vazia
+
+private:
+    InputEvent events[CAPACITY];
+    // Em linhas de cache diferentes: cada lado s escreve a sua
+    alignas(64) std::atomic<size_t> head;  // Prximo a ler (consumidor)
+    alignas(64) std::atomic<size_t> tail;  // Prximo a escrever (produtor)
+};
+
+// Histograma da latncia entre a chegada da tecla e o tick que a aplicou
+struct InputLatencyHistogram {
+    static const int BUCKETS = 10;
+    static const double BUCKET_LIMITS_MS[BUCKETS];  // Limite superior de cada balde
+
+    long long counts[BUCKETS];
+    long long keys;
+    double meanMs;
+    double maxMs;
+
+    InputLatencyHistogram() : counts(), keys(0), meanMs(0), maxMs(0) {}
+
+    void record(double latencyMs);
+    double percentile(double fraction) const;  // Limite do balde que o contm
+};
+
+class InputThread {
+public:
+    explicit InputThread(int fd = 0);
+    ~InputThread();
+
+    void start();   // Lana std::runtime_error se no conseguir
+    void stop();
+
+    bool pop(InputEvent& event) { return ring.pop(event); }
+    long long getDroppedKeys() const { return droppedKeys.load(std::memory_order_relaxed); }
+
+private:
+    // Tempo de espera pelo resto de uma sequncia depois de um ESC
+    static const int ESCAPE_TIMEOUT_MS = 25;
+
+    int fd;
+    int wakeFd;                       // eventfd para acordar a thread no stop()
+    std::thread thread;
+    InputRing ring;
+    std::atomic<long long> droppedKeys;
+
+    // Descodificao de sequncias de escape (s usado pela thread)
+    unsigned char pending[16];
+    int pendingLength;
+    std::chrono::steady_clock::time_point pendingArrived;  // Chegada do ESC
+
+    void run();
+    void decode(const unsigned char* bytes, int count, std::chrono::steady_clock::time_point arrived);
+    void flushPending();   // Entrega a sequncia incompleta como teclas soltas
+    void emit(int key, std::chrono::steady_clock::time_point arrived);
+};
+
+#endif
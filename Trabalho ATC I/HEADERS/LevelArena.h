@@ -0,0 +1,61 @@
+#ifndef LEVEL_ARENA_H
+#define LEVEL_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Arena monotnica de um nvel. Um s bloco  reservado no construtor;
+// cada create() s avana um ponteiro e reset() liberta tudo de uma vez,
+// sem um delete por objeto. O Game cria nela o que s vive durante um
+// nvel (fantasmas, buffers de trabalho) e faz reset() ao recomear o nvel.
+//
+// S aceita tipos trivialmente destrutveis: o reset() no chama destrutores.
+// Os ponteiros devolvidos deixam de ser vlidos no reset() seguinte.
+class LevelArena {
+public:
+    static const size_t DEFAULT_CAPACITY = 16 * 1024;
+
+    explicit LevelArena(size_t capacity = DEFAULT_CAPACITY);
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+
+    // Lana std::runtime_error se a arena esgotar (a capacidade  fixa)
+    void* allocate(size_t bytes, size_t alignment);
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+            "LevelArena::reset() no chama destrutores");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // count elementos inicializados com T()
+    template <typename T>
+    T* createArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+            "LevelArena::reset() no chama destrutores");
+        T* items = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; i++) new (items + i) T();
+        return items;
+    }
+
+    void reset();   // Liberta tudo: O(1)
+
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return used; }
+    size_t getHighWater() const { return highWater; }   // Maior uso entre resets
+    uint64_t getResets() const { return resets; }
+
+private:
+    std::unique_ptr<unsigned char[]> memory;
+    size_t capacity;
+    size_t used;
+    size_t highWater;
+    uint64_t resets;
+};
+
+#endif
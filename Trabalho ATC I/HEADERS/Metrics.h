@@ -0,0 +1,86 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// Mtricas de operao em formato de texto do Prometheus.
+//
+// Cada thread escreve num bloco prprio (alinhado  linha de cache) criado
+// na primeira utilizao: s essa thread escreve nele, com load + store
+// relaxed, por isso o caminho quente nunca toca numa linha partilhada nem
+// usa instrues com lock. Os blocos s so somados no scrape.
+//
+// Os gauges so tambm somas de deltas por thread (+1 ao abrir, -1 ao
+// fechar), para poderem ser mexidos por qualquer thread sem partilha.
+
+enum class MetricCounter : uint8_t {
+    TICKS,              // Ticks de simulao (ritmo = rate() no Prometheus)
+    GAMES_COMPLETED,    // Jogos que chegaram ao fim
+    HIGHSCORE_WRITES,   // Gravaes do ficheiro de pontuaes
+    PELLETS_EATEN,      // Eventos de jogo (um por GameEventType)
+    POWER_PELLETS_EATEN,
+    GHOSTS_EATEN,
+    LIVES_LOST,
+    LEVELS_COMPLETED,
+    COUNT
+};
+
+enum class MetricGauge : uint8_t {
+    ACTIVE_SESSIONS,    // Ligaes abertas no servidor
+    SPECTATORS,         // Das quais espectadores
+    QUEUED_FRAMES,      // Frames nas filas de sada das ligaes
+    QUEUED_BYTES,       // Bytes por enviar nessas filas
+    COUNT
+};
+
+enum class MetricHistogram : uint8_t {
+    TICK_SECONDS,       // Durao de um tick (no servidor: todas as sesses de um loop)
+    FRAME_BYTES,        // Bytes por frame enviado (terminal ou rede)
+    GAME_LEVEL,         // Nvel em que cada jogo acabou
+    COUNT
+};
+
+class Metrics {
+public:
+    static const int MAX_BUCKETS = 12;   // Sem contar o +Inf
+
+    static void add(MetricCounter counter, uint64_t amount = 1);
+    static void addGauge(MetricGauge gauge, int64_t delta);
+    static void observe(MetricHistogram histogram, double value);
+
+    static std::string scrape();   // Soma todos os blocos e formata
+
+    // Escreve num ficheiro temporrio e renomeia (o textfile collector nunca
+    // l um ficheiro a meio); devolve false em caso de erro
+    static bool writeTextFile(const std::string& path);
+};
+
+// Exporta as mtricas por HTTP (GET /metrics, s em 127.0.0.1) e/ou
+// reescrevendo um ficheiro de tempos a tempos, numa thread prpria
+class MetricsExporter {
+public:
+    MetricsExporter();
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // port 0 = sem HTTP; textFile vazio = sem ficheiro.
+    // Lana std::runtime_error se no conseguir escutar.
+    void start(int port, const std::string& textFile, int intervalSeconds = 5);
+    void stop();   // Reescreve o ficheiro uma ltima vez
+
+private:
+    int listenFd;
+    int wakeFd;
+    std::string textFile;
+    int intervalSeconds;
+    std::thread thread;
+
+    void run();
+    void serve(int client);
+};
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "game_loop.h"
+#include "game_snapshot.h"
+#include <sys/socket.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+// Modo versus em rede com rollback: um jogador  o Pac-Man, o outro controla
+// um fantasma. Cada lado simula o jogo inteiro. A entrada local  aplicada
+// logo no prprio tick; a do outro jogador  prevista (repete a ltima que
+// chegou) e, se chegar diferente, o jogo volta ao snapshot desse tick e
+// re-simula at ao presente. Com 100 ms de RTT a 10 ticks/s isso costuma ser
+// um ou dois ticks re-simulados, e quem joga sente s a latncia local.
+//
+// Datagramas (little-endian), prefixo "PV" | tipo (u8):
+//   HELLO/WELCOME: papel (u8) | seed (u64)          -> combinar a partida
+//   INPUT:  n de entradas (u8) | primeiro tick (u32) |
+//           entradas do peer j recebidas (u32) |
+//           tick do checksum (u32) | checksum (u32) | entradas (u8 cada)
+//   BYE:    o outro jogador saiu
+// Cada INPUT repete todas as entradas que o peer ainda no confirmou, por
+// isso um datagrama perdido no precisa de retransmisso.
+
+enum class VersusRole {
+    PACMAN,  // Controla o Pac-Man e escolhe a seed
+    GHOST    // Controla o Blinky
+};
+
+// Socket de datagramas no bloqueante (UDP ou Unix) ligado a um nico peer
+class NetSocket {
+public:
+    typedef std::chrono::steady_clock Clock;
+    static const size_t MAX_PACKET = 512;
+
+    NetSocket();
+    ~NetSocket();
+    NetSocket(const NetSocket&) = delete;
+    NetSocket& operator=(const NetSocket&) = delete;
+
+    // Lanam std::runtime_error se o socket no puder ser criado
+    void openUdp(int localPort, const std::string& remoteHost, int remotePort);
+    void openUnix(const std::string& localPath, const std::string& remotePath);
+    void close();
+
+    void send(const uint8_t* data, size_t size);
+    size_t receive(uint8_t* data, size_t capacity);   // 0 se no h datagramas
+
+    // Atraso artificial em cada envio, para testar latncia em loopback
+    void setSimulatedLatency(int milliseconds);
+
+private:
+    static const size_t DELAY_SLOTS = 64;
+
+    struct DelayedPacket {
+        Clock::time_point due;
+        size_t size;
+        uint8_t data[MAX_PACKET];
+    };
+
+    int fd;
+    sockaddr_storage remoteAddress;
+    socklen_t remoteLength;
+    std::string boundPath;                 // Socket Unix a apagar em close()
+
+    Clock::duration latency;
+    std::vector<DelayedPacket> delayed;    // Fila circular, alocada uma vez
+    size_t delayedHead;
+    size_t delayedCount;
+
+    void sendNow(const uint8_t* data, size_t size);
+    void flushDelayed();
+};
+
+// Estatsticas da sesso
+struct RollbackStats {
+    long long ticks;              // Ticks avanados
+    long long stalls;             // Ticks perdidos  espera do peer
+    long long rollbacks;          // Previses erradas corrigidas
+    long long resimulatedTicks;   // Ticks simulados de novo
+    int maxRollbackDepth;         // Maior re-simulao de uma vez
+    double maxResimulationMs;     // Tempo dessa re-simulao no pior caso
+    long long packetsSent;
+    long long packetsReceived;
+    long long desyncs;            // Checksums diferentes dos do peer
+    uint32_t firstDesyncTick;
+
+    RollbackStats() : ticks(0), stalls(0), rollbacks(0), resimulatedTicks(0),
+        maxRollbackDepth(0), maxResimulationMs(0), packetsSent(0), packetsReceived(0),
+        desyncs(0), firstDesyncTick(0) {}
+};
+
+// Faz avanar o Game no GameLoop em vez de Game::updateGameState
+class RollbackSession : public TickDriver {
+public:
+    typedef std::chrono::steady_clock Clock;
+    static const int MAX_ROLLBACK = 16;
+    static const int DEFAULT_ROLLBACK = 8;
+
+    RollbackSession(Game& game, NetSocket& socket, VersusRole role,
+        int maxRollback = DEFAULT_ROLLBACK);
+
+    // Combina a seed com o peer (o Pac-Man decide) e comea a partida.
+    // Lana std::runtime_error se o peer no responder a tempo.
+    void connect(uint64_t seed, int timeoutMs = 30000);
+
+    void handleInput(int input) override;
+    void tick() override;
+
+    // Simula o prximo tick; false se teve de esperar pelo peer
+    bool advance();
+
+    uint32_t getFrame() const { return frame; }
+    const RollbackStats& getStats() const { return stats; }
+
+private:
+    static const int INPUT_WINDOW = 64;             // > 2 * MAX_ROLLBACK
+    static const int SNAPSHOTS = MAX_ROLLBACK + 1;
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    Game& game;
+    NetSocket& socket;
+    VersusRole role;
+    int maxRollback;
+    uint64_t sessionSeed;
+
+    uint32_t frame;               // Prximo tick a simular
+    uint8_t localInput;           // Direo atual do jogador local
+    uint8_t localInputs[INPUT_WINDOW];
+    uint8_t remoteInputs[INPUT_WINDOW];   // Entradas do peer confirmadas
+    uint8_t usedRemote[INPUT_WINDOW];     // O que foi usado na simulao
+    uint32_t remoteConfirmed;     // Entradas do peer recebidas, sem buracos
+    uint32_t remoteFrame;         // Tick em que o peer ia
+    uint32_t remoteAck;           // Entradas locais que o peer j tem
+    uint32_t firstMispredicted;   // Tick mais antigo a re-simular (NONE = nenhum)
+    uint32_t pendingHashTick;     // Checksum do peer ainda por conferir
+    uint32_t pendingHash;
+
+    GameSnapshot snapshots[SNAPSHOTS];    // Estado no incio de cada tick recente
+    uint8_t incoming[NetSocket::MAX_PACKET];
+    uint8_t outgoing[NetSocket::MAX_PACKET];
+    RollbackStats stats;
+
+    void poll();
+    void readPacket(size_t size);
+    void sendHello(uint8_t type);
+    void sendInputs();
+    void sendBye();
+    void rollback();
+    void simulate(uint32_t tick);
+    void checkDesync();
+    uint8_t predictRemote() const;
+};
+
+#endif
@@ -1,55 +1,66 @@
 #ifndef PACMAN_H
 #define PACMAN_H
 
-#include "game_object.h"
 #include "board.h"
-#include <curses.h>
+#include "entity_world.h"
+#include "game_snapshot.h"
 
-class Pacman : public GameObject {
+// O Pacman  uma entidade do EntityWorld (posio, direo e velocidade,
+// desenho e coliso ficam nos componentes); aqui fica o que  s dele.
+class Pacman {
 private:
-    // Direo atual do movimento
-    int direction_x;  // -1 (esquerda), 0 (parado) ou 1 (direita)
-    int direction_y;  // -1 (cima), 0 (parado) ou 1 (baixo)
+    EntityWorld* world;
+    EntityHandle entity;
+
+    // Viragem pedida antes de ser possvel: fica pendente durante
+    // turnBufferTicks ticks e  aplicada na primeira casa onde for legal
+    int pendingDirectionX;
+    int pendingDirectionY;
+    int pendingTicks;     // Ticks que ainda restam ao pedido (0 = nenhum)
+    int turnBufferTicks;  // 0 = a direo muda logo, mesmo contra a parede
 
     // Posio do spawn (onde o Pacman comea/renasce)
     int spawn_x;
     int spawn_y;
 
-    // Status do jogador
-    int lives;        // Nmero de vidas
-    int score;        // Pontuao
-    bool isPowered;   // Se est com power pellet ativo
-    int powerTimer;   // Tempo restante do power pellet
-    
-
-    // Caractere para desenhar o Pacman
-    chtype pacmanChar;
+    // Status do jogador (vidas e pontos so do Game)
+    bool isPowered;   // Se est com power pellet ativo (o fim  um timer do Game)
 
 public:
-    // Construtor - cria o Pacman na posio inicial
-    Pacman(int startX, int startY);
+    // Construtor - cria a entidade do Pacman na posio inicial
+    Pacman(EntityWorld& entityWorld, int startX, int startY);
+    ~Pacman();
+    Pacman(const Pacman&) = delete;
+    Pacman& operator=(const Pacman&) = delete;
 
     // Movimento e controle
-    void move(Board& board);
+    void move(Board& board);           // Um tick: getSpeed() passos de uma casa
+    bool step(const Board& board);     // Uma casa; false se bateu na parede
+    void endMove();                    // Fim do tick: gasta um tick da pr-viragem
     void changeDirection(int dx, int dy);
-    bool canwalk(int newX, int newY, const Board& board);
+    void setTurnBuffer(int ticks);     // Janela de pr-viragem (LevelConfig)
+    void setSpeed(int speed);          // Casas por tick (LevelConfig)
+    void applyBufferedTurn(const Board& board);  // No incio de cada step()
 
-    // Aes do jogador
-    void collectPellet(int points);    // Coleta pellet normal
-    void collectPowerPellet();         // Coleta power pellet
-    void loseLife();                   // Perde uma vida
+    // Aes do jogador (pellets, pontos e vidas so do Game: ver GameEvent)
     void respawn();                    // Volta ao ponto inicial
 
     // Status e poderes
     bool isPowerPelletActive() const;  // Verifica se est com poder
-    void updatePowerState();           // Atualiza estado do poder
+    void setPowered(bool powered);     // O Game liga e desliga o poder
+
+    // Hash Zobrist da posio e do estado: O(1), calculado a pedido
+    uint64_t getHash() const;
 
-    // Visualizao
-    void draw();                       // Desenha o Pacman
+    // Snapshots (sem alocaes)
+    void saveState(PacmanSnapshot& out) const;
+    void restoreState(const PacmanSnapshot& in);
 
     // Getters - funes para obter informaes
-    int getLives() const;
-    int getScore() const;
+    EntityHandle getEntity() const { return entity; }
+    int getX() const;
+    int getY() const;
+    int getSpeed() const;
     int getDirectionX() const;
     int getDirectionY() const;
 };
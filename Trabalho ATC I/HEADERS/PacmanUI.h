@@ -4,11 +4,13 @@
 #include <curses.h>
 #include <string>
 #include <vector>
+#include <memory>
 #include "pacman.h"
 #include "ghost.h"
 #include "board.h"
 #include "game_menu.h"
 #include "highscore_manager.h"
+#include "frame_renderer.h"
 
 class PacmanUI {
 public:
@@ -30,10 +32,9 @@ public:
     static void initializeUI();
     static void cleanupUI();
 
-    // Desenho dos elementos do jogo
-    static void drawGame(const Board& board, const Pacman& pacman,
-        const std::vector<std::shared_ptr<Ghost>>& ghosts,
-        int level, bool isPaused);
+    // Desenho do tabuleiro no frame (s as diferenas chegam ao terminal).
+    // Pac-Man e fantasmas so desenhados pelo Game, a partir do EntityWorld.
+    static void drawBoard(FrameRenderer& screen, const Board& board);
 
     // Animaes e efeitos visuais
    /* static void playDeathAnimation(int x, int y);
@@ -41,28 +42,13 @@ public:
     static void showPointsCollected(int x, int y, int points);
     static void showLevelComplete(int level, int score);*/
 
-    // Menus e telas especiais
- 
-    static void showGameOver(int finalScore);
-    static void showPauseScreen();
-    static void showVictoryScreen(int finalScore);
+    // Menus, HUD e telas especiais so desenhados pelo Game no FrameRenderer
 
     // Mtodos de utilidade
-    static void refreshUI();
     static void clearScreen();
     static int getInput();
 
 private:
-    // Mtodos de desenho interno
-    static void drawBoard(const Board& board);
-    static void drawPacman(const Pacman& pacman);
-    static void drawGhost(const Ghost& ghost);
-    static void drawScore(int score);
-    static void drawLives(int lives);
-    static void drawLevel(int level);
-    static void drawPowerPelletTimer(int timeLeft);
-    static void drawStatusBar(const Pacman& pacman, int level);
-
     //// Animaes
     //static const std::vector<std::string> DEATH_ANIMATION;
     //static const std::vector<std::string> VICTORY_ANIMATION;
@@ -0,0 +1,120 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "game.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Formato do ficheiro de replay (.pmr), todo em varints little-endian:
+//
+//   cabealho: "PMRP" | verso (u8) | mazeId | seed (u64 fixo) |
+//              n de nveis | por nvel: ghostSpeed, pacmanSpeed,
+//              powerPelletDuration, bonusPoints,
+//              turnBufferTicks (desde a verso 3) |
+//              intervalo de checksums (desde a verso 2)
+//   eventos:   (ticksDesdeOEventoAnterior << 3 | cdigo) [+ tecla se RAW]
+//              [+ 32 bits baixos do hash do estado se CHECKSUM]
+//   fim:       evento END (ticks at ao fim) | score | vidas | nvel
+//
+// Cada mudana de direo custa em regra 1 ou 2 bytes e um checksum 5,
+// por isso uma partida fica em poucos bytes por segundo.
+
+enum class ReplayCode : uint8_t {
+    UP = 0,
+    DOWN = 1,
+    LEFT = 2,
+    RIGHT = 3,
+    PAUSE = 4,
+    RAW = 5,    // Outra tecla: o cdigo curses segue num varint
+    CHECKSUM = 6, // Hash do estado no fim do tick (u32 fixo)
+    END = 7     // Fim da sesso
+};
+
+// Cabealho: tudo o que  preciso para recriar a partida
+struct ReplayHeader {
+    int mazeId;
+    uint64_t seed;
+    std::vector<Game::LevelConfig> levelConfigs;
+    uint32_t checksumInterval;   // 0 = sem checksums (ficheiros da verso 1)
+
+    ReplayHeader() : mazeId(0), seed(0), checksumInterval(0) {}
+};
+
+// Resultado final da sesso, gravado no fim do ficheiro
+struct ReplaySummary {
+    uint32_t totalTicks;
+    int score;
+    int lives;
+    int level;
+
+    ReplaySummary() : totalTicks(0), score(0), lives(0), level(0) {}
+};
+
+// Resultado da reproduo headless
+struct ReplayResult {
+    ReplaySummary summary;     // Estado a que a simulao chegou
+    bool matchesRecording;     // Igual ao resumo gravado e sem divergncias?
+    int checksumsVerified;     // Checksums conferidos
+    uint32_t divergedAtTick;   // Primeiro tick com checksum diferente (0 = nenhum)
+    double elapsedMs;          // Tempo real gasto a reproduzir
+
+    ReplayResult() : matchesRecording(false), checksumsVerified(0), divergedAtTick(0), elapsedMs(0) {}
+};
+
+// Grava as entradas de uma sesso. O Game chama beginSession() em
+// startGame(), recordInput() em handleInput() e endSession() no fim.
+class ReplayRecorder {
+public:
+    static const uint32_t DEFAULT_CHECKSUM_INTERVAL = 50;  // 5 s a 10 ticks/s
+    static const size_t INITIAL_CAPACITY = 64 * 1024;      // Horas de teclas e checksums
+
+    // checksumInterval = 1 localiza uma divergncia no tick exato
+    explicit ReplayRecorder(const std::string& filePath,
+        uint32_t checksumInterval = DEFAULT_CHECKSUM_INTERVAL);
+
+    void beginSession(uint64_t seed, int mazeId, const std::vector<Game::LevelConfig>& configs);
+    void recordInput(uint32_t tick, int key);
+    void recordChecksum(uint32_t tick, uint64_t hash);   // Grava s a cada checksumInterval ticks
+    void endSession(uint32_t tick, int score, int lives, int level); // Escreve o ficheiro
+
+    bool isRecording() const { return recording; }
+    size_t getByteCount() const { return buffer.size(); }
+
+private:
+    std::string path;
+    uint32_t checksumInterval;
+    std::vector<uint8_t> buffer;  // Sesso em memria at endSession(); reservada no incio
+    uint32_t lastTick;            // Tick do ltimo evento gravado
+    bool recording;
+
+    void writeEvent(uint32_t tick, ReplayCode code);
+    void writeVarint(uint64_t value);
+};
+
+// L um replay e reproduz a partida sem interface, sem limite de velocidade,
+// passando as teclas por Game::handleInput.
+class ReplayPlayer {
+public:
+    ReplayPlayer() : eventsStart(0) {}
+
+    void load(const std::string& filePath);  // Lana std::runtime_error se invlido
+    ReplayResult play(Game& game) const;
+
+    const ReplayHeader& getHeader() const { return header; }
+    const ReplaySummary& getRecordedSummary() const { return recorded; }
+
+private:
+    ReplayHeader header;
+    ReplaySummary recorded;
+    std::vector<uint8_t> data;  // Ficheiro completo
+    size_t eventsStart;         // Onde comeam os eventos
+
+    static uint64_t readVarint(const std::vector<uint8_t>& bytes, size_t& pos);
+};
+
+// Converso entre teclas curses e cdigos do replay
+ReplayCode replayCodeForKey(int key);
+int replayKeyForCode(ReplayCode code);
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef REPLAY_STREAM_H
+#define REPLAY_STREAM_H
+
+#include "game_snapshot.h"
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+// Stream de estado (.pms): keyframes peridicos + deltas por tick + ndice.
+//
+//   cabealho: "PMRS" | verso (u8) | intervalo entre keyframes (varint)
+//   registos:  0x80 + GameSnapshot em bruto          -> keyframe
+//              flags (< 0x80) + seces presentes    -> delta de um tick
+//              0xFF                                  -> fim dos registos
+//   ndice:    n de entradas (varint) | (frame u32, offset u64) por keyframe
+//   trailer:   offset do ndice (u64) | ltimo frame (u32) | "PMRI"
+//
+// Um "frame"  cada tick capturado, em sequncia a partir de 0. Para chegar
+// a qualquer frame basta ler o keyframe anterior e aplicar no mximo
+// keyframeInterval deltas, sem voltar a simular desde o incio.
+
+struct ReplayIndexEntry {
+    uint32_t frame;   // Frame do keyframe
+    uint64_t offset;  // Posio do registo no ficheiro
+};
+
+// Escreve o stream com buffer fixo: nenhuma alocao por tick
+class ReplayStreamWriter {
+public:
+    static const int DEFAULT_KEYFRAME_INTERVAL = 300;  // 30 s a 10 ticks/s
+
+    ReplayStreamWriter(const std::string& path, int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+    ~ReplayStreamWriter();
+
+    void captureTick(const Game& game);         // Chamado aps cada tick
+    void captureSnapshot(const GameSnapshot& snapshot);
+    void finish();                              // Escreve ndice e trailer e fecha
+
+    bool isOpen() const { return file != nullptr; }
+    uint32_t getFrameCount() const { return frameCount; }
+    uint64_t getBytesWritten() const { return fileOffset + used; }
+    size_t getKeyframeCount() const { return index.size(); }
+
+private:
+    static const size_t BUFFER_SIZE = 64 * 1024;
+    static const size_t MAX_RECORD_SIZE = 2 * 1024;   // Pior caso de um registo
+    static const size_t INDEX_CAPACITY = 4096;        // Keyframes antes de o ndice crescer (horas)
+
+    std::FILE* file;
+    uint8_t* buffer;          // Alocado uma vez no construtor
+    size_t used;
+    uint64_t fileOffset;      // Bytes j despejados para o ficheiro
+
+    int keyframeInterval;
+    uint32_t frameCount;
+    uint32_t framesSinceKeyframe;
+    bool hasPrevious;
+    GameSnapshot previous;    // Estado do tick anterior
+    GameSnapshot current;     // Estado do tick atual
+    std::vector<ReplayIndexEntry> index;  // Reservado: s cresce depois de INDEX_CAPACITY keyframes
+
+    bool needsKeyframe() const;
+    void writeKeyframe();
+    void writeDelta();
+    void ensureSpace(size_t bytes);
+    void flushBuffer();
+    void putByte(uint8_t value) { buffer[used++] = value; }
+    void putVarint(uint64_t value);
+    void putBytes(const void* bytes, size_t count);
+};
+
+// L um stream inteiro e reconstri o estado em qualquer frame
+class ReplayStreamReader {
+public:
+    ReplayStreamReader() : recordsStart(0), lastFrame(0), keyframeInterval(0) {}
+
+    void open(const std::string& path);   // Lana std::runtime_error se invlido
+
+    uint32_t getLastFrame() const { return lastFrame; }
+    int getKeyframeInterval() const { return keyframeInterval; }
+    const std::vector<ReplayIndexEntry>& getIndex() const { return index; }
+
+    // Estado no frame pedido: O(intervalo entre keyframes)
+    void seek(uint32_t frame, GameSnapshot& out) const;
+
+private:
+    std::vector<uint8_t> data;
+    std::vector<ReplayIndexEntry> index;
+    size_t recordsStart;
+    uint32_t lastFrame;
+    int keyframeInterval;
+
+    // Aplica o registo em pos a state; devolve false no fim dos registos
+    bool applyRecord(size_t& pos, GameSnapshot& state) const;
+    uint64_t readVarint(size_t& pos) const;
+};
+
+#endif
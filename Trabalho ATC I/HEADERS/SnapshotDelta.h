@@ -0,0 +1,50 @@
+#ifndef SNAPSHOT_DELTA_H
+#define SNAPSHOT_DELTA_H
+
+#include "game_snapshot.h"
+#include <cstddef>
+#include <cstdint>
+
+// Diferena compacta entre dois snapshots de ticks consecutivos, usada pelo
+// stream de replay (.pms) e pelas frames que o servidor envia aos clientes.
+//
+//   flags (u8) | movimentos | pellets | campos | gerador
+//
+//   movimentos: 3 bits por entidade num u16 (0 = parado/salto, 1..4 = uma casa)
+//   pellets:    n de mudanas | (casa * 2 + plano) em gaps crescentes
+//   campos:     n | (gap no ndice do campo, diferena em zigzag)
+//   gerador:    nmeros aleatrios gerados no tick
+//
+// As flags ficam sempre abaixo de 0x80, o que deixa livre o bit alto para
+// quem enquadra os deltas (ex.: marcador de keyframe no stream).
+
+// Maior delta possvel quando needsSnapshotKeyframe()  false
+const size_t SNAPSHOT_DELTA_MAX_SIZE = 1024;
+
+// Casas que podem ter mudado entre os dois snapshots (Game::getDirtyCells),
+// ordenadas. Com a lista, as funes abaixo s olham para essas casas em vez
+// de comparar os planos inteiros; o delta resultante  igual. count < 0 ou
+// cells nulo = lista desconhecida, compara tudo.
+struct SnapshotDirtyCells {
+    const uint16_t* cells;
+    int count;
+
+    SnapshotDirtyCells() : cells(nullptr), count(-1) {}
+    SnapshotDirtyCells(const uint16_t* cells, int count) : cells(cells), count(count) {}
+};
+
+// Um delta s descreve a passagem de um tick ao seguinte no mesmo jogo;
+// num novo jogo, restore ou reset do nvel  mais barato mandar um keyframe
+bool needsSnapshotKeyframe(const GameSnapshot& previous, const GameSnapshot& current,
+    const SnapshotDirtyCells& dirty = SnapshotDirtyCells());
+
+// Escreve o delta em out (pelo menos SNAPSHOT_DELTA_MAX_SIZE bytes livres)
+// e devolve o tamanho. No aloca.
+size_t encodeSnapshotDelta(const GameSnapshot& previous, const GameSnapshot& current, uint8_t* out,
+    const SnapshotDirtyCells& dirty = SnapshotDirtyCells());
+
+// Aplica o delta em data a state (que passa ao tick seguinte) e devolve os
+// bytes consumidos. Lana std::runtime_error se o delta for invlido.
+size_t applySnapshotDelta(const uint8_t* data, size_t size, GameSnapshot& state);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstdint>
+
+// Chaves Zobrist para o hash incremental do estado do jogo.
+// Cada (casa, tipo de casa), (entidade, posio) e (entidade, estado) tem
+// uma chave de 64 bits fixa, gerada de uma seed constante, por isso o hash
+//  igual em todos os processos e mquinas. Mudar uma casa custa dois XOR.
+class StateHash {
+public:
+    static const int BOARD_WIDTH = 31;
+    static const int MAX_CELLS = 31 * 28;
+    static const int TILE_TYPES = 6;     // Board::SquareType
+    static const int ENTITIES = 5;       // 0 = Pac-Man, 1..4 = fantasmas
+    static const int ENTITY_STATES = 16;
+
+    // Chave de uma casa com um dado tipo
+    static uint64_t tile(int x, int y, int squareType);
+    // Chave de uma entidade numa posio
+    static uint64_t position(int entity, int x, int y);
+    // Chave de uma entidade num estado (direo, GhostState, ...)
+    static uint64_t entityState(int entity, int state);
+    // Espalha um valor escalar (pontuao, timers, ...) por 64 bits
+    static uint64_t mix(uint64_t value);
+
+private:
+    struct Table {
+        uint64_t tiles[MAX_CELLS][TILE_TYPES];
+        uint64_t positions[ENTITIES][MAX_CELLS];
+        uint64_t states[ENTITIES][ENTITY_STATES];
+
+        Table();
+    };
+
+    static const Table& table();
+    static int cellIndex(int x, int y);
+};
+
+#endif
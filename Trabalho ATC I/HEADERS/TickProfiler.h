@@ -0,0 +1,115 @@
+#ifndef TICK_PROFILER_H
+#define TICK_PROFILER_H
+
+#include <cstdint>
+
+// Perfil por fase do tick, medido com o contador de ciclos do processador
+// (rdtsc: ~20 ciclos por leitura, sem chamadas ao sistema). Os tempos de
+// cada tick ficam num anel dos ltimos HISTORY ticks, de onde saem os
+// p50/p99 por fase mostrados no overlay (tecla T durante o jogo).
+//
+// A instrumentao s existe em builds com -DPACMAN_PROFILE: sem essa flag
+// PROFILE_PHASE no gera cdigo nenhum e o Game nem tem o membro do perfil.
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+enum class TickPhase : uint8_t {
+    INPUT,        // Game::handleInput
+    PACMAN,       // pacman->move
+    GHOSTS,       // updateGhosts
+    COLLISIONS,   // checkCollisions
+    VICTORY,      // checkVictoryCondition
+    RENDER,       // renderGame (composio + present)
+    COUNT
+};
+
+struct PhaseTiming {
+    double p50Us;
+    double p99Us;
+};
+
+struct ProfileSummary {
+    PhaseTiming phases[static_cast<int>(TickPhase::COUNT)];
+    PhaseTiming total;      // Soma das fases de cada tick
+    double budgetUsed;      // p99 do total / perodo do tick (1.0 = o tick todo)
+    int ticks;              // Ticks no anel
+};
+
+class TickProfiler {
+public:
+    static const int HISTORY = 256;   // Ticks guardados
+    static const int PHASES = static_cast<int>(TickPhase::COUNT);
+
+    TickProfiler();
+
+    static uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Um tick comea na primeira entrada ou no movimento do Pacman depois
+    // do tick anterior; o render que se segue conta para o mesmo tick
+    void beginPhase(TickPhase phase) {
+        if ((phase == TickPhase::INPUT || phase == TickPhase::PACMAN) && currentHasTick) {
+            commitTick();
+        }
+        if (phase == TickPhase::PACMAN) currentHasTick = true;
+    }
+    void addCycles(TickPhase phase, uint64_t cycles) {
+        rows[current][static_cast<int>(phase)] += cycles;
+    }
+
+    void reset();   // Esquece os ticks anteriores (ex.: nova partida)
+    void setTickRate(int ticksPerSecond) { tickPeriodUs = ticksPerSecond > 0 ? 1e6 / ticksPerSecond : 0; }
+
+    ProfileSummary summarize() const;   // Ordena cpias do anel: s para o overlay/relatrio
+    static const char* phaseName(TickPhase phase);
+
+private:
+    uint64_t rows[HISTORY][PHASES];   // Ciclos por fase de cada tick
+    int current;                      // Linha em curso (ainda no entra nas contas)
+    int committed;                    // Linhas completas (at HISTORY)
+    bool currentHasTick;
+    double cyclesPerUs;               // Calibrado no construtor
+    double tickPeriodUs;
+
+    void commitTick();
+};
+
+// Mede o bloco em que  declarada
+class ProfileScope {
+public:
+    ProfileScope(TickProfiler& profiler, TickPhase phase) : profiler(profiler), phase(phase) {
+        profiler.beginPhase(phase);
+        start = TickProfiler::readCycles();
+    }
+    ~ProfileScope() {
+        profiler.addCycles(phase, TickProfiler::readCycles() - start);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    TickProfiler& profiler;
+    TickPhase phase;
+    uint64_t start;
+};
+
+#ifdef PACMAN_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_PHASE(profiler, phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)((profiler), (phase))
+#else
+#define PROFILE_PHASE(profiler, phase) ((void)0)
+#endif
+
+#endif
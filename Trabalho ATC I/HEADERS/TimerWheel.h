@@ -0,0 +1,84 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "entity_pool.h"
+#include <cstdint>
+
+// O que acontece quando um timer expira (o Game faz o despacho)
+enum class TimerAction : uint8_t {
+    POWER_END,        // Acaba o power pellet: Pacman normal, fantasmas recuperam
+    GHOST_RELEASE,    // Um fantasma sai da casa (target = ndice do fantasma)
+    TRANSITION_END    // Acaba o ecr entre nveis
+};
+
+struct TimerEvent {
+    TimerAction action;
+    int target;
+};
+
+// Roda de timers hierrquica, contada em ticks.
+//
+// Trs nveis de 64 casas: o primeiro tem uma casa por tick, o segundo uma
+// por 64 ticks e o terceiro uma por 4096. Cada timer fica numa lista da
+// casa do seu prazo; quando o primeiro nvel d a volta, a casa seguinte
+// do nvel acima  redistribuda pelos de baixo. advance() s toca nos
+// timers que expiram (ou que descem de nvel), nunca em todos.
+//
+// Capacidade fixa e guardada no prprio objeto: agendar no aloca.
+typedef PoolHandle<TimerEvent> TimerHandle;
+
+class TimerWheel {
+public:
+    static const int CAPACITY = 16;
+    static const int LEVELS = 3;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const uint32_t MAX_DELAY = (1u << (SLOT_BITS * LEVELS)) - 1;
+
+    TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Expira no delay-simo advance() a partir de agora (delay >= 1).
+    // Lana std::runtime_error se a roda estiver cheia ou o delay for grande demais.
+    TimerHandle schedule(uint32_t delay, TimerAction action, int target);
+    bool cancel(TimerHandle& handle);   // Invalida o handle; false se j no estava agendado
+    void clear();                       // Cancela todos (os handles deixam de resolver)
+
+    bool isPending(TimerHandle handle) const;
+    uint32_t getRemaining(TimerHandle handle) const;   // Ticks at expirar (0 = no agendado)
+
+    // Avana um tick e escreve em expired os timers que expiraram, por
+    // ordem de (ao, alvo) para o despacho no depender da ordem de
+    // agendamento. expired tem de ter espao para CAPACITY eventos.
+    int advance(TimerEvent* expired);
+
+    uint32_t getNow() const { return now; }
+    int getPendingCount() const { return pendingCount; }
+
+private:
+    static const uint16_t NONE = 0xFFFF;
+
+    struct Node {
+        uint32_t deadline;
+        TimerEvent event;
+        uint16_t generation;
+        uint16_t bucket;      // Lista onde est (NONE = livre)
+        uint16_t prev, next;
+    };
+
+    uint32_t now;
+    int pendingCount;
+    Node nodes[CAPACITY];
+    uint16_t buckets[LEVELS * SLOTS];   // Cabea da lista de cada casa
+    uint16_t freeNodes[CAPACITY];
+    int freeCount;
+
+    void insert(uint16_t index);        // Na casa do prazo, relativo a now
+    void unlink(uint16_t index);
+    void release(uint16_t index);
+    void cascade(int level);            // Redistribui a casa atual de um nvel
+    int indexOf(TimerHandle handle) const;
+};
+
+#endif
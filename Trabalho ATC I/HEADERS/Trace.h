@@ -0,0 +1,72 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Trao da sesso no formato Chrome trace-event (JSON em array), para abrir
+// no chrome://tracing ou no Perfetto e ver de onde vm os picos de frame.
+//
+// Cada thread escreve os seus eventos num anel prprio (um produtor, um
+// consumidor, sem locks); os anis so despejados para o ficheiro no fim
+// (stop()), quando o processo recebe SIGUSR1 ou quando um anel passa de
+// 3/4 cheio. Com o trao desligado, TRACE_SCOPE custa uma leitura atmica.
+//
+// Os nomes dos eventos tm de ser literais (s o ponteiro  guardado).
+
+class Tracer {
+public:
+    // Abre o ficheiro e passa a registar; instala o SIGUSR1 para despejar
+    // a meio da sesso. Lana std::runtime_error se no puder criar o ficheiro.
+    static void start(const std::string& path);
+    static void stop();   // Despeja tudo, fecha o array e o ficheiro
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Chamado pelo loop principal: despeja se foi pedido (sinal, anel cheio)
+    static void service() {
+        if (flushRequested.load(std::memory_order_relaxed)) flush();
+    }
+    static void requestFlush() { flushRequested.store(true, std::memory_order_relaxed); }  // Seguro num sinal
+    static void flush();
+
+    static void setThreadName(const char* name);   // Nome da thread atual no visualizador
+
+    // Nanossegundos desde start()
+    static uint64_t now();
+    static void complete(const char* name, uint64_t startNs, uint64_t endNs);
+    static void counter(const char* name, int64_t value);
+
+    static long long getDroppedEvents();   // Anis cheios entre despejos
+
+private:
+    static std::atomic<bool> enabled;
+    static std::atomic<bool> flushRequested;
+};
+
+// Mede o bloco em que  declarado (evento "X" do Chrome trace)
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : name(name), active(Tracer::isEnabled()), start(active ? Tracer::now() : 0) {}
+    ~TraceScope() {
+        if (active) Tracer::complete(name, start, Tracer::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    bool active;
+    uint64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNTER(name, value) \
+    do { if (Tracer::isEnabled()) Tracer::counter((name), static_cast<int64_t>(value)); } while (0)
+
+#endif